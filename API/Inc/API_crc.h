@@ -0,0 +1,18 @@
+/*
+ * API_crc.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_CRC_H_
+#define API_INC_API_CRC_H_
+
+#include <stdint.h>
+
+#define CRC32_INIT		0xFFFFFFFF
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, uint32_t len);
+uint32_t crc32ZeroedField(const uint8_t *data, uint32_t len, uint32_t field);
+
+#endif /* API_INC_API_CRC_H_ */
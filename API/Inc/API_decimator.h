@@ -0,0 +1,30 @@
+/*
+ * API_decimator.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_DECIMATOR_H_
+#define API_INC_API_DECIMATOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DECIMATOR_VALUES	2	// valores por muestra (temperatura y humedad crudas)
+
+/*
+ * Filtro decimador de promedio (integrador y descarga, CIC de un orden): acumula las muestras
+ * crudas de 16 bits de un período de reporte y entrega su promedio. Con N muestras de ruido
+ * independiente el desvío del promedio baja en raíz de N.
+ */
+typedef struct{
+	uint32_t sum[DECIMATOR_VALUES];	// hasta 65536 muestras de 16 bits sin desbordar
+	uint16_t count;
+} decimator_t;
+
+void decimatorInit(decimator_t *d);
+void decimatorPush(decimator_t *d, const uint16_t *values);
+bool decimatorRead(decimator_t *d, uint16_t *values, uint16_t *count);
+
+#endif /* API_INC_API_DECIMATOR_H_ */
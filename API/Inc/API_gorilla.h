@@ -0,0 +1,34 @@
+/*
+ * API_gorilla.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_GORILLA_H_
+#define API_INC_API_GORILLA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GORILLA_VALUES		2	// valores por muestra (temperatura y humedad)
+#define GORILLA_MAX_RECORD	((36 + GORILLA_VALUES * 44 + 7) / 8 + 1)	// bytes en el peor caso (+1 por alineación de bits)
+
+/*
+ * Estado del compresor / descompresor. Ambos evolucionan igual, por lo que al decodificar
+ * todas las muestras de un bloque se obtiene el estado para seguir agregando.
+ */
+typedef struct{
+	uint32_t bit;						// bits usados en el buffer
+	uint32_t prev_time;
+	int32_t prev_delta;
+	uint32_t prev_value[GORILLA_VALUES];	// bits del float anterior
+	uint8_t lead[GORILLA_VALUES];		// ventana de bits significativos del XOR anterior
+	uint8_t trail[GORILLA_VALUES];		// (lead > 31 indica que no hay ventana)
+} gorilla_t;
+
+void gorillaInit(gorilla_t *g, uint32_t time);
+uint16_t gorillaEncode(gorilla_t *g, uint8_t *buf, uint32_t time, const float *values);
+bool gorillaDecode(gorilla_t *g, const uint8_t *buf, uint16_t len, uint32_t *time, float *values);
+
+#endif /* API_INC_API_GORILLA_H_ */
@@ -0,0 +1,42 @@
+/*
+ * API_quantile.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_QUANTILE_H_
+#define API_INC_API_QUANTILE_H_
+
+#include <stdint.h>
+
+#define QUANTILE_COUNT		3	// p5, p50 y p95 (QUANTILE_P en API_quantile.c)
+#define QUANTILE_MARKERS	15	// fracciones en QUANTILE_F (API_quantile.c)
+
+/*
+ * Estimador de cuantiles en memoria constante (P² de Jain-Chlamtac extendido a varios cuantiles):
+ * QUANTILE_MARKERS marcadores siguen el mínimo, el máximo, cada cuantil y puntos intermedios. Con
+ * cada muestra se corren las posiciones y los marcadores que se alejan de su posición deseada se
+ * mueven una posición, ajustando la altura con una parábola por los vecinos. Hasta tener
+ * QUANTILE_MARKERS muestras las alturas son las muestras ordenadas.
+ *
+ * Con un marcador intermedio por cuantil (9 en total) las series del sensor, que cambian lento y
+ * con ciclo diario, dejaban p95 hasta 3 percentiles corrido; con dos por lado queda por debajo de 0,5.
+ * La mediana lleva además marcadores en 0,45 y 0,55: con un grupo angosto de valores junto a un
+ * escalón (22 °C estables y luego la calefacción) los vecinos en 0,275 y 0,725 quedaban uno a cada
+ * lado del hueco y la interpolación corría p50 fuera del grupo (+23 ticks en Host/traces/registro.csv).
+ * Las alturas van en ticks crudos. La estructura no tiene relleno, se guarda tal cual en la SD.
+ */
+typedef struct{
+	uint32_t count;
+	uint32_t pos[QUANTILE_MARKERS];		// posición de cada marcador (1..count)
+	float height[QUANTILE_MARKERS];		// valor estimado en cada marcador, ticks crudos
+} quantile_t;
+
+extern const float QUANTILE_P[QUANTILE_COUNT];
+
+void quantileInit(quantile_t *q);
+void quantilePush(quantile_t *q, uint16_t value);
+float quantileGet(const quantile_t *q, uint8_t index);
+
+#endif /* API_INC_API_QUANTILE_H_ */
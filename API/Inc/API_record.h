@@ -0,0 +1,28 @@
+/*
+ * API_record.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_RECORD_H_
+#define API_INC_API_RECORD_H_
+
+#include <stdint.h>
+
+#define RECORD_MAX_SIZE		11	// varint de 32 bits (5) + 2 varint zigzag de 17 bits (3 + 3)
+
+typedef struct{
+	uint32_t time;			// segundos de registro
+	float temp;				// °C
+	float hum;				// %HR
+	uint16_t raw_temp;		// ticks del SHT30
+	uint16_t raw_hum;		// ticks del SHT30
+} logSample_t;
+
+uint8_t recordPutVarint(uint8_t *dst, uint32_t value);
+uint8_t recordGetVarint(const uint8_t *src, uint16_t len, uint32_t *value);
+uint8_t recordEncode(uint8_t *dst, const logSample_t *sample, const logSample_t *prev);
+uint8_t recordDecode(const uint8_t *src, uint16_t len, logSample_t *sample, const logSample_t *prev);
+
+#endif /* API_INC_API_RECORD_H_ */
@@ -0,0 +1,86 @@
+/*
+ * API_rrd.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_RRD_H_
+#define API_INC_API_RRD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "API_delay.h"
+#include "API_record.h"
+#include "sd_card.h"
+
+#define RRD_MAGIC			0x41445252	// "RRDA"
+
+#ifndef RRD_MAX_TIERS
+#define RRD_MAX_TIERS		3
+#endif
+
+#define RRD_QUERY_MAX_BUCKETS	64	// una consulta usa la resolución más fina que la cubra con hasta estos intervalos
+
+/*
+ * Agregado de las muestras de un intervalo, en ticks crudos como Temp_data.
+ */
+typedef struct{
+	uint32_t start;			// inicio del intervalo (s, múltiplo del paso); RRD_EMPTY si el lugar está libre
+	uint32_t count;
+	uint64_t sum_T;
+	uint64_t sum_H;
+	uint16_t min_T;
+	uint16_t max_T;
+	uint16_t min_H;
+	uint16_t max_H;
+} rrdBucket_t;
+
+#define RRD_EMPTY			0xFFFFFFFF
+
+/*
+ * Cabecera de cada bloque de un archivo. A continuación van RRD_BUCKETS_PER_BLOCK intervalos.
+ */
+typedef struct{
+	uint32_t magic;
+	uint32_t step;
+	uint32_t capacity;
+} rrdHeader_t;
+
+#define RRD_BUCKETS_PER_BLOCK	((SD_BLOCK_SIZE - sizeof(rrdHeader_t)) / sizeof(rrdBucket_t))
+
+typedef struct{
+	uint32_t step;			// duración de cada intervalo (s)
+	uint32_t capacity;		// intervalos que guarda el archivo antes de sobrescribir el más antiguo
+} rrdTier_t;
+
+/*
+ * Archivo circular de una resolución: el intervalo que empieza en t va siempre en el lugar
+ * (t / step) % capacity, así que no hace falta buscar el último escrito al arrancar.
+ */
+typedef struct{
+	uint32_t first_block;	// primer bloque del archivo en la SD
+	uint32_t step;
+	uint32_t capacity;		// redondeada a bloques completos
+	uint32_t block;			// índice (relativo a first_block) del bloque en RAM, RRD_EMPTY si ninguno
+	rrdBucket_t acc;		// intervalo en curso
+	bool_t dirty;			// el bloque en RAM o acc tienen cambios que no llegaron a la cache
+	uint8_t data[SD_BLOCK_SIZE];	// bloque del intervalo en curso (staging en RAM)
+} rrdArchive_t;
+
+typedef struct{
+	rrdArchive_t tier[RRD_MAX_TIERS];	// de la resolución más fina a la más gruesa
+	uint8_t num_tiers;
+	uint32_t num_blocks;	// bloques usados por todos los archivos
+	delay_t latency;		// tiempo máximo que un intervalo en curso queda solo en RAM
+	uint8_t scratch[SD_BLOCK_SIZE];		// bloque leído por rrdQuery
+} rrd_t;
+
+void rrdInit(rrd_t *rrd, uint32_t first_block, const rrdTier_t *tiers, uint8_t num_tiers, tick_t max_latency);
+sd_err_t rrdUpdate(rrd_t *rrd, const logSample_t *sample);
+sd_err_t rrdProcess(rrd_t *rrd);
+sd_err_t rrdQuery(rrd_t *rrd, uint32_t now, uint32_t window, rrdBucket_t *result, uint32_t *step);
+sd_err_t rrdReset(rrd_t *rrd);
+
+#endif /* API_INC_API_RRD_H_ */
@@ -0,0 +1,75 @@
+/*
+ * API_sdlog.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_SDLOG_H_
+#define API_INC_API_SDLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "API_delay.h"
+#include "API_record.h"
+#include "API_gorilla.h"
+#include "sd_card.h"
+
+#define SDLOG_MAGIC			0x474F4C54	// "TLOG"
+#define SDLOG_FLAG_SEALED	0x01		// bloque completo, no admite más muestras
+
+typedef enum{
+	SDLOG_ENC_DELTA = 0,	// ticks crudos del SHT30 como varint delta (ver API_record)
+	SDLOG_ENC_GORILLA,		// °C y %HR en float comprimidos por XOR (ver API_gorilla)
+} logEncoding_t;
+
+#ifndef SDLOG_ENC_DEFAULT
+#define SDLOG_ENC_DEFAULT	SDLOG_ENC_DELTA
+#endif
+
+/*
+ * Cabecera de cada bloque del log. A continuación se guarda una copia del estado de la
+ * aplicación (state_len bytes) y luego los registros de las muestras.
+ */
+typedef struct{
+	uint32_t magic;
+	uint32_t seq;			// número de secuencia, crece con cada bloque nuevo
+	uint32_t time;			// tiempo de la primera muestra del bloque
+	uint16_t count;			// cantidad de muestras en el bloque
+	uint16_t used;			// bytes de registros usados
+	uint8_t encoding;		// logEncoding_t
+	uint8_t flags;
+	uint16_t state_len;
+	uint32_t crc;			// CRC-32 del bloque completo con este campo en 0
+} logHeader_t;
+
+typedef struct{
+	uint32_t first_block;	// primer bloque de la región del log
+	uint32_t num_blocks;	// cantidad de bloques de la región
+	uint32_t head;			// índice (relativo a first_block) del bloque en escritura
+	uint16_t state_len;
+	logHeader_t hdr;		// cabecera del bloque en escritura
+	uint8_t block[SD_BLOCK_SIZE];	// bloque en escritura (staging en RAM)
+	logSample_t last;		// última muestra agregada al bloque en escritura
+	gorilla_t gorilla;		// estado del compresor para SDLOG_ENC_GORILLA
+	uint8_t encoding;		// codificación de los bloques nuevos
+	bool_t dirty;			// el bloque tiene muestras que todavía no se escribieron
+	delay_t latency;		// tiempo máximo que una muestra puede quedar solo en RAM
+	uint8_t scratch[SD_BLOCK_SIZE];	// bloque leído por sdlogRead
+} sdlog_t;
+
+void sdlogInit(sdlog_t *log, uint32_t first_block, uint32_t num_blocks, uint16_t state_len, tick_t max_latency);
+void sdlogSetEncoding(sdlog_t *log, logEncoding_t encoding);
+sd_err_t sdlogRecover(sdlog_t *log, void *state);
+bool sdlogOpensBlock(const sdlog_t *log);
+sd_err_t sdlogAppend(sdlog_t *log, const logSample_t *sample, const void *state);
+void sdlogPosition(const sdlog_t *log, uint32_t *seq, uint16_t *count);
+sd_err_t sdlogRead(sdlog_t *log, uint32_t seq, uint16_t first, logSample_t *samples, uint16_t max, uint16_t *count);
+uint16_t sdlogDecodeBlock(const uint8_t *block, uint16_t first, logSample_t *samples, uint16_t max);
+sd_err_t sdlogProcess(sdlog_t *log);
+sd_err_t sdlogFlush(sdlog_t *log);
+sd_err_t sdlogReset(sdlog_t *log, const void *state);
+uint32_t sdlogLastTime(sdlog_t *log);
+
+#endif /* API_INC_API_SDLOG_H_ */
@@ -0,0 +1,52 @@
+/*
+ * API_snapshot.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_SNAPSHOT_H_
+#define API_INC_API_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "API_delay.h"
+#include "sd_card.h"
+
+#define SNAPSHOT_MAGIC		0x54415453	// "STAT"
+#define SNAPSHOT_COPIES		2			// bloques que ocupa: las escrituras se alternan entre ellos
+
+/*
+ * Cabecera de cada copia. A continuación van len bytes de datos de la aplicación.
+ */
+typedef struct{
+	uint32_t magic;
+	uint32_t seq;			// crece con cada escritura: vale la copia válida de mayor secuencia
+	uint16_t len;
+	uint16_t reserved;
+	uint32_t crc;			// CRC-32 de la cabecera con este campo en 0 y de los datos
+} snapshotHeader_t;
+
+/*
+ * Copia en la SD de un estado de la aplicación que cambia con cada muestra pero no hace falta
+ * guardar con cada una. Se escribe a lo sumo cada max_latency a través de la cache; como las
+ * copias se alternan, un corte de energía durante la escritura deja la anterior intacta.
+ */
+typedef struct{
+	uint32_t first_block;	// primera de las SNAPSHOT_COPIES copias en la SD
+	void *data;				// estado de la aplicación
+	uint16_t len;
+	uint32_t seq;			// secuencia de la última copia escrita o recuperada
+	bool_t dirty;			// data cambió desde la última escritura
+	delay_t latency;		// tiempo máximo que un cambio queda solo en RAM
+	uint8_t block[SD_BLOCK_SIZE];	// staging de la copia a escribir o leída
+} snapshot_t;
+
+void snapshotInit(snapshot_t *s, uint32_t first_block, void *data, uint16_t len, tick_t max_latency);
+sd_err_t snapshotRecover(snapshot_t *s, bool *found);
+void snapshotTouch(snapshot_t *s);
+bool snapshotDue(snapshot_t *s);
+sd_err_t snapshotWrite(snapshot_t *s);
+
+#endif /* API_INC_API_SNAPSHOT_H_ */
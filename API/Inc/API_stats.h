@@ -0,0 +1,38 @@
+/*
+ * API_stats.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+
+#ifndef API_INC_API_STATS_H_
+#define API_INC_API_STATS_H_
+
+#include <stdint.h>
+
+/*
+ * Estadística de una serie de valores crudos de 16 bits en memoria constante: cantidad,
+ * media y suma de cuadrados de los desvíos (algoritmo de Welford), y mínimo y máximo con el
+ * tiempo en que ocurrieron. Dos estadísticas de tramos distintos se combinan sin las muestras
+ * (fórmula de Chan), por ejemplo las parciales de cada bloque del log.
+ *
+ * Media y m2 van en double: en float la corrección delta/n deja de sumar después de unos
+ * millones de muestras. El FPU del Cortex-M4 es de simple precisión, pero es una actualización
+ * por muestra. La estructura no tiene relleno, se guarda tal cual en la SD.
+ */
+typedef struct{
+	uint32_t count;
+	uint16_t min;			// ticks crudos
+	uint16_t max;
+	uint32_t min_time;		// tiempo de la primera muestra con el mínimo (s, como logSample_t)
+	uint32_t max_time;
+	double mean;			// ticks crudos
+	double m2;				// suma de (x - media)^2, ticks^2
+} stats_t;
+
+void statsInit(stats_t *s);
+void statsPush(stats_t *s, uint16_t value, uint32_t time);
+void statsMerge(stats_t *dst, const stats_t *src);
+double statsVariance(const stats_t *s);
+
+#endif /* API_INC_API_STATS_H_ */
@@ -0,0 +1,58 @@
+/*
+ * API_crc.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_crc.h"
+
+#include <assert.h>
+
+/**
+  * @brief Actualiza un CRC-32 (polinomio 0xEDB88320) con los bytes de un buffer.
+  *
+  * @param crc CRC acumulado; CRC32_INIT para el primer tramo.
+  * @param data Puntero a los bytes a agregar.
+  * @param len Cantidad de bytes.
+  *
+  * @retval CRC acumulado, sin la inversión final.
+  */
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+	assert(data || len == 0);
+
+	while (len--)
+	{
+		crc ^= *data++;
+		for (int b = 0; b < 8; b++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return crc;
+}
+
+/**
+  * @brief CRC-32 de un buffer que guarda su propio CRC, tomando ese campo como 0.
+  *
+  * Permite calcular el CRC al escribir y verificarlo al leer sin copiar el buffer.
+  *
+  * @param data Puntero al buffer.
+  * @param len Cantidad de bytes cubiertos por el CRC.
+  * @param field Offset del campo de 4 bytes que guarda el CRC dentro del buffer.
+  *
+  * @retval CRC-32 final.
+  */
+uint32_t crc32ZeroedField(const uint8_t *data, uint32_t len, uint32_t field)
+{
+	static const uint8_t zero[sizeof(uint32_t)] = {0};
+	const uint32_t end = field + sizeof(uint32_t);
+
+	assert(data);
+	assert(end <= len);
+
+	uint32_t crc = crc32Update(CRC32_INIT, data, field);
+	crc = crc32Update(crc, zero, sizeof(zero));
+	crc = crc32Update(crc, &data[end], len - end);
+	return ~crc;
+}
@@ -0,0 +1,77 @@
+/*
+ * API_decimator.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_decimator.h"
+
+#include <assert.h>
+#include <string.h>
+
+/**
+  * @brief Inicializa el filtro sin muestras acumuladas.
+  *
+  * @param d Puntero al filtro.
+  *
+  * @retval void
+  */
+void decimatorInit(decimator_t *d)
+{
+	assert(d);
+
+	memset(d, 0, sizeof(*d));
+}
+
+/**
+  * @brief Acumula una muestra.
+  *
+  * Si el período ya acumuló el máximo de muestras la nueva se descarta, para no desbordar
+  * la suma (a 10 mps eso son casi dos horas sin leer el filtro).
+  *
+  * @param d Puntero al filtro.
+  * @param values DECIMATOR_VALUES valores crudos de la muestra.
+  *
+  * @retval void
+  */
+void decimatorPush(decimator_t *d, const uint16_t *values)
+{
+	assert(d);
+	assert(values);
+
+	if (d->count == UINT16_MAX) return;
+
+	for (int v = 0; v < DECIMATOR_VALUES; v++)
+	{
+		d->sum[v] += values[v];
+	}
+	d->count++;
+}
+
+/**
+  * @brief Entrega el promedio de las muestras acumuladas y empieza un período nuevo.
+  *
+  * El promedio se redondea al entero más cercano, así que la salida tiene el mismo formato
+  * que una medición cruda del sensor.
+  *
+  * @param d Puntero al filtro.
+  * @param values Destino de los DECIMATOR_VALUES promedios.
+  * @param count Destino de la cantidad de muestras promediadas (puede ser NULL).
+  *
+  * @retval bool Falso si no se acumuló ninguna muestra en el período (values no se modifica).
+  */
+bool decimatorRead(decimator_t *d, uint16_t *values, uint16_t *count)
+{
+	assert(d);
+	assert(values);
+
+	if (count != NULL) *count = d->count;
+	if (d->count == 0) return false;
+
+	for (int v = 0; v < DECIMATOR_VALUES; v++)
+	{
+		values[v] = (uint16_t)((d->sum[v] + d->count / 2) / d->count);
+	}
+	decimatorInit(d);
+	return true;
+}
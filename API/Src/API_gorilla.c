@@ -0,0 +1,248 @@
+/*
+ * API_gorilla.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_gorilla.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define NO_WINDOW	0xFF
+
+static void gorillaPutBits(uint8_t *buf, uint32_t *bit, uint32_t value, uint8_t n);
+static bool gorillaGetBits(const uint8_t *buf, uint32_t len_bits, uint32_t *bit, uint32_t *value, uint8_t n);
+static uint8_t gorillaClz(uint32_t x);
+static uint8_t gorillaCtz(uint32_t x);
+
+/**
+  * @brief Inicializa el estado del compresor para un bloque nuevo.
+  *
+  * @param g Puntero al estado.
+  * @param time Tiempo de referencia del bloque (el de la primera muestra).
+  *
+  * @retval void
+  */
+void gorillaInit(gorilla_t *g, uint32_t time)
+{
+	assert(g);
+
+	memset(g, 0, sizeof(*g));
+	g->prev_time = time;
+	memset(g->lead, NO_WINDOW, sizeof(g->lead));
+}
+
+/**
+  * @brief Agrega una muestra al flujo de bits, al estilo de Gorilla (Facebook, VLDB 2015).
+  *
+  * El tiempo se guarda como delta-of-delta en 1, 9, 12, 16 o 36 bits; con muestreo regular
+  * ocupa un solo bit. Cada valor se guarda como XOR con el valor anterior: un bit si no
+  * cambió, o solo los bits significativos del XOR (reutilizando la ventana de ceros
+  * iniciales/finales del XOR anterior cuando es posible). Para series que varían lentamente
+  * una muestra ocupa unos pocos bytes en lugar de 12.
+  *
+  * @param g Puntero al estado.
+  * @param buf Buffer de destino; se escribe a partir del bit g->bit.
+  * @param time Tiempo de la muestra (no menor que el de la anterior).
+  * @param values GORILLA_VALUES valores de la muestra.
+  *
+  * @retval Bytes del buffer usados hasta el momento (incluyendo esta muestra).
+  */
+uint16_t gorillaEncode(gorilla_t *g, uint8_t *buf, uint32_t time, const float *values)
+{
+	assert(g);
+	assert(buf);
+	assert(values);
+
+	int32_t delta = (int32_t)(time - g->prev_time);
+	int32_t dod = delta - g->prev_delta;
+
+	if (dod == 0)
+	{
+		gorillaPutBits(buf, &g->bit, 0x0, 1);
+	}
+	else if (dod >= -64 && dod <= 63)
+	{
+		gorillaPutBits(buf, &g->bit, 0x2, 2);
+		gorillaPutBits(buf, &g->bit, (uint32_t)dod & 0x7F, 7);
+	}
+	else if (dod >= -256 && dod <= 255)
+	{
+		gorillaPutBits(buf, &g->bit, 0x6, 3);
+		gorillaPutBits(buf, &g->bit, (uint32_t)dod & 0x1FF, 9);
+	}
+	else if (dod >= -2048 && dod <= 2047)
+	{
+		gorillaPutBits(buf, &g->bit, 0xE, 4);
+		gorillaPutBits(buf, &g->bit, (uint32_t)dod & 0xFFF, 12);
+	}
+	else
+	{
+		gorillaPutBits(buf, &g->bit, 0xF, 4);
+		gorillaPutBits(buf, &g->bit, (uint32_t)dod, 32);
+	}
+
+	g->prev_delta = delta;
+	g->prev_time = time;
+
+	for (int v = 0; v < GORILLA_VALUES; v++)
+	{
+		uint32_t bits;
+		memcpy(&bits, &values[v], sizeof(bits));
+
+		uint32_t x = bits ^ g->prev_value[v];
+		g->prev_value[v] = bits;
+
+		if (x == 0)
+		{
+			gorillaPutBits(buf, &g->bit, 0x0, 1);
+			continue;
+		}
+
+		uint8_t lead = gorillaClz(x);
+		uint8_t trail = gorillaCtz(x);
+
+		if (g->lead[v] != NO_WINDOW && lead >= g->lead[v] && trail >= g->trail[v])
+		{
+			gorillaPutBits(buf, &g->bit, 0x2, 2);
+			gorillaPutBits(buf, &g->bit, x >> g->trail[v], 32 - g->lead[v] - g->trail[v]);
+		}
+		else
+		{
+			uint8_t len = 32 - lead - trail;
+			gorillaPutBits(buf, &g->bit, 0x3, 2);
+			gorillaPutBits(buf, &g->bit, lead, 5);
+			gorillaPutBits(buf, &g->bit, len - 1, 5);
+			gorillaPutBits(buf, &g->bit, x >> trail, len);
+			g->lead[v] = lead;
+			g->trail[v] = trail;
+		}
+	}
+
+	return (uint16_t)((g->bit + 7) / 8);
+}
+
+/**
+  * @brief Lee la siguiente muestra del flujo de bits escrito con gorillaEncode().
+  *
+  * @param g Puntero al estado (inicializado con gorillaInit() con el mismo tiempo de referencia).
+  * @param buf Buffer de origen; se lee a partir del bit g->bit.
+  * @param len Bytes válidos en el buffer.
+  * @param time Puntero donde se almacena el tiempo de la muestra.
+  * @param values Puntero donde se almacenan los GORILLA_VALUES valores.
+  *
+  * @retval true si se decodificó la muestra, false si el flujo está truncado.
+  */
+bool gorillaDecode(gorilla_t *g, const uint8_t *buf, uint16_t len, uint32_t *time, float *values)
+{
+	assert(g);
+	assert(buf);
+
+	uint32_t len_bits = (uint32_t)len * 8;
+	uint32_t b, ctrl = 0;
+	int32_t dod;
+
+	// prefijo unario del delta-of-delta: 0, 10, 110, 1110, 1111
+	uint8_t ones = 0;
+	while (ones < 4)
+	{
+		if (!gorillaGetBits(buf, len_bits, &g->bit, &b, 1)) return false;
+		if (b == 0) break;
+		ones++;
+	}
+
+	static const uint8_t dod_bits[] = { 0, 7, 9, 12, 32 };
+	if (!gorillaGetBits(buf, len_bits, &g->bit, &ctrl, dod_bits[ones])) return false;
+
+	if (ones == 0) dod = 0;
+	else if (ones == 4) dod = (int32_t)ctrl;
+	else dod = (int32_t)(ctrl << (32 - dod_bits[ones])) >> (32 - dod_bits[ones]); // extensión de signo
+
+	g->prev_delta += dod;
+	g->prev_time += g->prev_delta;
+	*time = g->prev_time;
+
+	for (int v = 0; v < GORILLA_VALUES; v++)
+	{
+		uint32_t x = 0;
+
+		if (!gorillaGetBits(buf, len_bits, &g->bit, &b, 1)) return false;
+		if (b == 1)
+		{
+			if (!gorillaGetBits(buf, len_bits, &g->bit, &b, 1)) return false;
+			if (b == 1)
+			{
+				uint32_t lead, mlen;
+				if (!gorillaGetBits(buf, len_bits, &g->bit, &lead, 5)) return false;
+				if (!gorillaGetBits(buf, len_bits, &g->bit, &mlen, 5)) return false;
+				mlen += 1;
+				if (lead + mlen > 32) return false;
+				g->lead[v] = (uint8_t)lead;
+				g->trail[v] = (uint8_t)(32 - lead - mlen);
+			}
+			else if (g->lead[v] == NO_WINDOW)
+			{
+				return false;
+			}
+
+			if (!gorillaGetBits(buf, len_bits, &g->bit, &x, 32 - g->lead[v] - g->trail[v])) return false;
+			x <<= g->trail[v];
+		}
+
+		g->prev_value[v] ^= x;
+		memcpy(&values[v], &g->prev_value[v], sizeof(float));
+	}
+
+	return true;
+}
+
+/**
+  * @brief Escribe los n bits menos significativos de value (MSB primero).
+  */
+static void gorillaPutBits(uint8_t *buf, uint32_t *bit, uint32_t value, uint8_t n)
+{
+	while (n--)
+	{
+		uint8_t mask = 0x80 >> (*bit & 7);
+
+		if ((value >> n) & 1) buf[*bit >> 3] |= mask;
+		else buf[*bit >> 3] &= ~mask;
+
+		(*bit)++;
+	}
+}
+
+/**
+  * @brief Lee n bits (MSB primero).
+  * @retval false si no quedan n bits en el buffer.
+  */
+static bool gorillaGetBits(const uint8_t *buf, uint32_t len_bits, uint32_t *bit, uint32_t *value, uint8_t n)
+{
+	if (*bit + n > len_bits) return false;
+
+	uint32_t v = 0;
+	while (n--)
+	{
+		v = (v << 1) | ((buf[*bit >> 3] >> (7 - (*bit & 7))) & 1);
+		(*bit)++;
+	}
+	*value = v;
+	return true;
+}
+
+/**
+  * @brief Cantidad de ceros iniciales (x distinto de 0).
+  */
+static uint8_t gorillaClz(uint32_t x)
+{
+	return (uint8_t)__builtin_clz(x);
+}
+
+/**
+  * @brief Cantidad de ceros finales (x distinto de 0).
+  */
+static uint8_t gorillaCtz(uint32_t x)
+{
+	return (uint8_t)__builtin_ctz(x);
+}
@@ -0,0 +1,152 @@
+/*
+ * API_quantile.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_quantile.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define LAST	(QUANTILE_MARKERS - 1)
+
+const float QUANTILE_P[QUANTILE_COUNT] = { 0.05f, 0.50f, 0.95f };
+
+// fracción de la distribución que sigue cada marcador; QUANTILE_AT indica los de QUANTILE_P
+static const float QUANTILE_F[QUANTILE_MARKERS] = {
+	0.0f, 0.01f, 0.025f, 0.05f, 0.10f, 0.275f, 0.45f, 0.50f, 0.55f, 0.725f, 0.90f, 0.95f, 0.975f, 0.99f, 1.0f
+};
+static const uint8_t QUANTILE_AT[QUANTILE_COUNT] = { 3, 7, 11 };
+
+static float quantileParabolic(const quantile_t *q, uint8_t i, int32_t d);
+static float quantileLinear(const quantile_t *q, uint8_t i, int32_t d);
+
+/**
+  * @brief Inicializa el estimador sin muestras.
+  *
+  * @param q Puntero al estimador.
+  *
+  * @retval void
+  */
+void quantileInit(quantile_t *q)
+{
+	assert(q);
+
+	memset(q, 0, sizeof(*q));
+}
+
+/**
+  * @brief Agrega una muestra.
+  *
+  * Costo constante: ubicar la muestra entre los marcadores, correr las posiciones de los que
+  * quedan por encima y mover a lo sumo una posición cada marcador interior.
+  *
+  * @param q Puntero al estimador.
+  * @param value Valor crudo.
+  *
+  * @retval void
+  */
+void quantilePush(quantile_t *q, uint16_t value)
+{
+	assert(q);
+
+	float x = value;
+	uint8_t k;
+
+	if (q->count == UINT32_MAX) return;
+
+	if (q->count < QUANTILE_MARKERS)
+	{
+		// arranque: inserción ordenada, los marcadores son las muestras
+		uint8_t i = q->count;
+		while (i > 0 && q->height[i - 1] > x)
+		{
+			q->height[i] = q->height[i - 1];
+			i--;
+		}
+		q->height[i] = x;
+		q->pos[q->count] = q->count + 1;
+		q->count++;
+		return;
+	}
+
+	if (x < q->height[0])
+	{
+		q->height[0] = x;
+		k = 0;
+	}
+	else if (x >= q->height[LAST])
+	{
+		q->height[LAST] = x;
+		k = LAST - 1;
+	}
+	else
+	{
+		k = 0;
+		while (x >= q->height[k + 1]) k++;
+	}
+
+	for (uint8_t i = k + 1; i < QUANTILE_MARKERS; i++) q->pos[i]++;
+	q->count++;
+
+	for (uint8_t i = 1; i < LAST; i++)
+	{
+		// posición deseada 1 + (count - 1) * f; en double porque count pasa los 24 bits del float
+		double d = 1.0 + (double)(q->count - 1) * QUANTILE_F[i] - q->pos[i];
+
+		if ((d >= 1.0 && q->pos[i + 1] - q->pos[i] > 1) || (d <= -1.0 && q->pos[i] - q->pos[i - 1] > 1))
+		{
+			int32_t s = (d > 0) ? 1 : -1;
+			float h = quantileParabolic(q, i, s);
+
+			if (h <= q->height[i - 1] || h >= q->height[i + 1]) h = quantileLinear(q, i, s);
+			q->height[i] = h;
+			q->pos[i] += s;
+		}
+	}
+}
+
+/**
+  * @brief Estimación del cuantil QUANTILE_P[index], en ticks crudos.
+  *
+  * Con menos de QUANTILE_MARKERS muestras devuelve la muestra de rango más cercano (exacto).
+  *
+  * @param q Puntero al estimador.
+  * @param index Índice en QUANTILE_P.
+  *
+  * @retval float 0 si no hay muestras.
+  */
+float quantileGet(const quantile_t *q, uint8_t index)
+{
+	assert(q);
+	assert(index < QUANTILE_COUNT);
+
+	if (q->count == 0) return 0;
+	if (q->count < QUANTILE_MARKERS) return q->height[(uint32_t)(QUANTILE_P[index] * (q->count - 1) + 0.5f)];
+
+	return q->height[QUANTILE_AT[index]];
+}
+
+/**
+  * @brief Altura del marcador i movido d (±1) posiciones, por la parábola que pasa por él y sus vecinos.
+  */
+static float quantileParabolic(const quantile_t *q, uint8_t i, int32_t d)
+{
+	float below = (float)(q->pos[i] - q->pos[i - 1]);
+	float above = (float)(q->pos[i + 1] - q->pos[i]);
+
+	return q->height[i] + d / (below + above) *
+			((below + d) * (q->height[i + 1] - q->height[i]) / above +
+			 (above - d) * (q->height[i] - q->height[i - 1]) / below);
+}
+
+/**
+  * @brief Altura del marcador i movido d (±1) posiciones, interpolando con el vecino en esa dirección.
+  */
+static float quantileLinear(const quantile_t *q, uint8_t i, int32_t d)
+{
+	uint8_t n = i + d;
+
+	return q->height[i] + d * (q->height[n] - q->height[i]) / (float)((int32_t)(q->pos[n] - q->pos[i]));
+}
@@ -0,0 +1,143 @@
+/*
+ * API_record.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_record.h"
+
+#include <assert.h>
+
+#include "sht30.h"
+
+static uint32_t recordZigzag(int32_t value);
+static int32_t recordUnzigzag(uint32_t value);
+
+/**
+  * @brief Escribe un entero sin signo como varint (7 bits por byte, el bit alto indica que sigue otro byte).
+  *
+  * @param dst Puntero al buffer de destino (hasta 5 bytes).
+  * @param value Valor a escribir.
+  *
+  * @retval Cantidad de bytes escritos.
+  */
+uint8_t recordPutVarint(uint8_t *dst, uint32_t value)
+{
+	uint8_t n = 0;
+
+	while (value >= 0x80)
+	{
+		dst[n++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	dst[n++] = (uint8_t)value;
+
+	return n;
+}
+
+/**
+  * @brief Lee un varint escrito con recordPutVarint().
+  *
+  * @param src Puntero al buffer de origen.
+  * @param len Bytes disponibles en el buffer.
+  * @param value Puntero donde se almacena el valor leído.
+  *
+  * @retval Cantidad de bytes leídos, o 0 si el varint está truncado o excede 32 bits.
+  */
+uint8_t recordGetVarint(const uint8_t *src, uint16_t len, uint32_t *value)
+{
+	uint32_t v = 0;
+
+	for (uint8_t n = 0; n < 5 && n < len; n++)
+	{
+		v |= (uint32_t)(src[n] & 0x7F) << (7 * n);
+		if (!(src[n] & 0x80))
+		{
+			*value = v;
+			return n + 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Codifica una muestra como diferencia respecto de la muestra anterior del mismo bloque.
+  *
+  * El registro son tres varint: segundos desde la muestra anterior y las diferencias (zigzag) de
+  * los ticks crudos de temperatura y humedad. Con muestreo regular y variaciones del orden del
+  * ruido del sensor cada registro ocupa 3 bytes.
+  * Para la primera muestra del bloque se usa como referencia el tiempo del bloque y ticks en 0,
+  * con lo que cada bloque se decodifica sin depender de los demás.
+  *
+  * @param dst Puntero al buffer de destino (al menos RECORD_MAX_SIZE bytes).
+  * @param sample Muestra a codificar.
+  * @param prev Muestra de referencia.
+  *
+  * @retval Cantidad de bytes escritos.
+  */
+uint8_t recordEncode(uint8_t *dst, const logSample_t *sample, const logSample_t *prev)
+{
+	assert(dst);
+	assert(sample);
+	assert(prev);
+
+	uint8_t n = 0;
+
+	n += recordPutVarint(&dst[n], sample->time - prev->time);
+	n += recordPutVarint(&dst[n], recordZigzag((int32_t)sample->raw_temp - prev->raw_temp));
+	n += recordPutVarint(&dst[n], recordZigzag((int32_t)sample->raw_hum - prev->raw_hum));
+
+	return n;
+}
+
+/**
+  * @brief Decodifica un registro escrito con recordEncode().
+  *
+  * @param src Puntero al registro.
+  * @param len Bytes disponibles desde src.
+  * @param sample Puntero donde se almacena la muestra (ticks crudos y valores convertidos).
+  * @param prev Muestra de referencia usada al codificar.
+  *
+  * @retval Cantidad de bytes leídos, o 0 si el registro está truncado.
+  */
+uint8_t recordDecode(const uint8_t *src, uint16_t len, logSample_t *sample, const logSample_t *prev)
+{
+	assert(src);
+	assert(sample);
+	assert(prev);
+
+	uint32_t dt, dtemp, dhum;
+	uint8_t n = 0, r;
+
+	if ((r = recordGetVarint(&src[n], len - n, &dt)) == 0) return 0;
+	n += r;
+	if ((r = recordGetVarint(&src[n], len - n, &dtemp)) == 0) return 0;
+	n += r;
+	if ((r = recordGetVarint(&src[n], len - n, &dhum)) == 0) return 0;
+	n += r;
+
+	sample->time = prev->time + dt;
+	sample->raw_temp = (uint16_t)(prev->raw_temp + recordUnzigzag(dtemp));
+	sample->raw_hum = (uint16_t)(prev->raw_hum + recordUnzigzag(dhum));
+	sample->temp = SHT30_rawToTemperature(sample->raw_temp);
+	sample->hum = SHT30_rawToHumidity(sample->raw_hum);
+
+	return n;
+}
+
+/**
+  * @brief Mapea un entero con signo a uno sin signo para que valores chicos de cualquier signo ocupen pocos bytes.
+  */
+static uint32_t recordZigzag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+  * @brief Inversa de recordZigzag().
+  */
+static int32_t recordUnzigzag(uint32_t value)
+{
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
@@ -0,0 +1,343 @@
+/*
+ * API_rrd.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_rrd.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "sd_cache.h"
+
+static uint32_t rrdIndex(const rrdArchive_t *a, uint32_t start);
+static uint32_t rrdBlockOf(const rrdArchive_t *a, uint32_t start);
+static uint32_t rrdOffset(const rrdArchive_t *a, uint32_t start);
+static sd_err_t rrdLoad(rrdArchive_t *a, uint32_t block, uint8_t *data);
+static sd_err_t rrdStore(rrdArchive_t *a);
+static void rrdEmpty(rrdBucket_t *b, uint32_t start);
+static void rrdAdd(rrdBucket_t *dst, const rrdBucket_t *src);
+
+/**
+  * @brief Inicializa los archivos de cada resolución, uno a continuación del otro desde first_block.
+  *
+  * Cada muestra se suma al intervalo en curso de todas las resoluciones; al cerrarse, el
+  * intervalo queda en su lugar del archivo, que se sobrescribe una vuelta después
+  * (capacity * step segundos). Así una consulta sobre una ventana larga lee unos pocos
+  * intervalos ya agregados en lugar de las muestras del log.
+  *
+  * @param rrd Puntero a la estructura rrd_t a inicializar.
+  * @param first_block Primer bloque de la SD reservado para los archivos.
+  * @param tiers Paso y capacidad de cada resolución, de la más fina a la más gruesa.
+  * @param num_tiers Cantidad de resoluciones (hasta RRD_MAX_TIERS).
+  * @param max_latency Tiempo máximo en ms que un intervalo en curso queda solo en RAM.
+  *
+  * @retval void
+  */
+void rrdInit(rrd_t *rrd, uint32_t first_block, const rrdTier_t *tiers, uint8_t num_tiers, tick_t max_latency)
+{
+	assert(rrd);
+	assert(tiers);
+	assert(num_tiers > 0 && num_tiers <= RRD_MAX_TIERS);
+
+	uint32_t block = first_block;
+
+	memset(rrd, 0, sizeof(*rrd));
+	for (uint8_t i = 0; i < num_tiers; i++)
+	{
+		rrdArchive_t *a = &rrd->tier[i];
+
+		assert(tiers[i].step > 1 && tiers[i].capacity > 0);
+		a->first_block = block;
+		a->step = tiers[i].step;
+		a->capacity = (tiers[i].capacity + RRD_BUCKETS_PER_BLOCK - 1) / RRD_BUCKETS_PER_BLOCK * RRD_BUCKETS_PER_BLOCK;
+		a->block = RRD_EMPTY;
+		rrdEmpty(&a->acc, RRD_EMPTY);
+		block += a->capacity / RRD_BUCKETS_PER_BLOCK;
+	}
+	rrd->num_tiers = num_tiers;
+	rrd->num_blocks = block - first_block;
+	delayInit(&rrd->latency, max_latency);
+}
+
+/**
+  * @brief Suma una muestra al intervalo en curso de cada resolución.
+  *
+  * Cuando la muestra cae en un intervalo nuevo el anterior se guarda en el bloque en RAM; si el
+  * intervalo nuevo está en otro bloque, el anterior se envía a la cache (y a la tarjeta en segundo
+  * plano) y se lee el que corresponde. Si el lugar del intervalo nuevo ya lo tiene (se guardó
+  * antes de un reinicio), la suma continúa desde ahí.
+  *
+  * @param rrd Puntero a la estructura rrd_t.
+  * @param sample Muestra con tiempo en segundos y ticks crudos.
+  *
+  * @retval SD_OK, u otro sd_err_t si falló el acceso a la tarjeta (la muestra no se suma a esa resolución).
+  */
+sd_err_t rrdUpdate(rrd_t *rrd, const logSample_t *sample)
+{
+	assert(rrd);
+	assert(sample);
+
+	sd_err_t err = SD_OK;
+
+	for (uint8_t i = 0; i < rrd->num_tiers; i++)
+	{
+		rrdArchive_t *a = &rrd->tier[i];
+		uint32_t start = sample->time - sample->time % a->step;
+
+		if (a->acc.start != start)
+		{
+			if (a->acc.count > 0) memcpy(&a->data[rrdOffset(a, a->acc.start)], &a->acc, sizeof(rrdBucket_t));
+
+			uint32_t block = rrdBlockOf(a, start);
+			if (block != a->block)
+			{
+				sd_err_t e = (a->dirty) ? rrdStore(a) : SD_OK;
+				if (e == SD_OK) e = rrdLoad(a, block, a->data);
+				if (e != SD_OK)
+				{
+					// se reintenta con la próxima muestra; el intervalo en curso se pierde
+					a->block = RRD_EMPTY;
+					rrdEmpty(&a->acc, RRD_EMPTY);
+					err = e;
+					continue;
+				}
+				a->block = block;
+			}
+
+			memcpy(&a->acc, &a->data[rrdOffset(a, start)], sizeof(rrdBucket_t));
+			if (a->acc.start != start) rrdEmpty(&a->acc, start);
+		}
+
+		if (a->acc.count == 0 || sample->raw_temp < a->acc.min_T) a->acc.min_T = sample->raw_temp;
+		if (a->acc.count == 0 || sample->raw_temp > a->acc.max_T) a->acc.max_T = sample->raw_temp;
+		if (a->acc.count == 0 || sample->raw_hum < a->acc.min_H) a->acc.min_H = sample->raw_hum;
+		if (a->acc.count == 0 || sample->raw_hum > a->acc.max_H) a->acc.max_H = sample->raw_hum;
+		a->acc.sum_T += sample->raw_temp;
+		a->acc.sum_H += sample->raw_hum;
+		a->acc.count++;
+		a->dirty = true;
+	}
+
+	return err;
+}
+
+/**
+  * @brief Guarda los intervalos en curso si venció el tiempo máximo de latencia.
+  *
+  * Debe llamarse periódicamente desde el superloop. Los bloques pasan por la cache y se
+  * escriben en segundo plano, como los del log; tras un reinicio rrdUpdate() retoma los
+  * intervalos en curso desde la última vez que se guardaron.
+  *
+  * @param rrd Puntero a la estructura rrd_t.
+  *
+  * @retval SD_OK si no había nada que guardar o se guardó, otro sd_err_t en caso de error.
+  */
+sd_err_t rrdProcess(rrd_t *rrd)
+{
+	assert(rrd);
+
+	bool dirty = false;
+	for (uint8_t i = 0; i < rrd->num_tiers; i++) dirty |= rrd->tier[i].dirty;
+
+	if (!dirty || !delayRead(&rrd->latency)) return SD_OK; // delayRead arranca la cuenta con el primer cambio
+
+	for (uint8_t i = 0; i < rrd->num_tiers; i++)
+	{
+		if (!rrd->tier[i].dirty) continue;
+
+		sd_err_t err = rrdStore(&rrd->tier[i]);
+		if (err != SD_OK) return err;
+	}
+
+	return SD_OK;
+}
+
+/**
+  * @brief Agrega los intervalos de una ventana que termina en now.
+  *
+  * Usa la resolución más fina que cubra la ventana con hasta RRD_QUERY_MAX_BUCKETS intervalos
+  * (o la más gruesa), así que lee a lo sumo unos pocos bloques. La ventana se extiende al
+  * comienzo del intervalo que contiene now - window e incluye el intervalo en curso; se recorta a
+  * la capacidad del archivo. Los intervalos sin muestras o ya sobrescritos no se cuentan.
+  *
+  * @param rrd Puntero a la estructura rrd_t.
+  * @param now Fin de la ventana (s, en la misma base que el tiempo de las muestras).
+  * @param window Duración de la ventana en s.
+  * @param result Destino del agregado (start es el comienzo efectivo de la ventana).
+  * @param step Destino del paso de la resolución usada (puede ser NULL).
+  *
+  * @retval SD_OK, u otro sd_err_t si falló una lectura.
+  */
+sd_err_t rrdQuery(rrd_t *rrd, uint32_t now, uint32_t window, rrdBucket_t *result, uint32_t *step)
+{
+	assert(rrd);
+	assert(result);
+
+	uint8_t t = 0;
+	while (t + 1 < rrd->num_tiers && window / rrd->tier[t].step > RRD_QUERY_MAX_BUCKETS) t++;
+
+	rrdArchive_t *a = &rrd->tier[t];
+	uint32_t span = (a->capacity - 1) * a->step;
+	if (window > span) window = span;
+	if (window > now) window = now;
+
+	uint32_t last = now - now % a->step;
+	uint32_t first = (now - window) - (now - window) % a->step;
+	uint32_t loaded = RRD_EMPTY;
+
+	rrdEmpty(result, first);
+	if (step != NULL) *step = a->step;
+
+	for (uint32_t s = first; s <= last; s += a->step)
+	{
+		rrdBucket_t b;
+
+		if (s == a->acc.start)
+		{
+			b = a->acc;
+		}
+		else
+		{
+			uint32_t block = rrdBlockOf(a, s);
+			const uint8_t *data = a->data;
+
+			if (block != a->block)
+			{
+				if (block != loaded)
+				{
+					sd_err_t err = rrdLoad(a, block, rrd->scratch);
+					if (err != SD_OK) return err;
+					loaded = block;
+				}
+				data = rrd->scratch;
+			}
+			memcpy(&b, &data[rrdOffset(a, s)], sizeof(b));
+			if (b.start != s) continue;
+		}
+		rrdAdd(result, &b);
+	}
+
+	return SD_OK;
+}
+
+/**
+  * @brief Descarta los intervalos en curso y borra los archivos en la tarjeta.
+  *
+  * @param rrd Puntero a la estructura rrd_t.
+  *
+  * @retval Código de error de tipo sd_err_t del borrado.
+  */
+sd_err_t rrdReset(rrd_t *rrd)
+{
+	assert(rrd);
+
+	uint32_t first = rrd->tier[0].first_block;
+	uint32_t last = first + rrd->num_blocks - 1;
+
+	for (uint8_t i = 0; i < rrd->num_tiers; i++)
+	{
+		rrd->tier[i].block = RRD_EMPTY;
+		rrd->tier[i].dirty = false;
+		rrdEmpty(&rrd->tier[i].acc, RRD_EMPTY);
+	}
+	delayInit(&rrd->latency, rrd->latency.duration); // delayStop() pierde la duración
+
+	SD_cacheInvalidateRange(first, last);
+	return SD_eraseRange(first, last);
+}
+
+/**
+  * @brief Lugar del intervalo que empieza en start dentro del archivo.
+  */
+static uint32_t rrdIndex(const rrdArchive_t *a, uint32_t start)
+{
+	return (start / a->step) % a->capacity;
+}
+
+/**
+  * @brief Bloque (relativo a first_block) que guarda el intervalo que empieza en start.
+  */
+static uint32_t rrdBlockOf(const rrdArchive_t *a, uint32_t start)
+{
+	return rrdIndex(a, start) / RRD_BUCKETS_PER_BLOCK;
+}
+
+/**
+  * @brief Posición en bytes del intervalo que empieza en start dentro de su bloque.
+  * @note	La cabecera ocupa 12 bytes, así que los intervalos no quedan alineados a 8: se copian con memcpy.
+  */
+static uint32_t rrdOffset(const rrdArchive_t *a, uint32_t start)
+{
+	return sizeof(rrdHeader_t) + (rrdIndex(a, start) % RRD_BUCKETS_PER_BLOCK) * sizeof(rrdBucket_t);
+}
+
+/**
+  * @brief Lee un bloque del archivo a través de la cache.
+  * @note	Un bloque que no es de este archivo (borrado, nunca escrito o de otra configuración)
+  * 		se reemplaza por uno con todos los intervalos libres.
+  */
+static sd_err_t rrdLoad(rrdArchive_t *a, uint32_t block, uint8_t *data)
+{
+	rrdHeader_t hdr;
+
+	sd_err_t err = SD_cacheRead(a->first_block + block, data);
+	if (err != SD_OK) return err;
+
+	memcpy(&hdr, data, sizeof(hdr));
+	if (hdr.magic != RRD_MAGIC || hdr.step != a->step || hdr.capacity != a->capacity)
+	{
+		hdr.magic = RRD_MAGIC;
+		hdr.step = a->step;
+		hdr.capacity = a->capacity;
+		memset(data, 0xFF, SD_BLOCK_SIZE); // start = RRD_EMPTY en todos los lugares
+		memcpy(data, &hdr, sizeof(hdr));
+	}
+	return SD_OK;
+}
+
+/**
+  * @brief Copia el intervalo en curso a su lugar y envía el bloque en RAM a la cache.
+  * @note	La escritura en la tarjeta se solicita en segundo plano (SD_flushStart).
+  */
+static sd_err_t rrdStore(rrdArchive_t *a)
+{
+	if (a->block == RRD_EMPTY) return SD_OK;
+
+	if (a->acc.count > 0) memcpy(&a->data[rrdOffset(a, a->acc.start)], &a->acc, sizeof(rrdBucket_t));
+
+	sd_err_t err = SD_cacheWrite(a->first_block + a->block, a->data);
+	if (err != SD_OK) return err;
+
+	a->dirty = false;
+	SD_flushStart();
+	return SD_OK;
+}
+
+/**
+  * @brief Intervalo sin muestras.
+  */
+static void rrdEmpty(rrdBucket_t *b, uint32_t start)
+{
+	memset(b, 0, sizeof(*b));
+	b->start = start;
+	b->min_T = UINT16_MAX;
+	b->min_H = UINT16_MAX;
+}
+
+/**
+  * @brief Suma al agregado dst las muestras del intervalo src.
+  */
+static void rrdAdd(rrdBucket_t *dst, const rrdBucket_t *src)
+{
+	if (src->count == 0) return;
+
+	if (src->min_T < dst->min_T) dst->min_T = src->min_T;
+	if (src->max_T > dst->max_T) dst->max_T = src->max_T;
+	if (src->min_H < dst->min_H) dst->min_H = src->min_H;
+	if (src->max_H > dst->max_H) dst->max_H = src->max_H;
+	dst->sum_T += src->sum_T;
+	dst->sum_H += src->sum_H;
+	dst->count += src->count;
+}
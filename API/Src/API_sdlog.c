@@ -0,0 +1,669 @@
+/*
+ * API_sdlog.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_sdlog.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "API_crc.h"
+#include "sd_cache.h"
+#include "sht30.h"
+
+static uint16_t sdlogCapacity(const sdlog_t *log);
+static uint16_t sdlogMaxRecord(uint8_t encoding);
+static void sdlogReference(const sdlog_t *log, logSample_t *ref);
+static uint16_t sdlogEncode(sdlog_t *log, const logSample_t *sample);
+static bool sdlogDecode(const logHeader_t *hdr, const uint8_t *payload, gorilla_t *g, uint16_t index, uint16_t *off,
+		uint16_t len, logSample_t *sample, const logSample_t *prev);
+static uint16_t sdlogDecodeRecords(const logHeader_t *hdr, const uint8_t *payload, uint16_t first, logSample_t *samples, uint16_t max);
+static void sdlogReplay(sdlog_t *log);
+static uint8_t *sdlogPayload(sdlog_t *log);
+static bool sdlogCheckBlock(const uint8_t *block, logHeader_t *hdr);
+static sd_err_t sdlogProbe(sdlog_t *log, uint32_t index, logHeader_t *hdr, bool *valid);
+static void sdlogStartBlock(sdlog_t *log, uint32_t head, uint32_t seq);
+static void sdlogNextBlock(sdlog_t *log);
+static sd_err_t sdlogWriteHead(sdlog_t *log);
+
+/**
+  * @brief Inicializa la estructura del log sobre una región de bloques de la SD.
+  *
+  * El log es circular: los bloques se escriben en orden dentro de la región y al llegar
+  * al final se vuelve al primero, sobrescribiendo los más antiguos. De esta forma las
+  * escrituras se reparten en toda la región en lugar de repetirse sobre un único bloque.
+  *
+  * @param log Puntero a la estructura sdlog_t a inicializar.
+  * @param first_block Primer bloque de la región reservada para el log.
+  * @param num_blocks Cantidad de bloques de la región.
+  * @param state_len Tamaño en bytes del estado de la aplicación guardado en cada bloque.
+  * @param max_latency Tiempo máximo en ms que una muestra puede quedar solo en RAM.
+  *
+  * @retval void
+  */
+void sdlogInit(sdlog_t *log, uint32_t first_block, uint32_t num_blocks, uint16_t state_len, tick_t max_latency)
+{
+	assert(log);
+	assert(num_blocks > 0);
+	assert(sizeof(logHeader_t) + state_len + GORILLA_MAX_RECORD <= SD_BLOCK_SIZE);
+
+	log->first_block = first_block;
+	log->num_blocks = num_blocks;
+	log->state_len = state_len;
+	log->dirty = false;
+	log->encoding = SDLOG_ENC_DEFAULT;
+	delayInit(&log->latency, max_latency);
+	sdlogStartBlock(log, 0, 1);
+}
+
+/**
+  * @brief Selecciona la codificación de los registros.
+  *
+  * Se aplica a partir del próximo bloque vacío; un bloque ya comenzado (por ejemplo el
+  * recuperado tras un reinicio) conserva la codificación con la que fue escrito.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  * @param encoding Codificación de tipo logEncoding_t.
+  *
+  * @retval void
+  */
+void sdlogSetEncoding(sdlog_t *log, logEncoding_t encoding)
+{
+	assert(log);
+
+	log->encoding = encoding;
+	if (log->hdr.count == 0) log->hdr.encoding = encoding;
+}
+
+/**
+  * @brief Recupera la posición de escritura y el estado de la aplicación desde la tarjeta.
+  *
+  * Los bloques se escriben en orden y cada uno lleva el número de secuencia del anterior + 1,
+  * por lo que desde el bloque 0 la región contiene primero la vuelta actual del log (secuencia
+  * seq0, seq0 + 1, ...) y después bloques de la vuelta anterior o sin escribir. La cabeza es el
+  * último bloque válido (magic y CRC correctos) cuya secuencia es seq0 + índice, y se busca por
+  * bisección leyendo del orden de log2(num_blocks) bloques en lugar de toda la región.
+  * Solo el bloque cabeza se reescribe en su lugar, así que un bloque dañado por un corte de
+  * energía es siempre la cabeza: la búsqueda lo descarta y continúa desde el anterior.
+  *
+  * Si la cabeza no estaba completa se siguen agregando muestras en ella, si no se continúa en
+  * el bloque siguiente. Si no se encuentra ningún bloque válido el log queda vacío y el estado en 0.
+  *
+  * @param log Puntero a la estructura sdlog_t inicializada con sdlogInit().
+  * @param state Puntero donde se copia el estado guardado (state_len bytes).
+  *
+  * @retval SD_OK si se completó la búsqueda, otro sd_err_t si falló una lectura.
+  */
+sd_err_t sdlogRecover(sdlog_t *log, void *state)
+{
+	assert(log);
+	assert(state);
+
+	logHeader_t hdr;
+	bool valid;
+	uint32_t best;
+
+	log->dirty = false;
+
+	sd_err_t err = sdlogProbe(log, 0, &hdr, &valid);
+	if (err != SD_OK) return err;
+
+	if (valid)
+	{
+		uint32_t seq0 = hdr.seq;
+		uint32_t lo = 0, hi = log->num_blocks - 1; // el bloque lo siempre pertenece a la vuelta actual
+
+		while (lo < hi)
+		{
+			uint32_t mid = lo + (hi - lo + 1) / 2;
+
+			err = sdlogProbe(log, mid, &hdr, &valid);
+			if (err != SD_OK) return err;
+
+			if (valid && hdr.seq == seq0 + mid) lo = mid;
+			else hi = mid - 1;
+		}
+		best = lo;
+	}
+	else
+	{
+		// bloque 0 dañado o sin escribir: la cabeza es el último bloque de la vuelta anterior, si existe
+		best = log->num_blocks - 1;
+		err = sdlogProbe(log, best, &hdr, &valid);
+		if (err != SD_OK) return err;
+
+		if (!valid)
+		{
+			memset(state, 0, log->state_len);
+			memset(&log->block[sizeof(logHeader_t)], 0, log->state_len);
+			sdlogStartBlock(log, 0, 1);
+			return SD_OK;
+		}
+	}
+
+	err = SD_cacheRead(log->first_block + best, log->block);
+	if (err != SD_OK) return err;
+
+	sdlogCheckBlock(log->block, &hdr);
+	memcpy(state, &log->block[sizeof(logHeader_t)], log->state_len);
+	log->head = best;
+	log->hdr = hdr;
+	sdlogReplay(log);
+
+	if (log->hdr.flags & SDLOG_FLAG_SEALED) sdlogNextBlock(log);
+
+	return SD_OK;
+}
+
+/**
+  * @brief Indica si la muestra va a ser la primera de un bloque al agregarla con sdlogAppend().
+  *
+  * Permite que la aplicación lleve en su estado valores parciales del bloque (por ejemplo una
+  * estadística solo de sus muestras) y los reinicie antes de agregar la primera.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  *
+  * @retval true si el bloque en escritura está vacío o completo.
+  */
+bool sdlogOpensBlock(const sdlog_t *log)
+{
+	assert(log);
+
+	return log->hdr.count == 0 || (log->hdr.flags & SDLOG_FLAG_SEALED);
+}
+
+/**
+  * @brief Agrega una muestra al log.
+  *
+  * La muestra se empaqueta en el bloque en escritura, que se mantiene en RAM junto con una
+  * copia del estado de la aplicación. El bloque se escribe en la tarjeta recién cuando se
+  * completa o cuando vence el tiempo máximo de latencia (ver sdlogProcess()), de modo que
+  * una escritura física transporta muchas muestras.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  * @param sample Puntero a la muestra a agregar.
+  * @param state Puntero al estado de la aplicación (state_len bytes) a guardar con el bloque.
+  *
+  * @retval SD_OK si la muestra quedó registrada, otro sd_err_t si falló la escritura del bloque.
+  */
+sd_err_t sdlogAppend(sdlog_t *log, const logSample_t *sample, const void *state)
+{
+	assert(log);
+	assert(sample);
+
+	// el bloque completo ya se escribió al cerrarse: se sigue en el próximo
+	if (log->hdr.flags & SDLOG_FLAG_SEALED) sdlogNextBlock(log);
+
+	if (log->hdr.count == 0) log->hdr.time = sample->time;
+
+	log->hdr.used = sdlogEncode(log, sample);
+	log->hdr.count++;
+	log->last = *sample;
+
+	if (state != NULL) memcpy(&log->block[sizeof(logHeader_t)], state, log->state_len);
+
+	if (log->hdr.used + sdlogMaxRecord(log->hdr.encoding) > sdlogCapacity(log))
+	{
+		log->hdr.flags |= SDLOG_FLAG_SEALED;
+		return sdlogWriteHead(log);
+	}
+
+	if (!log->dirty)
+	{
+		log->dirty = true;
+		delayInit(&log->latency, log->latency.duration);
+		delayRead(&log->latency); // arranca la cuenta de latencia máxima
+	}
+
+	return SD_OK;
+}
+
+/**
+  * @brief Posición de la última muestra agregada: secuencia del bloque en escritura y muestras en él.
+  *
+  * Guardada junto con un estado que se escribe con menos frecuencia que el log, permite
+  * recorrer con sdlogRead() las muestras agregadas después.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  * @param seq Puntero donde se almacena el número de secuencia del bloque.
+  * @param count Puntero donde se almacena la cantidad de muestras del bloque.
+  *
+  * @retval void
+  */
+void sdlogPosition(const sdlog_t *log, uint32_t *seq, uint16_t *count)
+{
+	assert(log);
+	assert(seq);
+	assert(count);
+
+	*seq = log->hdr.seq;
+	*count = log->hdr.count;
+}
+
+/**
+  * @brief Lee muestras de un bloque del log a partir de una posición.
+  *
+  * El bloque en escritura se decodifica desde RAM; los anteriores se leen a través de la cache.
+  * Un bloque que ya se sobrescribió, dañado o con otra secuencia no devuelve muestras, igual
+  * que una posición posterior a la última muestra.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  * @param seq Número de secuencia del bloque.
+  * @param first Índice de la primera muestra a leer dentro del bloque.
+  * @param samples Destino de las muestras.
+  * @param max Cantidad máxima de muestras a leer.
+  * @param count Puntero donde se almacena la cantidad de muestras leídas (menos de max al terminar el bloque).
+  *
+  * @retval SD_OK, u otro sd_err_t si falló la lectura.
+  */
+sd_err_t sdlogRead(sdlog_t *log, uint32_t seq, uint16_t first, logSample_t *samples, uint16_t max, uint16_t *count)
+{
+	assert(log);
+	assert(samples);
+	assert(count);
+
+	uint32_t back = log->hdr.seq - seq;
+	logHeader_t hdr;
+
+	*count = 0;
+
+	if (back == 0)
+	{
+		*count = sdlogDecodeRecords(&log->hdr, sdlogPayload(log), first, samples, max);
+		return SD_OK;
+	}
+	if ((int32_t)back < 0 || back >= log->num_blocks) return SD_OK;
+
+	sd_err_t err = SD_cacheRead(log->first_block + (log->head + log->num_blocks - back) % log->num_blocks, log->scratch);
+	if (err != SD_OK) return err;
+
+	if (sdlogCheckBlock(log->scratch, &hdr) && hdr.seq == seq && hdr.state_len == log->state_len)
+	{
+		*count = sdlogDecodeRecords(&hdr, &log->scratch[sizeof(logHeader_t) + hdr.state_len], first, samples, max);
+	}
+	return SD_OK;
+}
+
+/**
+  * @brief Decodifica las muestras de un bloque del log ya leído, sin pasar por la tarjeta.
+  *
+  * Permite recorrer una imagen de la tarjeta desde herramientas externas con el mismo decodificador.
+  *
+  * @param block Bloque completo (512 bytes).
+  * @param first Índice de la primera muestra a devolver.
+  * @param samples Destino de las muestras.
+  * @param max Cantidad máxima de muestras a devolver.
+  *
+  * @retval Cantidad de muestras decodificadas, 0 si el bloque no es válido.
+  */
+uint16_t sdlogDecodeBlock(const uint8_t *block, uint16_t first, logSample_t *samples, uint16_t max)
+{
+	assert(block);
+	assert(samples);
+
+	logHeader_t hdr;
+
+	if (!sdlogCheckBlock(block, &hdr)) return 0;
+
+	return sdlogDecodeRecords(&hdr, &block[sizeof(logHeader_t) + hdr.state_len], first, samples, max);
+}
+
+/**
+  * @brief Escribe el bloque parcial si venció el tiempo máximo de latencia.
+  *
+  * Debe llamarse periódicamente desde el superloop. El bloque parcial se escribe en su
+  * lugar definitivo sin marcarlo como completo, por lo que tras un reinicio sdlogRecover()
+  * lo retoma y las muestras siguientes se agregan a continuación.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  *
+  * @retval SD_OK si no había nada que escribir o se escribió, otro sd_err_t en caso de error.
+  */
+sd_err_t sdlogProcess(sdlog_t *log)
+{
+	assert(log);
+
+	if (log->dirty && delayRead(&log->latency)) return sdlogWriteHead(log);
+
+	return SD_OK;
+}
+
+/**
+  * @brief Escribe el bloque en escritura si tiene muestras pendientes, sin esperar la latencia.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  *
+  * @retval Código de error de tipo sd_err_t.
+  */
+sd_err_t sdlogFlush(sdlog_t *log)
+{
+	assert(log);
+
+	if (log->dirty) return sdlogWriteHead(log);
+
+	return SD_OK;
+}
+
+/**
+  * @brief Borra el log y comienza desde el primer bloque de la región con el estado dado.
+  *
+  * Toda la región se borra en la tarjeta con un único comando (SD_eraseRange), descartando
+  * antes los bloques de la región que estén en la cache. El tiempo de la última muestra se
+  * conserva y el bloque nuevo, con el estado indicado (normalmente en 0), se escribe inmediatamente.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  * @param state Puntero al nuevo estado de la aplicación.
+  *
+  * @retval SD_OK si el bloque quedó escrito, otro sd_err_t en caso de error.
+  */
+sd_err_t sdlogReset(sdlog_t *log, const void *state)
+{
+	assert(log);
+
+	uint32_t last_block = log->first_block + log->num_blocks - 1;
+	uint32_t last_time = sdlogLastTime(log);
+
+	SD_cacheInvalidateRange(log->first_block, last_block);
+	sd_err_t err = SD_eraseRange(log->first_block, last_block);
+
+	sdlogStartBlock(log, 0, log->hdr.seq + 1);
+	log->hdr.time = last_time;
+	log->dirty = false;
+	if (state != NULL) memcpy(&log->block[sizeof(logHeader_t)], state, log->state_len);
+
+	sd_err_t werr = sdlogWriteHead(log);
+
+	return (err != SD_OK) ? err : werr;
+}
+
+/**
+  * @brief Devuelve el tiempo de la última muestra registrada.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  *
+  * @retval Tiempo de la última muestra, o 0 si el log está vacío.
+  */
+uint32_t sdlogLastTime(sdlog_t *log)
+{
+	assert(log);
+
+	if (log->hdr.count == 0) return log->hdr.time;
+
+	return log->last.time;
+}
+
+/**
+  * @brief Bytes disponibles para registros en cada bloque.
+  */
+static uint16_t sdlogCapacity(const sdlog_t *log)
+{
+	return SD_BLOCK_SIZE - sizeof(logHeader_t) - log->state_len;
+}
+
+/**
+  * @brief Tamaño máximo de un registro según la codificación del bloque.
+  */
+static uint16_t sdlogMaxRecord(uint8_t encoding)
+{
+	switch (encoding)
+	{
+		case SDLOG_ENC_GORILLA: return GORILLA_MAX_RECORD;
+		case SDLOG_ENC_DELTA:
+		default: return RECORD_MAX_SIZE;
+	}
+}
+
+/**
+  * @brief Muestra de referencia para el próximo registro del bloque en escritura.
+  * @note	Para la primera muestra del bloque es el tiempo del bloque con valores en 0.
+  */
+static void sdlogReference(const sdlog_t *log, logSample_t *ref)
+{
+	if (log->hdr.count > 0)
+	{
+		*ref = log->last;
+		return;
+	}
+
+	memset(ref, 0, sizeof(*ref));
+	ref->time = log->hdr.time;
+}
+
+/**
+  * @brief Codifica una muestra a continuación de los registros del bloque en escritura.
+  * @retval Bytes de registros usados en el bloque incluyendo la muestra nueva.
+  */
+static uint16_t sdlogEncode(sdlog_t *log, const logSample_t *sample)
+{
+	uint8_t *dst = sdlogPayload(log) + log->hdr.used;
+
+	switch (log->hdr.encoding)
+	{
+		case SDLOG_ENC_GORILLA:
+		{
+			float values[GORILLA_VALUES] = { sample->temp, sample->hum };
+
+			if (log->hdr.count == 0) gorillaInit(&log->gorilla, log->hdr.time);
+			return gorillaEncode(&log->gorilla, sdlogPayload(log), sample->time, values);
+		}
+
+		case SDLOG_ENC_DELTA:
+		default:
+		{
+			logSample_t ref;
+			sdlogReference(log, &ref);
+			return log->hdr.used + recordEncode(dst, sample, &ref);
+		}
+	}
+}
+
+/**
+  * @brief Decodifica la muestra siguiente de los registros de un bloque.
+  * @note	SDLOG_ENC_DELTA guarda los ticks crudos; en SDLOG_ENC_GORILLA se recalculan
+  * 		desde °C y %HR en float, sin pérdida.
+  * @param  hdr: Cabecera del bloque.
+  * @param  payload: Registros del bloque.
+  * @param  g: Estado del descompresor para SDLOG_ENC_GORILLA (se inicializa en el registro 0).
+  * @param  index: Número de registro dentro del bloque.
+  * @param  off: Offset del registro dentro de los registros del bloque; se actualiza al siguiente.
+  * @param  len: Bytes de registros válidos en el bloque.
+  * @param  prev: Muestra de referencia (ver sdlogReference).
+  * @retval true si se decodificó la muestra, false si el registro está incompleto o la codificación es desconocida.
+  */
+static bool sdlogDecode(const logHeader_t *hdr, const uint8_t *payload, gorilla_t *g, uint16_t index, uint16_t *off,
+		uint16_t len, logSample_t *sample, const logSample_t *prev)
+{
+	const uint8_t *src = payload + *off;
+	uint16_t left = len - *off;
+
+	switch (hdr->encoding)
+	{
+		case SDLOG_ENC_GORILLA:
+		{
+			float values[GORILLA_VALUES];
+
+			if (index == 0) gorillaInit(g, hdr->time);
+			memset(sample, 0, sizeof(*sample));
+			if (!gorillaDecode(g, payload, len, &sample->time, values)) return false;
+
+			sample->temp = values[0];
+			sample->hum = values[1];
+			*off = (uint16_t)((g->bit + 7) / 8);
+			break;
+		}
+
+		case SDLOG_ENC_DELTA:
+		{
+			uint8_t n = recordDecode(src, left, sample, prev);
+			*off += n;
+			return n > 0;
+		}
+
+		default:
+			return false; // codificación desconocida: el bloque no se interpreta
+	}
+
+	sample->raw_temp = SHT30_temperatureToRaw(sample->temp);
+	sample->raw_hum = SHT30_humidityToRaw(sample->hum);
+	return true;
+}
+
+/**
+  * @brief Decodifica los registros de un bloque desde el primero y devuelve los que siguen a first.
+  * @retval Cantidad de muestras copiadas en samples (hasta max).
+  */
+static uint16_t sdlogDecodeRecords(const logHeader_t *hdr, const uint8_t *payload, uint16_t first, logSample_t *samples, uint16_t max)
+{
+	gorilla_t g;
+	logSample_t prev, sample;
+	uint16_t off = 0, n = 0;
+
+	memset(&prev, 0, sizeof(prev));
+	prev.time = hdr->time;
+
+	for (uint16_t i = 0; i < hdr->count && n < max; i++)
+	{
+		if (!sdlogDecode(hdr, payload, &g, i, &off, hdr->used, &sample, &prev)) break;
+
+		if (i >= first) samples[n++] = sample;
+		prev = sample;
+	}
+	return n;
+}
+
+/**
+  * @brief Recorre los registros del bloque recuperado para obtener la última muestra.
+  * @note	Si un registro no puede decodificarse el bloque se trunca en ese punto y se
+  * 		marca como completo, para que las muestras nuevas vayan al bloque siguiente.
+  */
+static void sdlogReplay(sdlog_t *log)
+{
+	uint16_t count = log->hdr.count;
+	uint16_t used = log->hdr.used;
+	uint16_t off = 0;
+	logSample_t ref;
+
+	log->hdr.count = 0;
+	log->hdr.used = 0;
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		logSample_t sample;
+		sdlogReference(log, &ref);
+
+		if (!sdlogDecode(&log->hdr, sdlogPayload(log), &log->gorilla, log->hdr.count, &off, used, &sample, &ref))
+		{
+			log->hdr.flags |= SDLOG_FLAG_SEALED;
+			break;
+		}
+
+		log->last = sample;
+		log->hdr.count++;
+		log->hdr.used = off;
+	}
+}
+
+/**
+  * @brief Puntero al inicio de los registros dentro del bloque en escritura.
+  */
+static uint8_t *sdlogPayload(sdlog_t *log)
+{
+	return &log->block[sizeof(logHeader_t) + log->state_len];
+}
+
+/**
+  * @brief Verifica magic y CRC de un bloque leído de la tarjeta.
+  *
+  * @param block Bloque leído (512 bytes).
+  * @param hdr Puntero donde se copia la cabecera del bloque.
+  *
+  * @retval true si el bloque pertenece al log y no está dañado.
+  */
+static bool sdlogCheckBlock(const uint8_t *block, logHeader_t *hdr)
+{
+	memcpy(hdr, block, sizeof(logHeader_t));
+	if (hdr->magic != SDLOG_MAGIC) return false;
+	if (sizeof(logHeader_t) + hdr->state_len + hdr->used > SD_BLOCK_SIZE) return false;
+
+	return crc32ZeroedField(block, SD_BLOCK_SIZE, offsetof(logHeader_t, crc)) == hdr->crc;
+}
+
+/**
+  * @brief Lee un bloque de la región y verifica que sea un bloque válido de este log.
+  *
+  * @param log Puntero a la estructura sdlog_t (se usa su buffer de bloque).
+  * @param index Índice del bloque dentro de la región.
+  * @param hdr Puntero donde se copia la cabecera del bloque.
+  * @param valid Puntero donde se indica si el bloque es válido.
+  *
+  * @retval Código de error de tipo sd_err_t de la lectura.
+  */
+static sd_err_t sdlogProbe(sdlog_t *log, uint32_t index, logHeader_t *hdr, bool *valid)
+{
+	sd_err_t err = SD_cacheRead(log->first_block + index, log->block);
+	if (err != SD_OK) return err;
+
+	*valid = sdlogCheckBlock(log->block, hdr) && hdr->state_len == log->state_len;
+	return SD_OK;
+}
+
+/**
+  * @brief Prepara un bloque vacío como bloque en escritura.
+  * @note	La copia del estado de la aplicación del bloque en escritura se conserva.
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  * @param head Índice del bloque dentro de la región.
+  * @param seq Número de secuencia del bloque.
+  */
+static void sdlogStartBlock(sdlog_t *log, uint32_t head, uint32_t seq)
+{
+	log->head = head;
+
+	memset(&log->hdr, 0, sizeof(log->hdr));
+	log->hdr.magic = SDLOG_MAGIC;
+	log->hdr.seq = seq;
+	log->hdr.encoding = log->encoding;
+	log->hdr.state_len = log->state_len;
+
+	memset(log->block, 0xFF, sizeof(logHeader_t));
+	memset(sdlogPayload(log), 0xFF, sdlogCapacity(log));
+}
+
+/**
+  * @brief Avanza al bloque siguiente de la región conservando el estado y el tiempo de la última muestra.
+  */
+static void sdlogNextBlock(sdlog_t *log)
+{
+	uint32_t last_time = sdlogLastTime(log);
+
+	sdlogStartBlock(log, (log->head + 1) % log->num_blocks, log->hdr.seq + 1);
+
+	log->hdr.time = last_time;
+	log->dirty = false;
+}
+
+/**
+  * @brief Serializa la cabecera en el bloque en escritura, calcula el CRC y lo envía a la tarjeta.
+  * @note	El bloque pasa por la cache y se solicita su escritura en segundo plano
+  * 		(SD_flushStart), que avanza con SD_cacheProcess().
+  *
+  * @param log Puntero a la estructura sdlog_t.
+  *
+  * @retval Código de error de tipo sd_err_t.
+  */
+static sd_err_t sdlogWriteHead(sdlog_t *log)
+{
+	memcpy(log->block, &log->hdr, sizeof(logHeader_t));
+	log->hdr.crc = crc32ZeroedField(log->block, SD_BLOCK_SIZE, offsetof(logHeader_t, crc));
+	memcpy(&log->block[offsetof(logHeader_t, crc)], &log->hdr.crc, sizeof(log->hdr.crc));
+
+	sd_err_t err = SD_cacheWrite(log->first_block + log->head, log->block);
+	if (err != SD_OK) return err;
+
+	SD_flushStart();
+	log->dirty = false;
+	return SD_OK;
+}
@@ -0,0 +1,160 @@
+/*
+ * API_snapshot.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_snapshot.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "API_crc.h"
+#include "sd_cache.h"
+
+static bool snapshotCheck(const snapshot_t *s, snapshotHeader_t *hdr);
+
+/**
+  * @brief Inicializa la copia del estado sobre SNAPSHOT_COPIES bloques de la SD.
+  *
+  * @param s Puntero a la estructura snapshot_t a inicializar.
+  * @param first_block Primer bloque reservado para las copias.
+  * @param data Estado de la aplicación que se guarda y se recupera.
+  * @param len Tamaño en bytes del estado.
+  * @param max_latency Tiempo máximo en ms que un cambio puede quedar solo en RAM.
+  *
+  * @retval void
+  */
+void snapshotInit(snapshot_t *s, uint32_t first_block, void *data, uint16_t len, tick_t max_latency)
+{
+	assert(s);
+	assert(data);
+	assert(sizeof(snapshotHeader_t) + len <= SD_BLOCK_SIZE);
+
+	memset(s, 0, sizeof(*s));
+	s->first_block = first_block;
+	s->data = data;
+	s->len = len;
+	delayInit(&s->latency, max_latency);
+}
+
+/**
+  * @brief Recupera el estado desde la copia válida más reciente.
+  *
+  * Una copia con magic, tamaño o CRC incorrectos (borrada, de otra versión o con la escritura
+  * interrumpida) se descarta. Si ninguna es válida el estado de la aplicación no se modifica.
+  *
+  * @param s Puntero a la estructura snapshot_t.
+  * @param found Puntero donde se indica si se encontró una copia válida.
+  *
+  * @retval SD_OK si se leyeron las copias, otro sd_err_t si falló una lectura.
+  */
+sd_err_t snapshotRecover(snapshot_t *s, bool *found)
+{
+	assert(s);
+	assert(found);
+
+	snapshotHeader_t hdr;
+	uint8_t best = SNAPSHOT_COPIES;
+	uint32_t best_seq = 0;
+
+	*found = false;
+	s->dirty = false;
+
+	for (uint8_t i = 0; i < SNAPSHOT_COPIES; i++)
+	{
+		sd_err_t err = SD_cacheRead(s->first_block + i, s->block);
+		if (err != SD_OK) return err;
+
+		if (snapshotCheck(s, &hdr) && (best == SNAPSHOT_COPIES || (int32_t)(hdr.seq - best_seq) > 0))
+		{
+			best = i;
+			best_seq = hdr.seq;
+		}
+	}
+	if (best == SNAPSHOT_COPIES) return SD_OK;
+
+	sd_err_t err = SD_cacheRead(s->first_block + best, s->block);
+	if (err != SD_OK) return err;
+
+	memcpy(s->data, &s->block[sizeof(snapshotHeader_t)], s->len);
+	s->seq = best_seq;
+	*found = true;
+	return SD_OK;
+}
+
+/**
+  * @brief Indica que el estado cambió; la cuenta de latencia arranca con el primer cambio.
+  *
+  * @param s Puntero a la estructura snapshot_t.
+  *
+  * @retval void
+  */
+void snapshotTouch(snapshot_t *s)
+{
+	assert(s);
+
+	if (s->dirty) return;
+
+	s->dirty = true;
+	delayInit(&s->latency, s->latency.duration);
+	delayRead(&s->latency);
+}
+
+/**
+  * @brief Indica si hay cambios que esperaron el tiempo máximo de latencia.
+  *
+  * Debe llamarse periódicamente desde el superloop; cuando devuelve true la aplicación escribe
+  * la copia con snapshotWrite() (antes puede llevar a la tarjeta lo que el estado referencia).
+  *
+  * @param s Puntero a la estructura snapshot_t.
+  *
+  * @retval true si hay que escribir la copia.
+  */
+bool snapshotDue(snapshot_t *s)
+{
+	assert(s);
+
+	return s->dirty && delayRead(&s->latency);
+}
+
+/**
+  * @brief Escribe el estado en la copia siguiente, sin esperar la latencia.
+  * @note	El bloque pasa por la cache y se solicita su escritura en segundo plano (SD_flushStart).
+  *
+  * @param s Puntero a la estructura snapshot_t.
+  *
+  * @retval Código de error de tipo sd_err_t.
+  */
+sd_err_t snapshotWrite(snapshot_t *s)
+{
+	assert(s);
+
+	snapshotHeader_t hdr = { SNAPSHOT_MAGIC, s->seq + 1, s->len, 0, 0 };
+
+	memset(s->block, 0xFF, sizeof(s->block));
+	memcpy(s->block, &hdr, sizeof(hdr));
+	memcpy(&s->block[sizeof(hdr)], s->data, s->len);
+	hdr.crc = crc32ZeroedField(s->block, sizeof(snapshotHeader_t) + s->len, offsetof(snapshotHeader_t, crc));
+	memcpy(&s->block[offsetof(snapshotHeader_t, crc)], &hdr.crc, sizeof(hdr.crc));
+
+	sd_err_t err = SD_cacheWrite(s->first_block + hdr.seq % SNAPSHOT_COPIES, s->block);
+	if (err != SD_OK) return err;
+
+	SD_flushStart();
+	s->seq = hdr.seq;
+	s->dirty = false;
+	return SD_OK;
+}
+
+/**
+  * @brief Verifica la copia leída en s->block.
+  */
+static bool snapshotCheck(const snapshot_t *s, snapshotHeader_t *hdr)
+{
+	memcpy(hdr, s->block, sizeof(*hdr));
+	if (hdr->magic != SNAPSHOT_MAGIC || hdr->len != s->len) return false;
+
+	return crc32ZeroedField(s->block, sizeof(snapshotHeader_t) + s->len, offsetof(snapshotHeader_t, crc)) == hdr->crc;
+}
@@ -0,0 +1,122 @@
+/*
+ * API_stats.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Gus
+ */
+#include "API_stats.h"
+
+#include <assert.h>
+#include <string.h>
+
+/**
+  * @brief Inicializa la estadística sin muestras.
+  *
+  * @param s Puntero a la estadística.
+  *
+  * @retval void
+  */
+void statsInit(stats_t *s)
+{
+	assert(s);
+
+	memset(s, 0, sizeof(*s));
+}
+
+/**
+  * @brief Agrega una muestra.
+  *
+  * Actualiza la media con el desvío respecto de la media anterior y m2 con el producto de
+  * los desvíos antes y después (Welford): no resta cantidades grandes parecidas, así que no
+  * pierde precisión aunque los valores estén lejos de 0.
+  *
+  * @param s Puntero a la estadística.
+  * @param value Valor crudo.
+  * @param time Tiempo de la muestra.
+  *
+  * @retval void
+  */
+void statsPush(stats_t *s, uint16_t value, uint32_t time)
+{
+	assert(s);
+
+	if (s->count == UINT32_MAX) return;
+
+	s->count++;
+	if (s->count == 1 || value < s->min)
+	{
+		s->min = value;
+		s->min_time = time;
+	}
+	if (s->count == 1 || value > s->max)
+	{
+		s->max = value;
+		s->max_time = time;
+	}
+
+	double delta = value - s->mean;
+	s->mean += delta / s->count;
+	s->m2 += delta * (value - s->mean);
+}
+
+/**
+  * @brief Combina en dst la estadística de otro tramo de la serie.
+  *
+  * Con n = na + nb y d = media_b - media_a: media = media_a + d * nb / n y
+  * m2 = m2_a + m2_b + d^2 * na * nb / n (Chan). El resultado es el mismo que agregar las
+  * muestras de src una por una, salvo el redondeo. Ante un empate en el mínimo o el máximo
+  * se conserva el de dst, que es el primero si los tramos se combinan en orden.
+  *
+  * @param dst Estadística acumulada.
+  * @param src Estadística a agregar.
+  *
+  * @retval void
+  */
+void statsMerge(stats_t *dst, const stats_t *src)
+{
+	assert(dst);
+	assert(src);
+
+	if (src->count == 0) return;
+	if (dst->count == 0 || src->count > UINT32_MAX - dst->count)
+	{
+		if (dst->count == 0) *dst = *src;
+		return;
+	}
+
+	if (src->min < dst->min)
+	{
+		dst->min = src->min;
+		dst->min_time = src->min_time;
+	}
+	if (src->max > dst->max)
+	{
+		dst->max = src->max;
+		dst->max_time = src->max_time;
+	}
+
+	double na = dst->count;
+	double nb = src->count;
+	double n = na + nb;
+	double delta = src->mean - dst->mean;
+
+	dst->mean += delta * (nb / n);
+	dst->m2 += src->m2 + delta * delta * (na * nb / n);
+	dst->count += src->count;
+}
+
+/**
+  * @brief Varianza muestral (dividida por n - 1), en ticks^2.
+  *
+  * @param s Puntero a la estadística.
+  *
+  * @retval double 0 con menos de dos muestras.
+  */
+double statsVariance(const stats_t *s)
+{
+	assert(s);
+
+	if (s->count < 2) return 0;
+
+	return s->m2 / (s->count - 1);
+}
@@ -32,6 +32,8 @@ extern "C" {
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "API_debounce.h"
+#include "API_quantile.h"
+#include "API_stats.h"
 /* USER CODE END Includes */
 
 /* Exported types ------------------------------------------------------------*/
@@ -42,11 +44,25 @@ typedef enum{
 	RESET_DATA,
 } mainState_t;
 
+// acumulado desde el último reset, en ticks crudos: se convierte a °C y %HR solo al mostrarlo.
+// Se guarda aparte del log, en el bloque de estado de la SD (API_snapshot).
 typedef struct {
-	float sum_T;
-    float sum_H;
-    uint16_t cont;
+	uint64_t sum_T; // sumas exactas para el promedio; la cantidad de muestras es stats_T.count
+	uint64_t sum_H;
+	uint32_t log_seq; // incluye las muestras del log hasta la log_count-ésima del bloque log_seq
+	uint16_t log_count;
+	uint16_t reserved; // relleno explícito: la estructura se copia tal cual a la SD
+	stats_t stats_T;
+	stats_t stats_H;
+	quantile_t quant_T; // p5/p50/p95 desde el último reset
+	quantile_t quant_H;
 } Temp_data;
+
+// parciales de las muestras de un bloque del log: se guardan en el bloque y se combinan con statsMerge
+typedef struct {
+	stats_t block_T;
+	stats_t block_H;
+} Block_data;
 /* USER CODE END ET */
 
 /* Exported constants --------------------------------------------------------*/
@@ -78,6 +94,9 @@ void mainFSM_update(keyState_t button);
 #define LD2_GPIO_Port GPIOA
 #define SPI2_CS_Pin GPIO_PIN_12
 #define SPI2_CS_GPIO_Port GPIOB
+#define SHT30_ALERT_Pin GPIO_PIN_8
+#define SHT30_ALERT_GPIO_Port GPIOA
+#define SHT30_ALERT_EXTI_IRQn EXTI9_5_IRQn
 #define TMS_Pin GPIO_PIN_13
 #define TMS_GPIO_Port GPIOA
 #define TCK_Pin GPIO_PIN_14
@@ -21,19 +21,29 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
+#include "API_decimator.h"
 #include "API_delay.h"
 #include "API_led.h"
+#include "API_rrd.h"
+#include "API_sdlog.h"
+#include "API_snapshot.h"
 #include "API_uart.h"
 #include "sd_card.h"
+#include "sd_cache.h"
 #include "sht30.h"
+#include "sht30_sched.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
-
+typedef struct {
+	uint8_t bus;
+	uint8_t addr;
+} sensorConfig_t;
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
@@ -44,10 +54,35 @@
 /* Private macro -------------------------------------------------------------*/
 /* USER CODE BEGIN PM */
 #define DELAY_MEASURE			5000 // ms
-#define MAX_SIZE_TO_PRINT		100
-#define SD_SAVE_DIRECTION		0
+#define MAX_SIZE_TO_PRINT		160
+#define SD_STATE_FIRST_BLOCK	1 // SNAPSHOT_COPIES bloques con el acumulado (Temp_data)
+#define SD_LOG_FIRST_BLOCK		(SD_STATE_FIRST_BLOCK + SNAPSHOT_COPIES)
+#define SD_LOG_NUM_BLOCKS		1024 // con las parciales de 64 bytes entran unas 137 muestras por bloque: ~8 días a 5 s
+#define SD_LOG_MAX_LATENCY		60000 // ms
+#ifndef SD_LOG_ENCODING
+#define SD_LOG_ENCODING			SDLOG_ENC_DELTA // SDLOG_ENC_GORILLA para guardar °C y %HR en lugar de ticks
+#endif
+#define SD_RRD_FIRST_BLOCK		(SD_LOG_FIRST_BLOCK + SD_LOG_NUM_BLOCKS) // archivos de rrd_tiers a continuación del log
+#define SD_RRD_MAX_LATENCY		900000 // ms, los intervalos en curso se guardan cada 15 min
+#define SD_STATE_MAX_LATENCY	SD_RRD_MAX_LATENCY // ms, el acumulado se guarda con la misma frecuencia
+#define SD_REPLAY_BATCH			8 // muestras por lectura del log al reponer el acumulado
+#define SD_PENDING_SIZE			32 // muestras retenidas en RAM mientras la SD no está lista
+#define DELAY_SD_RETRY			5000 // ms
 #define SHT30_REPEATABILITY		SHT30_REPEATABILITY_HIGH
 #define SHT30_CLOCK_STREACHING	true
+#define SHT30_PERIODIC			true // true: modo periódico promediando en DELAY_MEASURE; false: single shot cada DELAY_MEASURE
+#define SHT30_USE_ART			false // modo ART (4 mps) en lugar de SHT30_PERIODIC_MPS
+#define SHT30_PERIODIC_MPS		SHT30_MPS_10
+#define SHT30_FETCH_PERIOD		100 // ms, 1/mps (250 con ART o SHT30_MPS_4)
+#define SHT30_NUM_SENSORS		2 // filas de sensor_cfg
+#ifndef SHT30_ALERT_MODE
+#define SHT30_ALERT_MODE		false // true: solo se mide y registra cuando T o HR salen de la banda (pin ALERT)
+#endif
+#define SHT30_ALERT_MPS			SHT30_MPS_1 // el sensor compara con los límites en cada medición
+#define SHT30_ALERT_PERIOD		1000 // ms, 1/SHT30_ALERT_MPS
+#define SHT30_ALERT_BAND_TEMP	(50UL * 65535 / 17500) // ±0,5 °C alrededor de la última muestra, en ticks
+#define SHT30_ALERT_BAND_HUM	(200UL * 65535 / 10000) // ±2 %HR, en ticks
+#define SHT30_ALERT_HEARTBEAT	900000 // ms, muestra aunque no haya alertas
 #define LED_CANT_BLINK			2
 #define LED_ON_TIME				200
 #define LED_OFF_SHORT_TIME		200
@@ -58,6 +93,8 @@
 I2C_HandleTypeDef hi2c1;
 
 SPI_HandleTypeDef hspi2;
+DMA_HandleTypeDef hdma_spi2_rx;
+DMA_HandleTypeDef hdma_spi2_tx;
 
 /* USER CODE BEGIN PV */
 
@@ -66,20 +103,56 @@ SPI_HandleTypeDef hspi2;
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_I2C1_Init(void);
 static void MX_SPI2_Init(void);
 /* USER CODE BEGIN PFP */
-
+static void emitSample(void);
+static void alertRearm(void);
+static void accumulate(const logSample_t *sample);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
-static uint8_t sd_rwbuffer[SD_BLOCK_SIZE];
+static sdlog_t sd_log;
+static rrd_t rollup;
+static snapshot_t data_snapshot;
 static Temp_data data;
+static Block_data block_data;
+static uint32_t time_base; // segundos
 static mainState_t current_state;
 static delay_t delay_measure;
+static delay_t delay_fetch;
+static sht30_t sensors[SHT30_NUM_SENSORS];
+static sht30_sched_t sensor_sched;
+static decimator_t sample_filter[SHT30_NUM_SENSORS]; // indexado como sensor_sched
+static delay_t delay_sd_retry;
 static char to_print[MAX_SIZE_TO_PRINT];
 
+static volatile bool alert_flag = false; // flanco del pin ALERT (EXTI)
+static bool heartbeat_due = false;
+static uint32_t alert_round_tick;
+static uint32_t alert_count;
+static uint32_t heartbeat_count;
+
+static bool sd_ready = false;
+static bool reset_requested = false;
+static logSample_t pending[SD_PENDING_SIZE];
+static uint16_t pending_count;
+
+// resoluciones del resumen en la SD: 1 día por minuto, 31 días por hora y 2 años por día
+static const rrdTier_t rrd_tiers[] = {
+	{ 60, 1440 },
+	{ 3600, 744 },
+	{ 86400, 732 },
+};
+
+// sensores en el bus; los que no responden al arrancar quedan fuera de las rondas
+static const sensorConfig_t sensor_cfg[SHT30_NUM_SENSORS] = {
+	{ SHT30_BUS_I2C1, SHT30_ADDR_DEFAULT },
+	{ SHT30_BUS_I2C1, SHT30_ADDR_ALT },
+};
+
 /**
   * @brief  Funcion para cambiar el estado de main FSM
   * @param	state: nuevo estado
@@ -89,33 +162,577 @@ static void setMainState(mainState_t state)
 	current_state = state;
 }
 
+/**
+  * @brief  Imprime por UART el resumen de latencias de un tipo de operación de la SD card
+  * @param	label: nombre de la operación
+  * @param	op: tipo de operación
+  */
+static void printSDLatency(const char *label, sd_op_t op)
+{
+	const sd_latency_t *lat = SD_getLatency(op);
+	if(lat == NULL || lat->count == 0) return;
+
+	snprintf(to_print, sizeof(to_print), "SDCard | %s: %lu ops, prom %lu us, min %lu us, max %lu us\n\r", label,
+			(unsigned long)lat->count, (unsigned long)(lat->total_us / lat->count),
+			(unsigned long)lat->min_us, (unsigned long)lat->max_us);
+	uartSendString((uint8_t*)to_print);
+}
+
+/**
+  * @brief  Imprime por UART los contadores de la cache de la SD card
+  */
+static void printSDCache(void)
+{
+	const sd_cache_stats_t *st = SD_cacheGetStats();
+
+	snprintf(to_print, sizeof(to_print), "SDCard | Cache: %lu hits, %lu misses, %lu escrituras\n\r",
+			(unsigned long)st->hits, (unsigned long)st->misses, (unsigned long)st->writebacks);
+	uartSendString((uint8_t*)to_print);
+}
+
+/**
+  * @brief  Imprime por UART el tiempo desde el reset en que ocurre una etapa del arranque
+  * @param	event: descripción de la etapa
+  */
+static void printBootTime(const char *event)
+{
+	snprintf(to_print, sizeof(to_print), "BOOT | %lu ms: %s\n\r", (unsigned long)HAL_GetTick(), event);
+	uartSendString((uint8_t*)to_print);
+}
+
+/**
+  * @brief  Suma una muestra al acumulado desde el último reset
+  * @note	El acumulado llega a la SD cada SD_STATE_MAX_LATENCY (ver mainFSM_update).
+  * @param	sample: muestra con el tiempo absoluto
+  */
+static void accumulate(const logSample_t *sample)
+{
+	data.sum_T+=sample->raw_temp;
+	data.sum_H+=sample->raw_hum;
+	statsPush(&data.stats_T, sample->raw_temp, sample->time);
+	statsPush(&data.stats_H, sample->raw_hum, sample->time);
+	quantilePush(&data.quant_T, sample->raw_temp);
+	quantilePush(&data.quant_H, sample->raw_hum);
+	snapshotTouch(&data_snapshot);
+}
+
+/**
+  * @brief  Suma una muestra al acumulado y al resumen por intervalos y la agrega al log de la SD
+  * @param	sample: muestra con el tiempo relativo al arranque (se le suma time_base)
+  */
+static void storeSample(logSample_t *sample)
+{
+	sample->time += time_base;
+
+	if (sdlogOpensBlock(&sd_log))
+	{
+		statsInit(&block_data.block_T);
+		statsInit(&block_data.block_H);
+	}
+	statsPush(&block_data.block_T, sample->raw_temp, sample->time);
+	statsPush(&block_data.block_H, sample->raw_hum, sample->time);
+	sdlogAppend(&sd_log, sample, &block_data); // se escribe al completar el bloque o al vencer SD_LOG_MAX_LATENCY
+	sdlogPosition(&sd_log, &data.log_seq, &data.log_count);
+	accumulate(sample);
+	rrdUpdate(&rollup, sample);
+}
+
+/**
+  * @brief  Borra el acumulado, el log y el resumen por intervalos, y guarda el acumulado vacío
+  */
+static void resetData(void)
+{
+	memset(&data, 0, sizeof(data));
+	memset(&block_data, 0, sizeof(block_data));
+	sdlogReset(&sd_log, &block_data);
+	sdlogPosition(&sd_log, &data.log_seq, &data.log_count);
+	snapshotWrite(&data_snapshot);
+	rrdReset(&rollup);
+}
+
+/**
+  * @brief  Recupera el acumulado de la SD y le suma las muestras que el log registró después
+  * @note	El acumulado se guarda cada SD_STATE_MAX_LATENCY y el log con mucha menos latencia: tras un
+  * 		corte de energía se reponen las muestras de los pocos bloques que siguen a la posición
+  * 		guardada en el acumulado. Sin copia válida el acumulado arranca vacío.
+  */
+static void recoverData(void)
+{
+	logSample_t batch[SD_REPLAY_BATCH];
+	uint32_t head_seq, seq, replayed = 0;
+	uint16_t head_count, first, n;
+	bool found = false;
+
+	if (snapshotRecover(&data_snapshot, &found) != SD_OK || !found)
+	{
+		memset(&data, 0, sizeof(data));
+	}
+	sdlogPosition(&sd_log, &head_seq, &head_count);
+
+	seq = found ? data.log_seq : head_seq + 1;
+	first = data.log_count;
+	if ((int32_t)(head_seq - seq) >= SD_LOG_NUM_BLOCKS)
+	{
+		seq = head_seq - SD_LOG_NUM_BLOCKS + 1; // los bloques más viejos ya se sobrescribieron
+		first = 0;
+	}
+
+	while ((int32_t)(head_seq - seq) >= 0 && sdlogRead(&sd_log, seq, first, batch, SD_REPLAY_BATCH, &n) == SD_OK)
+	{
+		for (uint16_t i = 0; i < n; i++)
+		{
+			accumulate(&batch[i]);
+		}
+		replayed += n;
+		first += n;
+		if (n < SD_REPLAY_BATCH)
+		{
+			seq++;
+			first = 0;
+		}
+	}
+	data.log_seq = head_seq;
+	data.log_count = head_count;
+
+	snprintf(to_print, sizeof(to_print), "SDCard | Acumulado: %lu muestras, %lu repuestas del log\n\r",
+			(unsigned long)data.stats_T.count, (unsigned long)replayed);
+	uartSendString((uint8_t*)to_print);
+}
+
+/**
+  * @brief  Imprime por UART una medición convertida en punto fijo (sin float)
+  * @param	label: prefijo de la línea
+  * @param	rawTemp: temperatura cruda
+  * @param	rawHum: humedad cruda
+  */
+static void printMeasurement(const char *label, uint16_t rawTemp, uint16_t rawHum)
+{
+	int16_t temp = SHT30_rawToCentiCelsius(rawTemp);
+	uint16_t abs_temp = (temp < 0) ? -temp : temp;
+
+	snprintf(to_print, sizeof(to_print), "%sTemp = %s%u,%u °C   Hum = %u %%\n\r", label, (temp < 0) ? "-" : "",
+			abs_temp / 100, (abs_temp / 10) % 10, SHT30_rawToCentiPercent(rawHum) / 100);
+	uartSendString((uint8_t*)to_print);
+}
+
+/**
+  * @brief  Escribe un valor en centésimas como texto con dos decimales
+  * @param	dst: destino
+  * @param	len: tamaño del destino
+  * @param	centi: valor en centésimas
+  */
+static void formatCenti(char *dst, size_t len, int32_t centi)
+{
+	uint32_t abs_centi = (centi < 0) ? -centi : centi;
+
+	snprintf(dst, len, "%s%lu,%02lu", (centi < 0) ? "-" : "", (unsigned long)(abs_centi / 100), (unsigned long)(abs_centi % 100));
+}
+
+/**
+  * @brief  Imprime por UART desvío, mínimo y máximo de un canal con el tiempo de cada extremo
+  * @param	s: estadística en ticks crudos
+  * @param	isTemp: true para temperatura, false para humedad
+  */
+static void printStats(const stats_t *s, bool isTemp)
+{
+	const char *unit = isTemp ? "°C" : "%";
+	float span = isTemp ? 17500.0f : 10000.0f; // rango de la escala en centésimas
+	char dev[16], min[16], max[16];
+
+	if (s->count == 0) return;
+
+	// el desvío escala con la pendiente de la conversión, span / 65535 por tick
+	formatCenti(dev, sizeof(dev), (int32_t)(sqrtf((float)statsVariance(s)) * span / 65535.0f + 0.5f));
+	formatCenti(min, sizeof(min), isTemp ? SHT30_rawToCentiCelsius(s->min) : SHT30_rawToCentiPercent(s->min));
+	formatCenti(max, sizeof(max), isTemp ? SHT30_rawToCentiCelsius(s->max) : SHT30_rawToCentiPercent(s->max));
+
+	snprintf(to_print, sizeof(to_print), "SHT30 | %s: desvío %s %s, mín %s %s (t=%lu s), máx %s %s (t=%lu s)\n\r",
+			isTemp ? "Temperatura" : "Humedad", dev, unit, min, unit, (unsigned long)s->min_time,
+			max, unit, (unsigned long)s->max_time);
+	uartSendString((uint8_t*)to_print);
+}
+
+/**
+  * @brief  Imprime por UART los percentiles estimados de un canal desde el último reset
+  * @param	q: estimador en ticks crudos
+  * @param	isTemp: true para temperatura, false para humedad
+  */
+static void printPercentiles(const quantile_t *q, bool isTemp)
+{
+	char value[QUANTILE_COUNT][16];
+
+	if (q->count == 0) return;
+
+	for (uint8_t i = 0; i < QUANTILE_COUNT; i++)
+	{
+		uint16_t raw = (uint16_t)(quantileGet(q, i) + 0.5f);
+		formatCenti(value[i], sizeof(value[i]), isTemp ? SHT30_rawToCentiCelsius(raw) : SHT30_rawToCentiPercent(raw));
+	}
+
+	snprintf(to_print, sizeof(to_print), "SHT30 | %s: p5 %s, p50 %s, p95 %s %s\n\r", isTemp ? "Temperatura" : "Humedad",
+			value[0], value[1], value[2], isTemp ? "°C" : "%");
+	uartSendString((uint8_t*)to_print);
+}
+
+/**
+  * @brief  Imprime por UART promedio y extremos de una ventana que termina ahora, desde el resumen en la SD
+  * @param	label: nombre de la ventana
+  * @param	window: duración de la ventana en segundos
+  */
+static void printWindow(const char *label, uint32_t window)
+{
+	rrdBucket_t w;
+	uint32_t step;
+	char temp[16], min_t[16], max_t[16], hum[16];
+
+	if (rrdQuery(&rollup, time_base + HAL_GetTick()/1000, window, &w, &step) != SD_OK || w.count == 0) return;
+
+	formatCenti(temp, sizeof(temp), SHT30_sumToCentiCelsius(w.sum_T, w.count));
+	formatCenti(min_t, sizeof(min_t), SHT30_rawToCentiCelsius(w.min_T));
+	formatCenti(max_t, sizeof(max_t), SHT30_rawToCentiCelsius(w.max_T));
+	formatCenti(hum, sizeof(hum), SHT30_sumToCentiPercent(w.sum_H, w.count));
+
+	snprintf(to_print, sizeof(to_print), "SHT30 | %s (%lu muestras, de a %lu s): T %s °C [%s a %s], HR %s %%\n\r",
+			label, (unsigned long)w.count, (unsigned long)step, temp, min_t, max_t, hum);
+	uartSendString((uint8_t*)to_print);
+}
+
+/**
+  * @brief  Informa por UART y registra una muestra
+  * @note	Mientras la SD no está lista las muestras se retienen en RAM y se registran al recuperar el log.
+  * @param	rawTemp: temperatura cruda
+  * @param	rawHum: humedad cruda
+  */
+static void recordSample(uint16_t rawTemp, uint16_t rawHum)
+{
+	ledStart(LED_BLINK_ONCE);
+
+	printMeasurement("SHT30 | Leido:   ", rawTemp, rawHum);
+
+	logSample_t sample = { HAL_GetTick()/1000, SHT30_rawToTemperature(rawTemp), SHT30_rawToHumidity(rawHum), rawTemp, rawHum };
+
+	if (sd_ready)
+	{
+		storeSample(&sample);
+	}
+	else if (pending_count < SD_PENDING_SIZE)
+	{
+		pending[pending_count++] = sample;
+	}
+	else
+	{
+		uartSendString((uint8_t*)"SDCard | ERROR: Buffer lleno, se descarta la muestra\n\r");
+	}
+}
+
+/**
+  * @brief  Inicia una ronda de mediciones en todos los sensores (no bloqueante)
+  * @note	Los resultados se recogen en sampleUpdate; mientras los sensores miden el superloop sigue
+  * 		corriendo. En modo periódico solo se pide la última medición de cada sensor (fetch).
+  */
+static void startSample(void)
+{
+	sht30_err_t err = SHT30_schedStart(&sensor_sched);
+	if (err != SHT30_OK && err != SHT30_BUSY && !SHT30_PERIODIC)
+	{
+		uartSendString((uint8_t*)"SHT30 | ERROR: Fallo inicio de medicion\n\r");
+	}
+}
+
+/**
+  * @brief  Recoge la ronda de mediciones al terminar
+  * @note	Cada medición válida se acumula en el filtro decimador de su sensor. En single shot se
+  * 		registra enseguida; en modo periódico un fetch fallido (sensor sin medición nueva, NACK
+  * 		o CRC) solo resta una muestra al promedio del período.
+  */
+static void sampleUpdate(void)
+{
+	if (SHT30_schedProcess(&sensor_sched) != SHT30_OK) return;
+
+	for (uint8_t i = 0; i < SHT30_schedCount(&sensor_sched); i++)
+	{
+		const sht30_slot_t *slot = SHT30_schedResult(&sensor_sched, i);
+		if (slot->err == SHT30_OK)
+		{
+			decimatorPush(&sample_filter[i], slot->raw);
+		}
+		else if (!SHT30_PERIODIC || SHT30_ALERT_MODE)
+		{
+			snprintf(to_print, sizeof(to_print), "SHT30 0x%02X | ERROR: Fallo lectura, se descarta la muestra\n\r", slot->dev->addr);
+			uartSendString((uint8_t*)to_print);
+		}
+	}
+
+	if (SHT30_ALERT_MODE)
+	{
+		emitSample();
+		alertRearm();
+	}
+	else if (!SHT30_PERIODIC)
+	{
+		emitSample();
+	}
+}
+
+/**
+  * @brief  Centra la banda de alerta de cada sensor en la medición recién leída
+  * @note	Un sensor que falló la lectura conserva la banda anterior: si sigue fuera de ella el
+  * 		pin ALERT queda en alto y alertUpdate lo vuelve a leer en el próximo período.
+  */
+static void alertRearm(void)
+{
+	for (uint8_t i = 0; i < SHT30_schedCount(&sensor_sched); i++)
+	{
+		const sht30_slot_t *slot = SHT30_schedResult(&sensor_sched, i);
+		if (slot->err != SHT30_OK) continue;
+
+		if (SHT30_setAlertBand(slot->dev, slot->raw[0], slot->raw[1], SHT30_ALERT_BAND_TEMP, SHT30_ALERT_BAND_HUM) != SHT30_OK)
+		{
+			snprintf(to_print, sizeof(to_print), "SHT30 0x%02X | ERROR: Fallo configuracion de alerta\n\r", slot->dev->addr);
+			uartSendString((uint8_t*)to_print);
+		}
+	}
+}
+
+/**
+  * @brief  Modo por cambios: inicia una ronda cuando T o HR salieron de la banda
+  * @note	El flanco del pin ALERT (EXTI) marca alert_flag. Si el pin sigue en alto después de
+  * 		centrar la banda (la medición ya estaba fuera de la nueva) se vuelve a leer en la
+  * 		próxima medición del sensor. Sin alertas se registra una muestra cada SHT30_ALERT_HEARTBEAT.
+  */
+static void alertUpdate(void)
+{
+	if (delayRead(&delay_measure))
+	{
+		heartbeat_due = true;
+	}
+
+	bool pin = (HAL_GPIO_ReadPin(SHT30_ALERT_GPIO_Port, SHT30_ALERT_Pin) == GPIO_PIN_SET);
+	if (!alert_flag && !pin && !heartbeat_due) return;
+	if ((HAL_GetTick() - alert_round_tick) < SHT30_ALERT_PERIOD) return; // a lo sumo una ronda por medición
+
+	if (alert_flag || pin)
+	{
+		alert_count++;
+	}
+	else
+	{
+		heartbeat_count++;
+	}
+	alert_flag = false;
+	heartbeat_due = false;
+	alert_round_tick = HAL_GetTick();
+	startSample();
+}
+
+/**
+  * @brief  Inicia el modo periódico en todos los sensores
+  * @retval true si todos quedaron midiendo
+  */
+static bool startPeriodic(void)
+{
+	bool ok = true;
+
+	for (uint8_t i = 0; i < SHT30_schedCount(&sensor_sched); i++)
+	{
+		sht30_t *dev = SHT30_schedResult(&sensor_sched, i)->dev;
+		sht30_err_t err;
+		if (SHT30_ALERT_MODE) err = SHT30_startPeriodicRead(dev, SHT30_REPEATABILITY, SHT30_ALERT_MPS);
+		else if (SHT30_USE_ART) err = SHT30_startART(dev);
+		else err = SHT30_startPeriodicRead(dev, SHT30_REPEATABILITY, SHT30_PERIODIC_MPS);
+		if (err != SHT30_OK)
+		{
+			snprintf(to_print, sizeof(to_print), "SHT30 0x%02X | ERROR: Fallo inicio de modo periodico\n\r", dev->addr);
+			uartSendString((uint8_t*)to_print);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+/**
+  * @brief  Registra el promedio de las mediciones del período
+  * @note	Con varios sensores informa cada uno y registra el promedio de los que midieron. En modo
+  * 		periódico, si en todo el período no se leyó ninguna medición (el sensor se reinició y
+  * 		volvió a single shot, por ejemplo) se vuelve a iniciar el modo periódico.
+  */
+static void emitSample(void)
+{
+	uint16_t raw[DECIMATOR_VALUES];
+	uint32_t sum[DECIMATOR_VALUES] = { 0 };
+	uint8_t valid = 0;
+	uint8_t count = SHT30_schedCount(&sensor_sched);
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		if (!decimatorRead(&sample_filter[i], raw, NULL)) continue;
+
+		if (count > 1)
+		{
+			char label[16];
+			snprintf(label, sizeof(label), "SHT30 0x%02X | ", SHT30_schedResult(&sensor_sched, i)->dev->addr);
+			printMeasurement(label, raw[0], raw[1]);
+		}
+		for (int v = 0; v < DECIMATOR_VALUES; v++)
+		{
+			sum[v] += raw[v];
+		}
+		valid++;
+	}
+
+	if (valid == 0)
+	{
+		if (SHT30_PERIODIC || SHT30_ALERT_MODE)
+		{
+			uartSendString((uint8_t*)"SHT30 | ERROR: Sin mediciones en el periodo\n\r");
+			startPeriodic();
+		}
+		return;
+	}
+
+	for (int v = 0; v < DECIMATOR_VALUES; v++)
+	{
+		raw[v] = (uint16_t)((sum[v] + valid / 2) / valid);
+	}
+	recordSample(raw[0], raw[1]);
+}
+
+/**
+  * @brief  Inicializa los sensores de sensor_cfg y los agrega a las rondas de medición
+  * @note	Si ninguno responde se agregan todos igual, para seguir intentando medir.
+  */
+static void sensorsInit(void)
+{
+	bool alive[SHT30_NUM_SENSORS];
+	uint8_t alive_count = 0;
+
+	SHT30_schedInit(&sensor_sched);
+	for (uint8_t i = 0; i < SHT30_NUM_SENSORS; i++)
+	{
+		alive[i] = (SHT30_init(&sensors[i], sensor_cfg[i].bus, sensor_cfg[i].addr, SHT30_CLOCK_STREACHING, SHT30_REPEATABILITY) == SHT30_OK);
+		if (alive[i])
+		{
+			alive_count++;
+		}
+		else
+		{
+			snprintf(to_print, sizeof(to_print), "SHT30 0x%02X | ERROR: No responde\n\r", sensor_cfg[i].addr);
+			uartSendString((uint8_t*)to_print);
+		}
+	}
+
+	for (uint8_t i = 0; i < SHT30_NUM_SENSORS; i++)
+	{
+		if (alive[i] || alive_count == 0)
+		{
+			SHT30_schedAdd(&sensor_sched, &sensors[i]);
+			decimatorInit(&sample_filter[SHT30_schedCount(&sensor_sched) - 1]);
+		}
+	}
+}
+
+/**
+  * @brief  Avanza la inicialización de la SD en segundo plano y, al terminar, recupera el log
+  * @note	Si la inicialización falla se reintenta cada DELAY_SD_RETRY ms.
+  */
+static void sdBootUpdate(void)
+{
+	sd_err_t err = SD_initProcess();
+	if (err == SD_BUSY) return;
+
+	if (err != SD_OK)
+	{
+		if (!delayIsRunning(&delay_sd_retry))
+		{
+			uartSendString((uint8_t*)"SDCard | ERROR: Fallo inicio de SDCard driver!\n\r");
+			delayRead(&delay_sd_retry);
+		}
+		else if (delayRead(&delay_sd_retry))
+		{
+			SD_initStart();
+		}
+		return;
+	}
+
+	printBootTime("SDCard lista");
+
+	const sd_card_info_t *info = SD_getCardInfo();
+	snprintf(to_print, sizeof(to_print), "SDCard | %s %lu MB, SPI %lu kHz (max %lu kHz)\n\r",
+			info->type == SD_TYPE_SDHC ? "SDHC/SDXC" : "SDSC", (unsigned long)(info->blocks / 2048),
+			(unsigned long)(info->clock_hz / 1000), (unsigned long)(info->max_clock_hz / 1000));
+	uartSendString((uint8_t*)to_print);
+
+	if (sdlogRecover(&sd_log, &block_data) == SD_OK)
+	{
+		uartSendString((uint8_t*)"SDCard | Lectura OK!\n\r");
+	}
+	time_base = sdlogLastTime(&sd_log) + DELAY_MEASURE/1000; // el tiempo sigue desde el último registro
+
+	if (reset_requested)
+	{
+		resetData();
+		reset_requested = false;
+	}
+	else
+	{
+		recoverData();
+	}
+
+	for (uint16_t i = 0; i < pending_count; i++)
+	{
+		storeSample(&pending[i]);
+	}
+	pending_count = 0;
+
+	sd_ready = true;
+	printBootTime("Log recuperado");
+}
+
 /**
   * @brief  main FSM init
+  * @note	La SD se inicializa en segundo plano desde mainFSM_update, por lo que la UART, el LED,
+  * 		el botón y la primera medición están disponibles sin esperar a la tarjeta.
   */
 void mainFSM_init()
 {
 	ledInit(LD2_GPIO_Port, LD2_Pin, LED_ON_TIME, LED_OFF_LONG_TIME, LED_OFF_SHORT_TIME, LED_CANT_BLINK);
 	uartInit();
 	debounceFSM_init(B1_GPIO_Port, B1_Pin);
+	printBootTime("UART, LED y boton listos");
 	uartSendString((uint8_t*)"SHT30 | Iniciando SHT30 driver...\n\r");
 
-	SHT30_init(SHT30_CLOCK_STREACHING, SHT30_REPEATABILITY_HIGH);
+	sensorsInit();
+	if (SHT30_PERIODIC || SHT30_ALERT_MODE)
+	{
+		delayInit(&delay_fetch, SHT30_FETCH_PERIOD);
+		startPeriodic();
+	}
 	uartSendString((uint8_t*)"SHT30 | Iniciado\n\r");
 
 	uartSendString((uint8_t*)"SDCard | Iniciando SDCard driver...\n\r");
-	if (SD_init() != SD_OK)
+	sdlogInit(&sd_log, SD_LOG_FIRST_BLOCK, SD_LOG_NUM_BLOCKS, sizeof(Block_data), SD_LOG_MAX_LATENCY);
+	sdlogSetEncoding(&sd_log, SD_LOG_ENCODING);
+	snapshotInit(&data_snapshot, SD_STATE_FIRST_BLOCK, &data, sizeof(data), SD_STATE_MAX_LATENCY);
+	rrdInit(&rollup, SD_RRD_FIRST_BLOCK, rrd_tiers, sizeof(rrd_tiers) / sizeof(rrd_tiers[0]), SD_RRD_MAX_LATENCY);
+	delayInit(&delay_sd_retry, DELAY_SD_RETRY);
+	SD_initStart();
+
+	delayInit(&delay_measure, SHT30_ALERT_MODE ? SHT30_ALERT_HEARTBEAT : DELAY_MEASURE);
+	delayRead(&delay_measure);
+	if (SHT30_ALERT_MODE)
 	{
-		uartSendString((uint8_t*)"SDCard | ERROR: Fallo inicio de SDCard driver!\n\r");
+		heartbeat_due = true; // la primera ronda, al terminar la primera medición, fija la banda
+		alert_round_tick = HAL_GetTick();
 	}
-
-	if (SD_read(SD_SAVE_DIRECTION, sd_rwbuffer) == SD_OK)
+	else if (SHT30_PERIODIC)
 	{
-		memcpy(&data, sd_rwbuffer, sizeof(Temp_data));
-		uartSendString((uint8_t*)"SDCard | Lectura OK!\n\r");
+		delayRead(&delay_fetch);
 	}
-
-	delayInit(&delay_measure, DELAY_MEASURE);
-	delayRead(&delay_measure);
+	else
+	{
+		startSample();
+	}
+	printBootTime("Primera medicion iniciada");
 	current_state = IDLE;
 }
 
@@ -125,26 +742,59 @@ void mainFSM_init()
   */
 void mainFSM_update(keyState_t button)
 {
-	static float lastTemp, lastHum;
-	switch(current_state)
+	if(!sd_ready)
 	{
-		case IDLE:
+		sdBootUpdate();
+	}
+	else
+	{
+		sd_err_t sd_err = sdlogProcess(&sd_log);
+		if(sd_err == SD_OK)
+		{
+			sd_err = rrdProcess(&rollup);
+		}
+		if(sd_err == SD_OK && snapshotDue(&data_snapshot))
 		{
-			if(delayRead(&delay_measure))
+			sd_err = sdlogFlush(&sd_log); // las muestras que cubre el acumulado llegan antes al log
+			if(sd_err == SD_OK)
 			{
-				ledStart(LED_BLINK_ONCE);
-				SHT30_readTemperatureAndHumidity(&lastTemp, &lastHum);
-				sprintf(to_print, "SHT30 | Leido:   Temp = %d,%d °C   Hum = %d %%\n\r", (int)lastTemp, (int)((lastTemp - (int)lastTemp) * 10) % 10, (int)lastHum);
-				uartSendString((uint8_t*)to_print);
-
-				data.sum_T+=lastTemp;
-				data.sum_H+=lastHum;
-				data.cont++;
+				sd_err = snapshotWrite(&data_snapshot);
+			}
+		}
+		if(sd_err == SD_OK)
+		{
+			sd_err = SD_cacheProcess();
+		}
+		if(sd_err != SD_OK && sd_err != SD_BUSY)
+		{
+			uartSendString((uint8_t*)"SDCard | ERROR: Fallo escritura de SDCard!\n\r");
+		}
+	}
 
+	sampleUpdate();
 
-				memset(sd_rwbuffer, 0xFF, sizeof(sd_rwbuffer));
-				memcpy(sd_rwbuffer, &data, sizeof(Temp_data));
-				SD_write(SD_SAVE_DIRECTION, sd_rwbuffer);
+	switch(current_state)
+	{
+		case IDLE:
+		{
+			if(SHT30_ALERT_MODE)
+			{
+				alertUpdate();
+			}
+			else if(SHT30_PERIODIC)
+			{
+				if(delayRead(&delay_fetch))
+				{
+					startSample();
+				}
+				if(delayRead(&delay_measure))
+				{
+					emitSample();
+				}
+			}
+			else if(delayRead(&delay_measure))
+			{
+				startSample();
 			}
 
 			switch(button)
@@ -159,13 +809,37 @@ void mainFSM_update(keyState_t button)
 
 		case SHOW_DATA:
 		{
-			float promTemp = data.sum_T/data.cont;
-			float promHum = data.sum_H/data.cont;
+			int16_t promTemp = SHT30_sumToCentiCelsius(data.sum_T, data.stats_T.count);
+			uint16_t promHum = SHT30_sumToCentiPercent(data.sum_H, data.stats_T.count);
+			uint16_t absTemp = (promTemp < 0) ? -promTemp : promTemp;
 			uartSendString((uint8_t*)"=============================\n\r");
-			sprintf(to_print, "SHT30 | Valor promedio (%d muestras):\n\r",data.cont);
+			snprintf(to_print, sizeof(to_print), "SHT30 | Valor promedio (%lu muestras):\n\r", (unsigned long)data.stats_T.count);
 			uartSendString((uint8_t*)to_print);
-			sprintf(to_print, "SHT30 | Temperatura = %d,%d °C\n\rSHT30 | Humedad = %d %%\n\r", (int)promTemp, (int)((promTemp - (int)promTemp) * 10) % 10, (int)promHum);
+			snprintf(to_print, sizeof(to_print), "SHT30 | Temperatura = %s%u,%02u °C\n\rSHT30 | Humedad = %u,%02u %%\n\r",
+					(promTemp < 0) ? "-" : "", absTemp / 100, absTemp % 100, promHum / 100, promHum % 100);
 			uartSendString((uint8_t*)to_print);
+			printStats(&data.stats_T, true);
+			printStats(&data.stats_H, false);
+			printPercentiles(&data.quant_T, true);
+			printPercentiles(&data.quant_H, false);
+			if(sd_ready)
+			{
+				printWindow("Ultima hora", 3600);
+				printWindow("Ultimo dia", 86400);
+				printWindow("Ultima semana", 7 * 86400);
+			}
+			printSDLatency("Lectura", SD_OP_READ);
+			printSDLatency("Escritura", SD_OP_WRITE);
+			printSDCache();
+			snprintf(to_print, sizeof(to_print), "SHT30 | Ronda: %u sensores en %lu ms\n\r",
+					SHT30_schedCount(&sensor_sched), (unsigned long)sensor_sched.round_ms);
+			uartSendString((uint8_t*)to_print);
+			if(SHT30_ALERT_MODE)
+			{
+				snprintf(to_print, sizeof(to_print), "SHT30 | Rondas por alerta: %lu, sin cambios: %lu\n\r",
+						(unsigned long)alert_count, (unsigned long)heartbeat_count);
+				uartSendString((uint8_t*)to_print);
+			}
 			uartSendString((uint8_t*)"=============================\n\r");
 			setMainState(IDLE);
 			break;
@@ -175,11 +849,18 @@ void mainFSM_update(keyState_t button)
 		{
 			uartSendString((uint8_t*)"DATA RESET\n\r");
 
-			data.sum_T = 0;
-			data.sum_H = 0;
-			data.cont = 0;
-
-			SD_erase(SD_SAVE_DIRECTION);
+			if(sd_ready)
+			{
+				resetData();
+				SD_flush();
+			}
+			else
+			{
+				memset(&data, 0, sizeof(data));
+				memset(&block_data, 0, sizeof(block_data));
+				reset_requested = true; // se aplica al recuperar el log
+				pending_count = 0;
+			}
 
 			delayRead(&delay_measure); // reset delay
 			setMainState(IDLE);
@@ -218,11 +899,11 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_I2C1_Init();
   MX_SPI2_Init();
   /* USER CODE BEGIN 2 */
   HAL_GPIO_WritePin(SPI2_CS_GPIO_Port, SPI2_CS_Pin, GPIO_PIN_SET);
-  HAL_Delay(5000);
 
   mainFSM_init();
   /* USER CODE END 2 */
@@ -234,6 +915,10 @@ int main(void)
 	  ledFSM_update();
 	  debounceFSM_update();
 	  mainFSM_update(readKey());
+	  if (SHT30_ALERT_MODE)
+	  {
+		  HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI); // hasta el SysTick, el pin ALERT, I2C o DMA
+	  }
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -345,7 +1030,7 @@ static void MX_SPI2_Init(void)
   hspi2.Init.CLKPolarity = SPI_POLARITY_LOW;
   hspi2.Init.CLKPhase = SPI_PHASE_1EDGE;
   hspi2.Init.NSS = SPI_NSS_SOFT;
-  hspi2.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_64;
+  hspi2.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_128;
   hspi2.Init.FirstBit = SPI_FIRSTBIT_MSB;
   hspi2.Init.TIMode = SPI_TIMODE_DISABLE;
   hspi2.Init.CRCCalculation = SPI_CRCCALCULATION_DISABLE;
@@ -360,6 +1045,25 @@ static void MX_SPI2_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream3_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream3_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+  /* DMA1_Stream4_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream4_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -404,12 +1108,34 @@ static void MX_GPIO_Init(void)
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(SPI2_CS_GPIO_Port, &GPIO_InitStruct);
 
+  /*Configure GPIO pin : SHT30_ALERT_Pin */
+  GPIO_InitStruct.Pin = SHT30_ALERT_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+  GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+  HAL_GPIO_Init(SHT30_ALERT_GPIO_Port, &GPIO_InitStruct);
+
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI9_5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+
   /* USER CODE BEGIN MX_GPIO_Init_2 */
 
   /* USER CODE END MX_GPIO_Init_2 */
 }
 
 /* USER CODE BEGIN 4 */
+/**
+  * @brief  Callback de la HAL: flanco en una línea EXTI
+  * @note	El pin ALERT de los SHT30 sube cuando T o HR salen de la banda; la ronda de lectura se
+  * 		inicia desde el superloop (alertUpdate).
+  */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+	if (GPIO_Pin == SHT30_ALERT_Pin)
+	{
+		alert_flag = true;
+	}
+}
 
 /* USER CODE END 4 */
 
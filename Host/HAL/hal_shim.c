@@ -0,0 +1,747 @@
+/*
+ *	@file hal_shim.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title HAL simulada para el host
+ *  @brief Implementación de las funciones de la HAL que usa el firmware sobre el reloj virtual
+ *
+ *  - HAL_GetTick()/HAL_Delay() y el contador DWT se derivan de vclock.
+ *  - GPIO: PB12 es el CS de la SD (sd_sim), PA5 el LED LD2 y PC13 el botón B1 (pulsaciones programadas).
+ *    Un modelo puede manejar una entrada (halshim_gpio_input); si el pin está configurado como
+ *    GPIO_MODE_IT_RISING y su línea EXTI habilitada en el NVIC, el flanco llama a HAL_GPIO_EXTI_Callback.
+ *  - UART: lo que transmite el firmware se escribe en stdout.
+ *  - SPI: cada byte avanza el reloj según el prescaler configurado y pasa por sd_sim; el DMA se
+ *    completa en la misma llamada e invoca los callbacks del port.
+ *  - I2C: los bytes se entregan al dispositivo registrado en la dirección (halshim_i2c_attach). Las
+ *    transferencias por interrupciones invocan el callback de la HAL cuando el reloj virtual pasa
+ *    el fin de la transferencia (se entregan desde HAL_GetTick/HAL_Delay, como una IRQ). Un esclavo
+ *    puede colgar el bus reteniendo SDA: el periférico queda BUSY hasta un reset (RCC) y SDA se
+ *    libera con pulsos de SCL por GPIO (PB8/PB9).
+ *
+ *  Los modelos programan sus eventos propios (mediciones periódicas, por ejemplo) con halshim_timer:
+ *  se ejecutan desde HAL_GetTick/HAL_Delay como una IRQ y el reloj no los saltea. HAL_PWR_EnterSLEEPMode
+ *  (WFI) duerme hasta el próximo tick (a lo sumo un quantum) o el próximo evento.
+ *
+ *  Superloop ocioso: cuando el firmware consulta el tick varias veces seguidas sin usar ningún
+ *  periférico, no puede pasar nada hasta el próximo milisegundo, así que el reloj salta hasta el
+ *  próximo múltiplo del quantum. Con quantum > 1 ms los vencimientos se demoran hasta ese valor a
+ *  cambio de simular más rápido.
+ */
+
+#include "stm32f4xx_hal.h"
+#include "hal_shim.h"
+#include "sd_sim.h"
+#include "vclock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HSI_HZ				16000000U
+#define TICK_CALL_NS		1000		// costo virtual de una vuelta de polling sobre HAL_GetTick()
+#define DWT_CALL_NS			100
+#define IDLE_CALLS			16			// consultas seguidas del tick sin actividad antes de saltar
+#define NS_PER_MS			1000000ULL
+#define I2C_BUSY_WAIT_MS	25			// espera de la HAL por el flag BUSY antes de devolver HAL_BUSY
+
+typedef struct
+{
+	uint64_t start_ns;
+	uint64_t end_ns;
+} press_t;
+
+typedef struct
+{
+	bool armed;
+	uint64_t at_ns;
+	void (*fn)(void *ctx);
+	void *ctx;
+} shim_timer_t;
+
+uint32_t SystemCoreClock = HSI_HZ;
+GPIO_TypeDef halshim_gpio[4];
+CoreDebug_Type halshim_coredebug;
+int halshim_usart2, halshim_spi2, halshim_i2c1;
+
+static halshim_stats_t stats;
+
+static uint32_t pclk1_hz = HSI_HZ;
+static RCC_PLLInitTypeDef pll;
+
+static uint64_t quantum_ns = NS_PER_MS;
+static uint64_t end_ns;
+static uint32_t idle_calls;
+
+static press_t presses[HALSHIM_MAX_PRESSES];
+static uint16_t num_presses;
+
+static shim_timer_t timers[HALSHIM_MAX_TIMERS];
+static uint8_t num_timers;
+
+static uint32_t gpio_inputs[4];		// pines manejados por un modelo (se leen de IDR), por puerto
+static uint32_t gpio_it_rising[4];	// pines configurados con GPIO_MODE_IT_RISING, por puerto
+static uint64_t nvic_enabled;		// bit por IRQn
+
+static bool uart_quiet, uart_timestamps, uart_line_start = true;
+static uint32_t uart_baud = 115200;
+
+static uint64_t spi_byte_ns = 8ULL * 256 * 1000000000ULL / HSI_HZ;
+
+static halshim_i2c_dev_t i2c_devs[HALSHIM_MAX_I2C_DEVS];
+static uint8_t num_i2c_devs;
+static uint32_t i2c_hz = 100000;
+
+static bool i2c_irq_pending;		// transferencia por interrupciones en curso
+static uint64_t i2c_irq_ns;			// fin de la transferencia
+static I2C_HandleTypeDef *i2c_irq_handle;
+static bool i2c_irq_rx;
+static bool i2c_stall_request;		// el dispositivo pidió colgar el bus en esta transferencia
+static bool i2c_periph_busy;		// flag BUSY del periférico trabado
+static uint8_t i2c_sda_held;		// pulsos de SCL que faltan para que el esclavo suelte SDA
+
+static DWT_Type dwt;
+static uint64_t dwt_last_cycles;
+
+static void activity(void);
+static void check_end(void);
+static uint64_t next_event_ns(uint64_t now);
+static void spi_xfer(const uint8_t *tx, uint8_t *rx, uint16_t size);
+static void irq_deliver(void);
+static bool exti_enabled(uint16_t GPIO_Pin);
+static const halshim_i2c_dev_t *i2c_find(uint16_t addr8);
+static HAL_StatusTypeDef i2c_xfer(uint16_t addr8, uint8_t *data, uint16_t size, bool rx);
+
+
+/* ====================  Control desde el host  ========================= */
+
+/**
+  * @brief  Configura el quantum del salto de reloj en superloop ocioso (1 ms por defecto).
+  */
+void halshim_set_quantum_ms(uint32_t ms)
+{
+	quantum_ns = (ms ? ms : 1) * NS_PER_MS;
+}
+
+/**
+  * @brief  Termina la simulación (exit(0)) al llegar a ese tiempo virtual. 0 para no terminar.
+  */
+void halshim_set_run_time_ms(uint64_t ms)
+{
+	end_ns = ms * NS_PER_MS;
+}
+
+/**
+  * @brief  Programa una pulsación de B1.
+  * @param  at_ms: Instante de la pulsación (tiempo virtual desde el arranque).
+  * @param  duration_ms: Tiempo que se mantiene presionado.
+  * @retval false si no hay lugar para más pulsaciones.
+  */
+bool halshim_button_press(uint64_t at_ms, uint32_t duration_ms)
+{
+	if (num_presses >= HALSHIM_MAX_PRESSES) return false;
+
+	presses[num_presses].start_ns = at_ms * NS_PER_MS;
+	presses[num_presses].end_ns = (at_ms + duration_ms) * NS_PER_MS;
+	num_presses++;
+	return true;
+}
+
+/**
+  * @brief  Salida de la UART: quiet la descarta; timestamps antepone el tiempo virtual a cada línea.
+  */
+void halshim_uart_config(bool quiet, bool timestamps)
+{
+	uart_quiet = quiet;
+	uart_timestamps = timestamps;
+}
+
+/**
+  * @brief  Conecta un dispositivo al bus I2C1.
+  * @retval false si no hay lugar para más dispositivos o la dirección ya está ocupada.
+  */
+bool halshim_i2c_attach(const halshim_i2c_dev_t *dev)
+{
+	if (num_i2c_devs >= HALSHIM_MAX_I2C_DEVS || i2c_find(dev->addr << 1) != NULL) return false;
+	i2c_devs[num_i2c_devs++] = *dev;
+	return true;
+}
+
+/**
+  * @brief  Llamada por un dispositivo dentro de write()/read(): la transferencia no termina y el
+  * 		esclavo retiene SDA hasta recibir clocks pulsos de SCL.
+  */
+void halshim_i2c_stall(uint8_t clocks)
+{
+	i2c_stall_request = true;
+	i2c_sda_held = clocks ? clocks : 1;
+}
+
+/**
+  * @brief  Un modelo fija el nivel de una entrada. El flanco ascendente genera la interrupción EXTI
+  * 		si el firmware configuró el pin y habilitó su línea.
+  * @note   Llamar desde un timer (halshim_timer) o desde write()/read() de un dispositivo I2C.
+  */
+void halshim_gpio_input(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, bool level)
+{
+	size_t port = GPIOx - halshim_gpio;
+	bool was_set = GPIOx->IDR & GPIO_Pin;
+
+	gpio_inputs[port] |= GPIO_Pin;
+	if (level) GPIOx->IDR |= GPIO_Pin;
+	else GPIOx->IDR &= ~(uint32_t)GPIO_Pin;
+
+	if (level && !was_set && (gpio_it_rising[port] & GPIO_Pin) && exti_enabled(GPIO_Pin))
+	{
+		stats.exti_events++;
+		activity();
+		HAL_GPIO_EXTI_Callback(GPIO_Pin);
+	}
+}
+
+/**
+  * @brief  Programa (o reprograma) la llamada fn(ctx) en el instante at_ns del reloj virtual.
+  * @note   Un timer por par fn/ctx; se ejecuta una vez y fn puede volver a programarlo.
+  * @retval false si no hay lugar para más timers.
+  */
+bool halshim_timer(uint64_t at_ns, void (*fn)(void *ctx), void *ctx)
+{
+	shim_timer_t *t = NULL;
+
+	for (uint8_t i = 0; i < num_timers && t == NULL; i++)
+	{
+		if (timers[i].fn == fn && timers[i].ctx == ctx) t = &timers[i];
+	}
+	if (t == NULL)
+	{
+		if (num_timers >= HALSHIM_MAX_TIMERS) return false;
+		t = &timers[num_timers++];
+		t->fn = fn;
+		t->ctx = ctx;
+	}
+	t->at_ns = at_ns;
+	t->armed = true;
+	return true;
+}
+
+/**
+  * @brief  Reset del periférico I2C1 por RCC (__HAL_RCC_I2C1_FORCE_RESET): limpia el flag BUSY.
+  */
+void halshim_i2c_reset(void)
+{
+	i2c_periph_busy = false;
+	i2c_irq_pending = false;
+	stats.i2c_resets++;
+}
+
+const halshim_stats_t *halshim_get_stats(void)
+{
+	return &stats;
+}
+
+/**
+  * @brief  Error fatal del firmware (Error_Handler): en la placa queda colgado, acá termina el proceso.
+  */
+void halshim_fatal(const char *reason)
+{
+	fflush(stdout);
+	fprintf(stderr, "hal_shim: %s a los %.3f s\n", reason, vclock_now_ns() / 1e9);
+	exit(1);
+}
+
+/* ====================  Núcleo y reloj  ================================ */
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+	pll = RCC_OscInitStruct->PLL;
+	return HAL_OK;
+}
+
+/**
+  * @brief  Calcula SYSCLK (HSI -> PLL) y PCLK1 con los divisores configurados por SystemClock_Config().
+  */
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+	(void)FLatency;
+	uint32_t sysclk = HSI_HZ;
+
+	if (RCC_ClkInitStruct->SYSCLKSource == RCC_SYSCLKSOURCE_PLLCLK)
+	{
+		if (pll.PLLM == 0 || pll.PLLP == 0) return HAL_ERROR;
+		sysclk = (uint32_t)((uint64_t)HSI_HZ / pll.PLLM * pll.PLLN / pll.PLLP);
+	}
+
+	SystemCoreClock = sysclk / RCC_ClkInitStruct->AHBCLKDivider;
+	pclk1_hz = SystemCoreClock / RCC_ClkInitStruct->APB1CLKDivider;
+	return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+	return pclk1_hz;
+}
+
+/**
+  * @brief  Tick de 1 ms. Cada llamada consume TICK_CALL_NS y, si el superloop está ocioso,
+  * 		el reloj salta al próximo quantum (sin pasar una pulsación programada).
+  */
+uint32_t HAL_GetTick(void)
+{
+	stats.tick_calls++;
+	vclock_advance_ns(TICK_CALL_NS);
+
+	if (++idle_calls >= IDLE_CALLS)
+	{
+		uint64_t now = vclock_now_ns();
+		uint64_t next = (now / quantum_ns + 1) * quantum_ns;
+		uint64_t event = next_event_ns(now);
+
+		if (event < next) next = event;
+		stats.idle_skips++;
+		stats.skipped_ns += next - now;
+		vclock_advance_to_ns(next);
+		idle_calls = 0;
+	}
+
+	irq_deliver();
+	check_end();
+	return (uint32_t)(vclock_now_ns() / NS_PER_MS);
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+	activity();
+	vclock_advance_ns((uint64_t)Delay * NS_PER_MS);
+	irq_deliver();
+	check_end();
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+	(void)IRQn;
+	(void)PreemptPriority;
+	(void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+	nvic_enabled |= 1ULL << IRQn;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+	nvic_enabled &= ~(1ULL << IRQn);
+}
+
+/**
+  * @brief  WFI: el núcleo duerme hasta la próxima interrupción, que es el SysTick (a lo sumo un
+  * 		quantum) o un evento anterior.
+  */
+void HAL_PWR_EnterSLEEPMode(uint32_t Regulator, uint8_t SLEEPEntry)
+{
+	(void)Regulator;
+	(void)SLEEPEntry;
+
+	uint64_t now = vclock_now_ns();
+	uint64_t next = (now / quantum_ns + 1) * quantum_ns;
+	uint64_t event = next_event_ns(now);
+
+	if (event < next) next = event;
+	if (i2c_irq_pending && i2c_irq_ns <= now) next = now; // IRQ pendiente: WFI no espera
+
+	stats.sleeps++;
+	stats.sleep_ns += next - now;
+	vclock_advance_to_ns(next);
+	irq_deliver();
+	check_end();
+}
+
+/**
+  * @brief  Acceso a DWT: CYCCNT avanza con el reloj virtual a SystemCoreClock mientras está habilitado.
+  */
+DWT_Type *halshim_dwt(void)
+{
+	vclock_advance_ns(DWT_CALL_NS);
+
+	uint64_t cycles = vclock_now_ns() * (SystemCoreClock / 1000000U) / 1000U;
+	if (dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) dwt.CYCCNT += (uint32_t)(cycles - dwt_last_cycles);
+	dwt_last_cycles = cycles;
+
+	return &dwt;
+}
+
+/* ====================  GPIO  ========================================== */
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+	size_t port = GPIOx - halshim_gpio;
+
+	if (GPIO_Init->Mode == GPIO_MODE_IT_RISING) gpio_it_rising[port] |= GPIO_Init->Pin;
+	else gpio_it_rising[port] &= ~GPIO_Init->Pin;
+}
+
+/**
+  * @brief  PC13 (B1) devuelve GPIO_PIN_RESET durante una pulsación programada; el resto lee ODR.
+  */
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+	if (GPIOx == GPIOC && GPIO_Pin == GPIO_PIN_13)
+	{
+		uint64_t now = vclock_now_ns();
+		for (uint16_t i = 0; i < num_presses; i++)
+		{
+			if (now >= presses[i].start_ns && now < presses[i].end_ns) return GPIO_PIN_RESET;
+		}
+		return GPIO_PIN_SET;
+	}
+	if (GPIOx == GPIOB && GPIO_Pin == GPIO_PIN_9 && i2c_sda_held) return GPIO_PIN_RESET; // SDA retenida
+	if (gpio_inputs[GPIOx - halshim_gpio] & GPIO_Pin) return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+
+	return (GPIOx->ODR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+	bool was_set = GPIOx->ODR & GPIO_Pin;
+
+	activity();
+	if (PinState == GPIO_PIN_SET) GPIOx->ODR |= GPIO_Pin;
+	else GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+
+	if (GPIOx == GPIOB && (GPIO_Pin & GPIO_PIN_12)) sdsim_select(PinState == GPIO_PIN_RESET);
+	if (GPIOx == GPIOA && (GPIO_Pin & GPIO_PIN_5) && !was_set && PinState == GPIO_PIN_SET) stats.led_toggles++;
+	if (GPIOx == GPIOB && (GPIO_Pin & GPIO_PIN_8) && !was_set && PinState == GPIO_PIN_SET && i2c_sda_held) i2c_sda_held--;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+	HAL_GPIO_WritePin(GPIOx, GPIO_Pin, (GPIOx->ODR & GPIO_Pin) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+/* ====================  UART  ========================================== */
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+	if (huart->Init.BaudRate == 0) return HAL_ERROR;
+	uart_baud = huart->Init.BaudRate;
+	return HAL_OK;
+}
+
+/**
+  * @brief  Escribe en stdout (sin '\r') y avanza el reloj el tiempo de transmisión (10 bits por byte).
+  */
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	(void)huart;
+	(void)Timeout;
+
+	activity();
+	for (uint16_t i = 0; i < Size; i++)
+	{
+		if (!uart_quiet && pData[i] != '\r')
+		{
+			if (uart_line_start && uart_timestamps) printf("[%12.3f] ", vclock_now_ns() / 1e9);
+			putchar(pData[i]);
+			uart_line_start = (pData[i] == '\n');
+		}
+	}
+	stats.uart_bytes += Size;
+	vclock_advance_ns(10ULL * Size * 1000000000ULL / uart_baud);
+
+	return HAL_OK;
+}
+
+/**
+  * @brief  No hay entrada por UART: espera el timeout y lo informa.
+  */
+HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	(void)huart;
+	(void)pData;
+	(void)Size;
+
+	activity();
+	if (Timeout != HAL_MAX_DELAY) vclock_advance_ns((uint64_t)Timeout * NS_PER_MS);
+	check_end();
+	return HAL_TIMEOUT;
+}
+
+/* ====================  SPI  =========================================== */
+
+/**
+  * @brief  Toma el prescaler: SCK = PCLK1 / 2^(BR+1).
+  */
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi)
+{
+	uint32_t br = (hspi->Init.BaudRatePrescaler >> 3) & 0x7;
+	uint64_t sck = pclk1_hz >> (br + 1);
+
+	spi_byte_ns = (8ULL * 1000000000ULL + sck - 1) / sck;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	(void)hspi;
+	(void)Timeout;
+	spi_xfer(pData, NULL, Size);
+	return HAL_OK;
+}
+
+/**
+  * @note   La HAL real transmite el propio buffer de recepción; acá se envía 0xFF (lo que espera la tarjeta).
+  */
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	(void)hspi;
+	(void)Timeout;
+	spi_xfer(NULL, pData, Size);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, const uint8_t *pTxData, uint8_t *pRxData, uint16_t Size, uint32_t Timeout)
+{
+	(void)hspi;
+	(void)Timeout;
+	spi_xfer(pTxData, pRxData, Size);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size)
+{
+	spi_xfer(pData, NULL, Size);
+	HAL_SPI_TxCpltCallback(hspi);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size)
+{
+	spi_xfer(NULL, pData, Size);
+	HAL_SPI_RxCpltCallback(hspi);
+	return HAL_OK;
+}
+
+/* ====================  I2C  =========================================== */
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c->Init.ClockSpeed == 0) return HAL_ERROR;
+	i2c_hz = hi2c->Init.ClockSpeed;
+	hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c)
+{
+	(void)hi2c;
+	i2c_irq_pending = false;
+	return HAL_OK;
+}
+
+/**
+  * @brief  Escritura bloqueante. Con el bus colgado espera Timeout (con HAL_MAX_DELAY el firmware
+  * 		quedaría colgado para siempre: se termina la simulación).
+  */
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	HAL_StatusTypeDef ret = i2c_xfer(DevAddress, pData, Size, false);
+
+	hi2c->ErrorCode = (ret == HAL_ERROR) ? HAL_I2C_ERROR_AF : HAL_I2C_ERROR_NONE;
+	if (ret == HAL_BUSY || ret == HAL_TIMEOUT)
+	{
+		if (Timeout == HAL_MAX_DELAY) halshim_fatal("I2C1 colgado");
+		vclock_advance_ns((uint64_t)Timeout * NS_PER_MS);
+		ret = HAL_TIMEOUT;
+	}
+	return ret;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	HAL_StatusTypeDef ret = i2c_xfer(DevAddress, pData, Size, true);
+
+	hi2c->ErrorCode = (ret == HAL_ERROR) ? HAL_I2C_ERROR_AF : HAL_I2C_ERROR_NONE;
+	if (ret == HAL_BUSY || ret == HAL_TIMEOUT)
+	{
+		if (Timeout == HAL_MAX_DELAY) halshim_fatal("I2C1 colgado");
+		vclock_advance_ns((uint64_t)Timeout * NS_PER_MS);
+		ret = HAL_TIMEOUT;
+	}
+	return ret;
+}
+
+/**
+  * @brief  Escritura por interrupciones: el callback (Cplt o Error) llega al terminar el tiempo de bus.
+  */
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size)
+{
+	if (i2c_irq_pending) return HAL_BUSY;
+
+	HAL_StatusTypeDef ret = i2c_xfer(DevAddress, pData, Size, false);
+	if (ret == HAL_BUSY) return HAL_BUSY;
+	if (ret == HAL_TIMEOUT) return HAL_OK; // el bus se colgó durante la transferencia: la IRQ no llega
+
+	hi2c->ErrorCode = (ret == HAL_ERROR) ? HAL_I2C_ERROR_AF : HAL_I2C_ERROR_NONE;
+	i2c_irq_handle = hi2c;
+	i2c_irq_rx = false;
+	i2c_irq_pending = true;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size)
+{
+	if (i2c_irq_pending) return HAL_BUSY;
+
+	HAL_StatusTypeDef ret = i2c_xfer(DevAddress, pData, Size, true);
+	if (ret == HAL_BUSY) return HAL_BUSY;
+	if (ret == HAL_TIMEOUT) return HAL_OK; // el bus se colgó durante la transferencia: la IRQ no llega
+
+	hi2c->ErrorCode = (ret == HAL_ERROR) ? HAL_I2C_ERROR_AF : HAL_I2C_ERROR_NONE;
+	i2c_irq_handle = hi2c;
+	i2c_irq_rx = true;
+	i2c_irq_pending = true;
+	return HAL_OK;
+}
+
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef *hi2c)
+{
+	return hi2c->ErrorCode;
+}
+
+/* ====================  Funciones internas  ============================ */
+
+/**
+  * @brief  El firmware usó un periférico: el superloop no está ocioso.
+  */
+static void activity(void)
+{
+	idle_calls = 0;
+}
+
+static void check_end(void)
+{
+	if (end_ns && vclock_now_ns() >= end_ns) exit(0);
+}
+
+/**
+  * @brief  Próximo instante en que cambia una entrada (flanco de B1), llega una IRQ, vence un timer
+  * 		de un modelo o termina la simulación.
+  */
+static uint64_t next_event_ns(uint64_t now)
+{
+	uint64_t next = end_ns ? end_ns : UINT64_MAX;
+
+	if (i2c_irq_pending && i2c_irq_ns > now && i2c_irq_ns < next) next = i2c_irq_ns;
+
+	for (uint8_t i = 0; i < num_timers; i++)
+	{
+		if (timers[i].armed && timers[i].at_ns > now && timers[i].at_ns < next) next = timers[i].at_ns;
+	}
+
+	for (uint16_t i = 0; i < num_presses; i++)
+	{
+		if (presses[i].start_ns > now && presses[i].start_ns < next) next = presses[i].start_ns;
+		if (presses[i].end_ns > now && presses[i].end_ns < next) next = presses[i].end_ns;
+	}
+	return next;
+}
+
+static void spi_xfer(const uint8_t *tx, uint8_t *rx, uint16_t size)
+{
+	activity();
+	stats.spi_bytes += size;
+	for (uint16_t i = 0; i < size; i++)
+	{
+		vclock_advance_ns(spi_byte_ns);
+		uint8_t miso = sdsim_xfer(tx ? tx[i] : 0xFF);
+		if (rx) rx[i] = miso;
+	}
+}
+
+/**
+  * @brief  Ejecuta los timers vencidos y entrega la interrupción de fin de la transferencia I2C si
+  * 		el reloj ya pasó su fin.
+  */
+static void irq_deliver(void)
+{
+	uint64_t now = vclock_now_ns();
+
+	for (uint8_t i = 0; i < num_timers; i++)
+	{
+		if (timers[i].armed && timers[i].at_ns <= now)
+		{
+			timers[i].armed = false;
+			timers[i].fn(timers[i].ctx);
+		}
+	}
+
+	if (!i2c_irq_pending || now < i2c_irq_ns) return;
+
+	i2c_irq_pending = false;
+	activity();
+	if (i2c_irq_handle->ErrorCode != HAL_I2C_ERROR_NONE) HAL_I2C_ErrorCallback(i2c_irq_handle);
+	else if (i2c_irq_rx) HAL_I2C_MasterRxCpltCallback(i2c_irq_handle);
+	else HAL_I2C_MasterTxCpltCallback(i2c_irq_handle);
+}
+
+/**
+  * @brief  Transferencia con el dispositivo (dirección + datos, 9 bits por byte).
+  * @note   Las transferencias bloqueantes avanzan el reloj; las por interrupciones dejan el fin en
+  * 		i2c_irq_ns. Con SDA retenida o el periférico BUSY la HAL espera I2C_BUSY_WAIT_MS y
+  * 		devuelve HAL_BUSY.
+  * @retval HAL_OK, HAL_ERROR (NACK), HAL_BUSY (el bus ya estaba colgado) o HAL_TIMEOUT (el
+  * 		esclavo colgó el bus durante esta transferencia).
+  */
+static HAL_StatusTypeDef i2c_xfer(uint16_t addr8, uint8_t *data, uint16_t size, bool rx)
+{
+	const halshim_i2c_dev_t *dev = i2c_find(addr8);
+	bool ack;
+
+	activity();
+	if (i2c_periph_busy || i2c_sda_held)
+	{
+		vclock_advance_ns(I2C_BUSY_WAIT_MS * NS_PER_MS);
+		return HAL_BUSY;
+	}
+
+	stats.i2c_transfers++;
+	i2c_stall_request = false;
+	if (rx) ack = dev != NULL && dev->read != NULL && dev->read(dev->ctx, data, size);
+	else ack = dev != NULL && dev->write != NULL && dev->write(dev->ctx, data, size);
+
+	uint64_t bytes = ack ? size + 1 : 1;
+	i2c_irq_ns = vclock_now_ns() + 9ULL * bytes * 1000000000ULL / i2c_hz;
+
+	if (i2c_stall_request)
+	{
+		stats.i2c_stalls++;
+		i2c_periph_busy = true;
+		return HAL_TIMEOUT;
+	}
+	if (!ack) stats.i2c_nacks++;
+	return ack ? HAL_OK : HAL_ERROR;
+}
+
+/**
+  * @brief  Línea EXTI del pin habilitada en el NVIC (EXTI9_5 o EXTI15_10; las demás no se usan).
+  */
+static bool exti_enabled(uint16_t GPIO_Pin)
+{
+	IRQn_Type irq = (GPIO_Pin >= GPIO_PIN_10) ? EXTI15_10_IRQn : EXTI9_5_IRQn;
+
+	if (GPIO_Pin < GPIO_PIN_5) return false;
+	return nvic_enabled & (1ULL << irq);
+}
+
+static const halshim_i2c_dev_t *i2c_find(uint16_t addr8)
+{
+	for (uint8_t i = 0; i < num_i2c_devs; i++)
+	{
+		if (i2c_devs[i].addr == (addr8 >> 1)) return &i2c_devs[i];
+	}
+	return NULL;
+}
@@ -0,0 +1,63 @@
+/*
+ *	@file hal_shim.h
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title HAL simulada para el host - control (.h)
+ *  @brief Funciones para configurar la HAL simulada desde el programa de host (no las usa el firmware)
+ */
+
+#ifndef HOST_HAL_HAL_SHIM_H_
+#define HOST_HAL_HAL_SHIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stm32f4xx_hal.h"
+
+#define HALSHIM_MAX_I2C_DEVS	4
+#define HALSHIM_MAX_PRESSES		64
+#define HALSHIM_MAX_TIMERS		8
+
+/*
+ * Dispositivo I2C simulado. Las funciones reciben ctx y devuelven false para responder con NACK.
+ * Un dispositivo que hace clock stretching avanza el reloj virtual dentro de read(). Para colgar
+ * el bus (esclavo reteniendo SDA) llama a halshim_i2c_stall() dentro de write() o read().
+ */
+typedef struct
+{
+  uint8_t addr;												// dirección de 7 bits
+  void *ctx;													// estado del dispositivo (varias instancias del mismo modelo)
+  bool (*write)(void *ctx, const uint8_t *data, uint16_t len);
+  bool (*read)(void *ctx, uint8_t *data, uint16_t len);
+} halshim_i2c_dev_t;
+
+typedef struct
+{
+  uint64_t tick_calls;		// llamadas a HAL_GetTick()
+  uint64_t idle_skips;		// saltos del reloj por superloop ocioso
+  uint64_t skipped_ns;		// tiempo virtual salteado
+  uint64_t uart_bytes;
+  uint32_t led_toggles;		// flancos de encendido de LD2
+  uint32_t exti_events;		// flancos entregados a HAL_GPIO_EXTI_Callback
+  uint64_t sleeps;			// entradas a sleep (WFI)
+  uint64_t sleep_ns;		// tiempo virtual con el núcleo dormido
+  uint32_t i2c_transfers;
+  uint32_t i2c_nacks;
+  uint32_t i2c_stalls;		// transferencias colgadas por un esclavo reteniendo SDA
+  uint32_t i2c_resets;		// resets del periférico (recuperación del bus)
+  uint64_t spi_bytes;
+} halshim_stats_t;
+
+// hal_shim.c
+void halshim_set_quantum_ms(uint32_t ms);
+void halshim_set_run_time_ms(uint64_t ms);
+bool halshim_button_press(uint64_t at_ms, uint32_t duration_ms);
+void halshim_uart_config(bool quiet, bool timestamps);
+bool halshim_i2c_attach(const halshim_i2c_dev_t *dev);
+void halshim_i2c_stall(uint8_t clocks);
+void halshim_gpio_input(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, bool level);
+bool halshim_timer(uint64_t at_ns, void (*fn)(void *ctx), void *ctx);
+const halshim_stats_t *halshim_get_stats(void);
+
+#endif /* HOST_HAL_HAL_SHIM_H_ */
@@ -0,0 +1,353 @@
+/*
+ *	@file stm32f4xx_hal.h
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title HAL simulada para el host (.h)
+ *  @brief Subconjunto de la HAL de STM32F4 que usa el firmware, implementado en hal_shim.c
+ *
+ *  Solo declara los tipos, constantes y funciones que usan Core/Src/main.c, API/ y myDrivers/.
+ *  Los valores de las constantes no necesitan coincidir con los de la HAL real salvo donde
+ *  hal_shim.c los interpreta (prescalers de SPI, pines y estados de GPIO).
+ */
+
+#ifndef HOST_HAL_STM32F4XX_HAL_H_
+#define HOST_HAL_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ====================  Tipos generales  =============================== */
+
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY		0xFFFFFFFFU
+
+extern uint32_t SystemCoreClock;
+
+/* ====================  GPIO  ========================================== */
+
+typedef struct
+{
+  uint32_t IDR;
+  uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef enum
+{
+  GPIO_PIN_RESET = 0,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct
+{
+  uint32_t Pin;
+  uint32_t Mode;
+  uint32_t Pull;
+  uint32_t Speed;
+  uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+extern GPIO_TypeDef halshim_gpio[4];
+#define GPIOA				(&halshim_gpio[0])
+#define GPIOB				(&halshim_gpio[1])
+#define GPIOC				(&halshim_gpio[2])
+#define GPIOH				(&halshim_gpio[3])
+
+#define GPIO_PIN_0			((uint16_t)0x0001)
+#define GPIO_PIN_1			((uint16_t)0x0002)
+#define GPIO_PIN_2			((uint16_t)0x0004)
+#define GPIO_PIN_3			((uint16_t)0x0008)
+#define GPIO_PIN_4			((uint16_t)0x0010)
+#define GPIO_PIN_5			((uint16_t)0x0020)
+#define GPIO_PIN_6			((uint16_t)0x0040)
+#define GPIO_PIN_7			((uint16_t)0x0080)
+#define GPIO_PIN_8			((uint16_t)0x0100)
+#define GPIO_PIN_9			((uint16_t)0x0200)
+#define GPIO_PIN_10			((uint16_t)0x0400)
+#define GPIO_PIN_11			((uint16_t)0x0800)
+#define GPIO_PIN_12			((uint16_t)0x1000)
+#define GPIO_PIN_13			((uint16_t)0x2000)
+#define GPIO_PIN_14			((uint16_t)0x4000)
+#define GPIO_PIN_15			((uint16_t)0x8000)
+
+#define GPIO_MODE_INPUT			0x0U
+#define GPIO_MODE_OUTPUT_PP		0x1U
+#define GPIO_MODE_OUTPUT_OD		0x11U
+#define GPIO_MODE_AF_PP			0x2U
+#define GPIO_MODE_AF_OD			0x12U
+#define GPIO_MODE_IT_RISING		0x10110000U
+#define GPIO_MODE_IT_FALLING	0x10210000U
+#define GPIO_NOPULL				0x0U
+#define GPIO_PULLUP				0x1U
+#define GPIO_PULLDOWN			0x2U
+#define GPIO_SPEED_FREQ_LOW		0x0U
+#define GPIO_SPEED_FREQ_HIGH	0x2U
+#define GPIO_SPEED_FREQ_VERY_HIGH	0x3U
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+/* ====================  Núcleo, reloj y NVIC  ========================== */
+
+typedef enum
+{
+  DMA1_Stream3_IRQn = 14,
+  DMA1_Stream4_IRQn = 15,
+  EXTI9_5_IRQn = 23,
+  I2C1_EV_IRQn = 31,
+  I2C1_ER_IRQn = 32,
+  EXTI15_10_IRQn = 40
+} IRQn_Type;
+
+typedef struct
+{
+  uint32_t PLLState;
+  uint32_t PLLSource;
+  uint32_t PLLM;
+  uint32_t PLLN;
+  uint32_t PLLP;
+  uint32_t PLLQ;
+  uint32_t PLLR;
+} RCC_PLLInitTypeDef;
+
+typedef struct
+{
+  uint32_t OscillatorType;
+  uint32_t HSEState;
+  uint32_t LSEState;
+  uint32_t HSIState;
+  uint32_t HSICalibrationValue;
+  uint32_t LSIState;
+  RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct
+{
+  uint32_t ClockType;
+  uint32_t SYSCLKSource;
+  uint32_t AHBCLKDivider;
+  uint32_t APB1CLKDivider;
+  uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+#define RCC_OSCILLATORTYPE_HSI		0x2U
+#define RCC_HSI_ON					0x1U
+#define RCC_HSICALIBRATION_DEFAULT	0x10U
+#define RCC_PLL_ON					0x2U
+#define RCC_PLLSOURCE_HSI			0x0U
+#define RCC_PLLP_DIV2				0x2U
+#define RCC_PLLP_DIV4				0x4U
+#define RCC_CLOCKTYPE_SYSCLK		0x1U
+#define RCC_CLOCKTYPE_HCLK			0x2U
+#define RCC_CLOCKTYPE_PCLK1			0x4U
+#define RCC_CLOCKTYPE_PCLK2			0x8U
+#define RCC_SYSCLKSOURCE_PLLCLK		0x2U
+#define RCC_SYSCLK_DIV1				0x1U
+#define RCC_HCLK_DIV1				0x1U
+#define RCC_HCLK_DIV2				0x2U
+#define RCC_HCLK_DIV4				0x4U
+#define FLASH_LATENCY_2				0x2U
+#define PWR_REGULATOR_VOLTAGE_SCALE3	0x1U
+#define PWR_MAINREGULATOR_ON		0x0U
+#define PWR_SLEEPENTRY_WFI			0x1U
+
+#define __HAL_RCC_PWR_CLK_ENABLE()			((void)0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE()		((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()		((void)0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()		((void)0)
+#define __HAL_RCC_GPIOH_CLK_ENABLE()		((void)0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()			((void)0)
+#define __HAL_RCC_I2C1_FORCE_RESET()		halshim_i2c_reset()
+#define __HAL_RCC_I2C1_RELEASE_RESET()		((void)0)
+#define __HAL_PWR_VOLTAGESCALING_CONFIG(x)	((void)(x))
+
+HAL_StatusTypeDef HAL_Init(void);
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+void HAL_PWR_EnterSLEEPMode(uint32_t Regulator, uint8_t SLEEPEntry);
+
+void halshim_fatal(const char *reason);
+#define __disable_irq()		halshim_fatal("Error_Handler")
+#define __enable_irq()		((void)0)
+
+/* Contador de ciclos DWT: se calcula desde el reloj virtual en cada acceso a DWT. */
+typedef struct
+{
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+DWT_Type *halshim_dwt(void);
+extern CoreDebug_Type halshim_coredebug;
+#define DWT							(halshim_dwt())
+#define CoreDebug					(&halshim_coredebug)
+#define DWT_CTRL_CYCCNTENA_Msk		0x1U
+#define CoreDebug_DEMCR_TRCENA_Msk	(1UL << 24)
+
+/* ====================  DMA  =========================================== */
+
+typedef struct
+{
+  void *Instance;
+  void *Parent;
+} DMA_HandleTypeDef;
+
+/* ====================  UART  ========================================== */
+
+typedef struct
+{
+  uint32_t BaudRate;
+  uint32_t WordLength;
+  uint32_t StopBits;
+  uint32_t Parity;
+  uint32_t Mode;
+  uint32_t HwFlowCtl;
+  uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef struct
+{
+  void *Instance;
+  UART_InitTypeDef Init;
+} UART_HandleTypeDef;
+
+extern int halshim_usart2;
+#define USART2						((void *)&halshim_usart2)
+#define UART_WORDLENGTH_8B			0x0U
+#define UART_STOPBITS_1				0x0U
+#define UART_PARITY_NONE			0x0U
+#define UART_MODE_TX_RX				0xCU
+#define UART_HWCONTROL_NONE			0x0U
+#define UART_OVERSAMPLING_16		0x0U
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+/* ====================  SPI  =========================================== */
+
+typedef struct
+{
+  uint32_t Mode;
+  uint32_t Direction;
+  uint32_t DataSize;
+  uint32_t CLKPolarity;
+  uint32_t CLKPhase;
+  uint32_t NSS;
+  uint32_t BaudRatePrescaler;
+  uint32_t FirstBit;
+  uint32_t TIMode;
+  uint32_t CRCCalculation;
+  uint32_t CRCPolynomial;
+} SPI_InitTypeDef;
+
+typedef struct
+{
+  void *Instance;
+  SPI_InitTypeDef Init;
+  DMA_HandleTypeDef *hdmatx;
+  DMA_HandleTypeDef *hdmarx;
+} SPI_HandleTypeDef;
+
+extern int halshim_spi2;
+#define SPI2						((void *)&halshim_spi2)
+#define SPI_MODE_MASTER				0x104U
+#define SPI_DIRECTION_2LINES		0x0U
+#define SPI_DATASIZE_8BIT			0x0U
+#define SPI_POLARITY_LOW			0x0U
+#define SPI_PHASE_1EDGE				0x0U
+#define SPI_NSS_SOFT				0x200U
+#define SPI_FIRSTBIT_MSB			0x0U
+#define SPI_TIMODE_DISABLE			0x0U
+#define SPI_CRCCALCULATION_DISABLE	0x0U
+/* BR[2:0] en CR1 (bits 5:3), como en la HAL real: SCK = PCLK / 2^(BR+1) */
+#define SPI_BAUDRATEPRESCALER_2		0x00U
+#define SPI_BAUDRATEPRESCALER_4		0x08U
+#define SPI_BAUDRATEPRESCALER_8		0x10U
+#define SPI_BAUDRATEPRESCALER_16	0x18U
+#define SPI_BAUDRATEPRESCALER_32	0x20U
+#define SPI_BAUDRATEPRESCALER_64	0x28U
+#define SPI_BAUDRATEPRESCALER_128	0x30U
+#define SPI_BAUDRATEPRESCALER_256	0x38U
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, const uint8_t *pTxData, uint8_t *pRxData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi);
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi);
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi);
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi);
+
+/* ====================  I2C  =========================================== */
+
+typedef struct
+{
+  uint32_t ClockSpeed;
+  uint32_t DutyCycle;
+  uint32_t OwnAddress1;
+  uint32_t AddressingMode;
+  uint32_t DualAddressMode;
+  uint32_t OwnAddress2;
+  uint32_t GeneralCallMode;
+  uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct
+{
+  void *Instance;
+  I2C_InitTypeDef Init;
+  volatile uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+extern int halshim_i2c1;
+#define I2C1						((void *)&halshim_i2c1)
+#define I2C_DUTYCYCLE_2				0x0U
+#define I2C_ADDRESSINGMODE_7BIT		0x4000U
+#define I2C_DUALADDRESS_DISABLE		0x0U
+#define I2C_GENERALCALL_DISABLE		0x0U
+#define I2C_NOSTRETCH_DISABLE		0x0U
+#define HAL_I2C_ERROR_NONE			0x00U
+#define HAL_I2C_ERROR_BERR			0x01U
+#define HAL_I2C_ERROR_ARLO			0x02U
+#define HAL_I2C_ERROR_AF			0x04U
+#define HAL_I2C_ERROR_OVR			0x08U
+#define HAL_I2C_ERROR_TIMEOUT		0x20U
+
+void halshim_i2c_reset(void);
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+#endif /* HOST_HAL_STM32F4XX_HAL_H_ */
@@ -0,0 +1,42 @@
+/*
+ *	@file vclock.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Reloj virtual del host
+ *  @brief Base de tiempo común a la HAL simulada y a los modelos de dispositivos
+ *
+ *  El tiempo no corre solo: avanza cuando el firmware consulta el tick, transfiere datos por
+ *  un periférico o espera con HAL_Delay(). Así la ejecución es reproducible y los intervalos
+ *  ociosos se pueden saltear.
+ */
+
+#include "vclock.h"
+
+static uint64_t now_ns;
+
+/**
+  * @brief  Tiempo virtual desde el arranque en nanosegundos.
+  */
+uint64_t vclock_now_ns(void)
+{
+	return now_ns;
+}
+
+/**
+  * @brief  Avanza el tiempo virtual.
+  * @param  ns: Nanosegundos a avanzar.
+  */
+void vclock_advance_ns(uint64_t ns)
+{
+	now_ns += ns;
+}
+
+/**
+  * @brief  Avanza el tiempo virtual hasta un instante (no retrocede).
+  * @param  t_ns: Instante destino en nanosegundos.
+  */
+void vclock_advance_to_ns(uint64_t t_ns)
+{
+	if (t_ns > now_ns) now_ns = t_ns;
+}
@@ -0,0 +1,20 @@
+/*
+ *	@file vclock.h
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Reloj virtual del host (.h)
+ *  @brief Base de tiempo común a la HAL simulada y a los modelos de dispositivos
+ */
+
+#ifndef HOST_HAL_VCLOCK_H_
+#define HOST_HAL_VCLOCK_H_
+
+#include <stdint.h>
+
+// vclock.c
+uint64_t vclock_now_ns(void);
+void vclock_advance_ns(uint64_t ns);
+void vclock_advance_to_ns(uint64_t t_ns);
+
+#endif /* HOST_HAL_VCLOCK_H_ */
@@ -0,0 +1,576 @@
+/*
+ *	@file sd_sim.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Simulador de SD Card en modo SPI
+ *  @brief Modelo de SD Card en modo SPI sobre un archivo de imagen
+ *
+ *  Cada byte que el driver intercambia por SPI (sdsim_xfer) pasa por la máquina de estados de la
+ *  tarjeta (comandos, respuestas R1/R3/R7, tokens de datos y busy), y los bloques se leen y escriben
+ *  directamente sobre la imagen mapeada con mmap. Las latencias de la tarjeta se miden contra el
+ *  reloj virtual (vclock), que avanza quien maneja el bus: sd_sim_port.c (sdtool) o la HAL simulada.
+ */
+
+#include "sd_card.h"
+#include "sd_sim.h"
+#include "vclock.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SIM_QUEUE_SIZE		(1 + 1 + SD_BLOCK_SIZE + 2 + 8)
+#define SIM_ERASED_BYTE		0x00	// valor de los bloques borrados (SCR DATA_STAT_AFTER_ERASE = 0)
+
+#define R1_IDLE				0x01
+#define R1_ILLEGAL			0x04
+#define R1_CRC_ERROR		0x08
+#define R1_ADDRESS_ERROR	0x20
+#define R1_PARAM_ERROR		0x40
+
+typedef enum
+{
+	PH_CMD,				// esperando comandos
+	PH_READ_WAIT,		// lectura: esperando la latencia para enviar el siguiente bloque
+	PH_WRITE_TOKEN,		// escritura: esperando el token de inicio (o STOP_TRAN)
+	PH_WRITE_DATA		// escritura: recibiendo datos + CRC
+} sim_phase_t;
+
+static sdsim_config_t cfg;
+static sdsim_stats_t stats;
+
+static uint8_t *disk = NULL;
+static size_t disk_size;
+static uint32_t num_blocks;
+static int disk_fd = -1;
+
+static uint64_t busy_until_ns;
+
+static bool selected;
+static bool ready;
+static bool app_cmd;
+static uint32_t acmd41_count;
+
+static uint8_t cmd_buf[6];
+static uint8_t cmd_len;
+
+static uint8_t queue[SIM_QUEUE_SIZE];
+static uint16_t queue_head, queue_len;
+static bool queue_block;	// la cola contiene un bloque de lectura (se cuenta al terminar de enviarlo)
+
+static sim_phase_t phase = PH_CMD;
+static bool multi;
+static uint32_t data_block;
+static uint64_t ready_at_ns;
+static uint8_t data_buf[SD_BLOCK_SIZE + 2];
+static uint16_t data_len;
+
+static uint32_t erase_start, erase_end;
+
+static uint8_t sim_output(void);
+static void sim_input(uint8_t mosi);
+static void sim_command(void);
+static void sim_push(uint8_t b);
+static void sim_r1(uint8_t r1);
+static bool sim_block_arg(uint32_t arg, uint32_t *block);
+static void sim_push_data(const uint8_t *data, uint16_t len);
+static void sim_csd(uint8_t *csd);
+
+
+/* ====================  Funciones del simulador  ======================= */
+
+/**
+  * @brief  Completa la configuración por defecto: SDHC y latencias típicas.
+  * @note   El acceso y la programación se pagan una vez por comando; dentro de un stream (CMD18 /
+  *         CMD25) cada bloque espera solo read_block_us / write_block_us.
+  * @param  config: Puntero a la configuración.
+  */
+void sdsim_default_config(sdsim_config_t *config)
+{
+	config->sdhc = true;
+	config->init_polls = 3;
+	config->read_access_us = 300;
+	config->read_block_us = 20;
+	config->write_program_us = 800;
+	config->write_block_us = 100;
+	config->erase_busy_us = 20000;
+}
+
+/**
+  * @brief  Abre (o crea) la imagen de la tarjeta y la mapea en memoria.
+  * @note   La tarjeta arranca apagada: el driver debe inicializarla (SD_init / SD_initStart).
+  * @param  path: Archivo de imagen.
+  * @param  blocks: Tamaño en bloques de 512 bytes (la imagen se redimensiona). 0 para usar el tamaño actual.
+  * @param  config: Parámetros de la tarjeta (NULL para los valores por defecto).
+  * @retval true si la imagen quedó abierta.
+  */
+bool sdsim_open(const char *path, uint32_t blocks, const sdsim_config_t *config)
+{
+	struct stat st;
+
+	sdsim_close();
+
+	if (config != NULL) cfg = *config;
+	else sdsim_default_config(&cfg);
+
+	disk_fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (disk_fd < 0) return false;
+
+	if (blocks != 0 && ftruncate(disk_fd, (off_t)blocks * SD_BLOCK_SIZE) != 0)
+	{
+		sdsim_close();
+		return false;
+	}
+	if (fstat(disk_fd, &st) != 0 || st.st_size < SD_BLOCK_SIZE)
+	{
+		sdsim_close();
+		return false;
+	}
+
+	disk_size = (size_t)st.st_size;
+	num_blocks = (uint32_t)(disk_size / SD_BLOCK_SIZE);
+
+	disk = mmap(NULL, disk_size, PROT_READ | PROT_WRITE, MAP_SHARED, disk_fd, 0);
+	if (disk == MAP_FAILED)
+	{
+		disk = NULL;
+		sdsim_close();
+		return false;
+	}
+
+	selected = false;
+	ready = false;
+	app_cmd = false;
+	acmd41_count = 0;
+	cmd_len = 0;
+	queue_len = 0;
+	phase = PH_CMD;
+	busy_until_ns = 0;
+	memset(&stats, 0, sizeof(stats));
+
+	return true;
+}
+
+/**
+  * @brief  Sincroniza la imagen con el archivo y la cierra.
+  */
+void sdsim_close(void)
+{
+	if (disk != NULL)
+	{
+		msync(disk, disk_size, MS_SYNC);
+		munmap(disk, disk_size);
+		disk = NULL;
+	}
+	if (disk_fd >= 0)
+	{
+		close(disk_fd);
+		disk_fd = -1;
+	}
+	num_blocks = 0;
+}
+
+/**
+  * @brief  Cantidad de bloques de la imagen abierta.
+  */
+uint32_t sdsim_blocks(void)
+{
+	return num_blocks;
+}
+
+/**
+  * @brief  Acceso directo a un bloque de la imagen (para verificar sin pasar por el driver).
+  * @retval Puntero a los 512 bytes del bloque, o NULL si está fuera de la imagen.
+  */
+uint8_t *sdsim_block(uint32_t block)
+{
+	if (disk == NULL || block >= num_blocks) return NULL;
+	return &disk[(size_t)block * SD_BLOCK_SIZE];
+}
+
+/**
+  * @brief  Devuelve los contadores del simulador.
+  */
+const sdsim_stats_t *sdsim_get_stats(void)
+{
+	return &stats;
+}
+
+/**
+  * @brief  Reinicia los contadores del simulador.
+  */
+void sdsim_reset_stats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+/* ====================  Máquina de estados de la tarjeta  =============== */
+
+/**
+  * @brief  Selecciona o libera la tarjeta (línea CS).
+  * @note   Al liberar CS se aborta cualquier transferencia en curso.
+  * @param  select: true con CS en bajo.
+  */
+void sdsim_select(bool select)
+{
+	selected = select;
+	cmd_len = 0;
+	if (!select)
+	{
+		queue_len = 0;
+		queue_block = false;
+		phase = PH_CMD;
+	}
+}
+
+/**
+  * @brief  Intercambia un byte por el bus simulado.
+  * @note   Quien llama debe avanzar antes el reloj virtual el tiempo de un byte.
+  * @param  mosi: Byte enviado por el driver.
+  * @retval Byte devuelto por la tarjeta (0xFF si CS está alto).
+  */
+uint8_t sdsim_xfer(uint8_t mosi)
+{
+	stats.bytes++;
+
+	if (!selected || disk == NULL) return 0xFF;
+
+	uint8_t miso = sim_output();
+	sim_input(mosi);
+
+	return miso;
+}
+
+/**
+  * @brief  Próximo byte de la tarjeta: respuesta pendiente, bloque de lectura listo, busy o 0xFF.
+  */
+static uint8_t sim_output(void)
+{
+	if (queue_len == 0 && phase == PH_READ_WAIT && vclock_now_ns() >= ready_at_ns)
+	{
+		uint8_t *block = sdsim_block(data_block);
+		if (block == NULL)
+		{
+			sim_push(0x08); // data error token: out of range
+			stats.errors++;
+			phase = PH_CMD;
+		}
+		else
+		{
+			sim_push_data(block, SD_BLOCK_SIZE);
+			queue_block = true;
+			data_block++;
+			if (!multi) phase = PH_CMD;
+		}
+	}
+
+	if (queue_len > 0)
+	{
+		uint8_t b = queue[queue_head];
+		queue_head = (queue_head + 1) % SIM_QUEUE_SIZE;
+		queue_len--;
+		if (queue_len == 0 && queue_block)
+		{
+			stats.blocks_read++;
+			queue_block = false;
+			// CMD18: el bloque siguiente queda listo read_block_us después de terminar de enviar este
+			if (phase == PH_READ_WAIT) ready_at_ns = vclock_now_ns() + (uint64_t)cfg.read_block_us * 1000;
+		}
+		return b;
+	}
+
+	return (vclock_now_ns() < busy_until_ns) ? 0x00 : 0xFF;
+}
+
+/**
+  * @brief  Procesa un byte recibido de acuerdo a la fase actual.
+  */
+static void sim_input(uint8_t mosi)
+{
+	switch (phase)
+	{
+		case PH_WRITE_TOKEN:
+			if (mosi == (multi ? 0xFC : 0xFE))
+			{
+				phase = PH_WRITE_DATA;
+				data_len = 0;
+			}
+			else if (multi && mosi == 0xFD) // STOP_TRAN
+			{
+				phase = PH_CMD;
+				busy_until_ns = vclock_now_ns() + (uint64_t)cfg.write_program_us * 1000;
+			}
+			return;
+
+		case PH_WRITE_DATA:
+		{
+			data_buf[data_len++] = mosi;
+			if (data_len < sizeof(data_buf)) return;
+
+			uint8_t *block = sdsim_block(data_block);
+			if (block != NULL)
+			{
+				memcpy(block, data_buf, SD_BLOCK_SIZE);
+				stats.blocks_written++;
+				sim_push(0xE5); // data accepted
+				busy_until_ns = vclock_now_ns() + (uint64_t)(multi ? cfg.write_block_us : cfg.write_program_us) * 1000;
+			}
+			else
+			{
+				sim_push(0xED); // write error
+				stats.errors++;
+			}
+			data_block++;
+			phase = multi ? PH_WRITE_TOKEN : PH_CMD;
+			return;
+		}
+
+		case PH_CMD:
+		case PH_READ_WAIT:
+		default:
+			if (cmd_len == 0 && (mosi & 0xC0) != 0x40) return;
+
+			cmd_buf[cmd_len++] = mosi;
+			if (cmd_len == sizeof(cmd_buf))
+			{
+				cmd_len = 0;
+				sim_command();
+			}
+			return;
+	}
+}
+
+/**
+  * @brief  Ejecuta el comando recibido y encola su respuesta.
+  */
+static void sim_command(void)
+{
+	uint8_t cmd = cmd_buf[0] & 0x3F;
+	uint32_t arg = ((uint32_t)cmd_buf[1] << 24) | ((uint32_t)cmd_buf[2] << 16) | ((uint32_t)cmd_buf[3] << 8) | cmd_buf[4];
+	uint8_t idle = ready ? 0x00 : R1_IDLE;
+	bool app = app_cmd;
+	uint32_t block;
+
+	stats.commands++;
+	app_cmd = false;
+
+	queue_len = 0;
+	queue_block = false;
+	sim_push(0xFF); // NCR: un byte antes de la respuesta
+
+	if (app)
+	{
+		switch (cmd)
+		{
+			case 41: // ACMD41 SD_SEND_OP_COND
+				if (++acmd41_count >= cfg.init_polls) ready = true;
+				sim_r1(ready ? 0x00 : R1_IDLE);
+				return;
+
+			case 23: // ACMD23 SET_WR_BLK_ERASE_COUNT
+				sim_r1(idle);
+				return;
+
+			case 51: // ACMD51 SEND_SCR
+			{
+				static const uint8_t scr[8] = { 0x02, 0x35, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00 };
+				sim_r1(idle);
+				sim_push_data(scr, sizeof(scr));
+				return;
+			}
+
+			default:
+				break; // el resto se interpreta como comando normal
+		}
+	}
+
+	switch (cmd)
+	{
+		case 0: // GO_IDLE_STATE
+			if (cmd_buf[5] != 0x95) { sim_r1(idle | R1_CRC_ERROR); return; }
+			ready = false;
+			acmd41_count = 0;
+			phase = PH_CMD;
+			sim_r1(R1_IDLE);
+			return;
+
+		case 8: // SEND_IF_COND
+			if (cmd_buf[5] != 0x87) { sim_r1(idle | R1_CRC_ERROR); return; }
+			sim_r1(idle);
+			sim_push(0x00);
+			sim_push(0x00);
+			sim_push((arg >> 8) & 0x0F);
+			sim_push(arg & 0xFF);
+			return;
+
+		case 9: // SEND_CSD
+		case 10: // SEND_CID
+		{
+			uint8_t reg[16];
+			if (cmd == 9)
+			{
+				sim_csd(reg);
+			}
+			else
+			{
+				static const uint8_t cid[16] = { 0x00, 'S', 'M', 'S', 'D', 'S', 'I', 'M', 0x10, 0, 0, 0, 1, 0x01, 0xAA, 0x01 };
+				memcpy(reg, cid, sizeof(reg));
+			}
+			sim_r1(idle);
+			sim_push_data(reg, sizeof(reg));
+			return;
+		}
+
+		case 12: // STOP_TRANSMISSION
+			phase = PH_CMD;
+			sim_r1(idle);
+			return;
+
+		case 16: // SET_BLOCKLEN
+			sim_r1(arg == SD_BLOCK_SIZE ? idle : (idle | R1_PARAM_ERROR));
+			return;
+
+		case 17: // READ_SINGLE_BLOCK
+		case 18: // READ_MULTIPLE_BLOCK
+			if (!ready) { sim_r1(idle | R1_ILLEGAL); return; }
+			if (!sim_block_arg(arg, &block)) return;
+			sim_r1(0x00);
+			phase = PH_READ_WAIT;
+			multi = (cmd == 18);
+			data_block = block;
+			ready_at_ns = vclock_now_ns() + (uint64_t)cfg.read_access_us * 1000;
+			return;
+
+		case 24: // WRITE_BLOCK
+		case 25: // WRITE_MULTIPLE_BLOCK
+			if (!ready) { sim_r1(idle | R1_ILLEGAL); return; }
+			if (!sim_block_arg(arg, &block)) return;
+			sim_r1(0x00);
+			phase = PH_WRITE_TOKEN;
+			multi = (cmd == 25);
+			data_block = block;
+			return;
+
+		case 32: // ERASE_WR_BLK_START
+		case 33: // ERASE_WR_BLK_END
+			if (!ready) { sim_r1(idle | R1_ILLEGAL); return; }
+			if (!sim_block_arg(arg, &block)) return;
+			if (cmd == 32) erase_start = block;
+			else erase_end = block;
+			sim_r1(0x00);
+			return;
+
+		case 38: // ERASE
+			if (!ready) { sim_r1(idle | R1_ILLEGAL); return; }
+			if (erase_end < erase_start) { sim_r1(R1_PARAM_ERROR); return; }
+			memset(sdsim_block(erase_start), SIM_ERASED_BYTE, (size_t)(erase_end - erase_start + 1) * SD_BLOCK_SIZE);
+			stats.erases++;
+			sim_r1(0x00);
+			busy_until_ns = vclock_now_ns() + (uint64_t)cfg.erase_busy_us * 1000;
+			return;
+
+		case 55: // APP_CMD
+			app_cmd = true;
+			sim_r1(idle);
+			return;
+
+		case 58: // READ_OCR
+			sim_r1(idle);
+			sim_push((ready ? 0x80 : 0x00) | (cfg.sdhc ? 0x40 : 0x00));
+			sim_push(0xFF);
+			sim_push(0x80);
+			sim_push(0x00);
+			return;
+
+		default:
+			sim_r1(idle | R1_ILLEGAL);
+			return;
+	}
+}
+
+/**
+  * @brief  Encola un byte de respuesta.
+  */
+static void sim_push(uint8_t b)
+{
+	if (queue_len >= SIM_QUEUE_SIZE) return;
+	queue[(queue_head + queue_len) % SIM_QUEUE_SIZE] = b;
+	queue_len++;
+}
+
+/**
+  * @brief  Encola una respuesta R1, contando los comandos rechazados.
+  */
+static void sim_r1(uint8_t r1)
+{
+	if (r1 & ~R1_IDLE) stats.errors++;
+	sim_push(r1);
+}
+
+/**
+  * @brief  Convierte el argumento de un comando en número de bloque según el tipo de tarjeta.
+  * @note   Si la dirección es inválida encola la respuesta de error.
+  * @retval true si la dirección es válida.
+  */
+static bool sim_block_arg(uint32_t arg, uint32_t *block)
+{
+	if (!cfg.sdhc)
+	{
+		if (arg % SD_BLOCK_SIZE) { sim_r1(R1_ADDRESS_ERROR); return false; }
+		arg /= SD_BLOCK_SIZE;
+	}
+	if (arg >= num_blocks) { sim_r1(R1_PARAM_ERROR); return false; }
+
+	*block = arg;
+	return true;
+}
+
+/**
+  * @brief  Encola un bloque de datos: token de inicio, datos y CRC (no se calcula).
+  */
+static void sim_push_data(const uint8_t *data, uint16_t len)
+{
+	sim_push(0xFF);
+	sim_push(0xFE);
+	for (uint16_t i = 0; i < len; i++) sim_push(data[i]);
+	sim_push(0xFF);
+	sim_push(0xFF);
+}
+
+/**
+  * @brief  Arma el CSD según el tamaño de la imagen: v2.0 para SDHC, v1.0 para SDSC. TRAN_SPEED = 25 MHz.
+  */
+static void sim_csd(uint8_t *csd)
+{
+	memset(csd, 0, 16);
+	csd[1] = 0x0E;
+	csd[2] = 0x00;
+	csd[3] = 0x32;	// TRAN_SPEED: 10 Mbit/s x 2.5
+	csd[4] = 0x5B;
+	csd[5] = 0x59;	// CCC + READ_BL_LEN = 9
+	csd[15] = 0x01;
+
+	if (cfg.sdhc)
+	{
+		uint32_t c_size = (num_blocks >= 1024) ? num_blocks / 1024 - 1 : 0;
+		csd[0] = 0x40;
+		csd[7] = (c_size >> 16) & 0x3F;
+		csd[8] = (c_size >> 8) & 0xFF;
+		csd[9] = c_size & 0xFF;
+		csd[10] = 0x7F;
+		csd[11] = 0x80;
+	}
+	else
+	{
+		// bloques = (C_SIZE + 1) * 2^(C_SIZE_MULT + 2), con READ_BL_LEN = 9 y C_SIZE_MULT = 7
+		uint32_t c_size = (num_blocks >= 512) ? num_blocks / 512 - 1 : 0;
+		csd[0] = 0x00;
+		csd[6] = (c_size >> 10) & 0x03;
+		csd[7] = (c_size >> 2) & 0xFF;
+		csd[8] = (c_size & 0x03) << 6;
+		csd[9] = 0x03;	// C_SIZE_MULT[2:1]
+		csd[10] = 0x80;	// C_SIZE_MULT[0]
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ *	@file sd_sim.h
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Simulador de SD Card en modo SPI (.h)
+ *  @brief Definicion de funciones del modelo de SD Card para ejecutar el driver en el host
+ */
+
+#ifndef HOST_SDCARD_SD_SIM_H_
+#define HOST_SDCARD_SD_SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Parámetros de la tarjeta simulada. Los tiempos son en microsegundos de tiempo virtual (vclock).
+ */
+typedef struct
+{
+  bool sdhc;				// true: SDHC (direccionamiento por bloque), false: SDSC (por byte)
+  uint32_t init_polls;		// intentos de ACMD41 que responde en IDLE antes de quedar lista
+  uint32_t read_access_us;	// espera desde el comando de lectura (CMD17/CMD18) hasta el primer token de datos
+  uint32_t read_block_us;	// CMD18: espera entre el fin de un bloque y el token del siguiente
+  uint32_t write_program_us;	// busy de programación por comando: tras el bloque de CMD24 o el STOP_TRAN de CMD25
+  uint32_t write_block_us;	// CMD25: busy luego de recibir cada bloque del stream
+  uint32_t erase_busy_us;	// busy luego de CMD38
+} sdsim_config_t;
+
+typedef struct
+{
+  uint64_t bytes;			// bytes intercambiados por SPI
+  uint32_t commands;
+  uint32_t blocks_read;
+  uint32_t blocks_written;
+  uint32_t erases;
+  uint32_t errors;			// comandos rechazados (R1 distinto de 0x00/0x01) y bloques rechazados
+} sdsim_stats_t;
+
+// sd_sim.c
+void sdsim_default_config(sdsim_config_t *config);
+bool sdsim_open(const char *path, uint32_t blocks, const sdsim_config_t *config);
+void sdsim_close(void);
+uint32_t sdsim_blocks(void);
+uint8_t *sdsim_block(uint32_t block);
+void sdsim_select(bool select);
+uint8_t sdsim_xfer(uint8_t mosi);
+const sdsim_stats_t *sdsim_get_stats(void);
+void sdsim_reset_stats(void);
+
+#endif /* HOST_SDCARD_SD_SIM_H_ */
@@ -0,0 +1,107 @@
+/*
+ *	@file sd_sim_port.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Port de SD Card sobre el simulador
+ *  @brief port.c alternativo para el host: conecta el driver directamente con el modelo de tarjeta
+ *
+ *  Reemplaza a myDrivers/SDcard/Src/port.c en sdtool, sin pasar por la HAL. Cada byte avanza el
+ *  reloj virtual según el SCK configurado con sd_SetClock() y las transferencias DMA se completan
+ *  en la misma llamada.
+ */
+
+#include "sd_card.h"
+#include "sd_sim.h"
+#include "vclock.h"
+
+#define SIM_PCLK_HZ		42000000U	// PCLK1 de la placa (SPI2 cuelga de APB1)
+#define SIM_CALL_NS		100			// costo virtual de cada consulta de tiempo del driver
+
+static uint64_t byte_ns = 8000000000ULL / SD_INIT_CLOCK_HZ;
+
+static uint8_t port_xfer(uint8_t mosi);
+
+void cs_Low(void)
+{
+	sdsim_select(true);
+}
+
+void cs_High(void)
+{
+	sdsim_select(false);
+}
+
+void sd_Delay(uint32_t ms)
+{
+	vclock_advance_ns((uint64_t)ms * 1000000);
+}
+
+uint32_t sd_GetTick(void)
+{
+	vclock_advance_ns(SIM_CALL_NS);
+	return (uint32_t)(vclock_now_ns() / 1000000);
+}
+
+uint32_t sd_GetMicros(void)
+{
+	vclock_advance_ns(SIM_CALL_NS);
+	return (uint32_t)(vclock_now_ns() / 1000);
+}
+
+sd_err_t sd_TransmitReceive(const uint8_t *dataTx, uint8_t *dataRx, uint16_t size)
+{
+	for (uint16_t i = 0; i < size; i++) dataRx[i] = port_xfer(dataTx[i]);
+	return SD_OK;
+}
+
+sd_err_t sd_Transmit(const uint8_t *dataTx, uint16_t size)
+{
+	for (uint16_t i = 0; i < size; i++) port_xfer(dataTx[i]);
+	return SD_OK;
+}
+
+sd_err_t sd_Receive(uint8_t *dataRx, uint16_t size)
+{
+	for (uint16_t i = 0; i < size; i++) dataRx[i] = port_xfer(0xFF);
+	return SD_OK;
+}
+
+sd_err_t sd_TransmitDMA(const uint8_t *dataTx, uint16_t size)
+{
+	return sd_Transmit(dataTx, size); // la transferencia se completa en la llamada
+}
+
+sd_err_t sd_ReceiveDMA(uint8_t *dataRx, uint16_t size)
+{
+	return sd_Receive(dataRx, size);
+}
+
+sd_err_t sd_TransferStatus(void)
+{
+	return SD_OK;
+}
+
+/**
+  * @brief  Igual que en port.c: SCK = PCLK1 / 2^(n+1), el más rápido que no supere max_hz.
+  */
+uint32_t sd_SetClock(uint32_t max_hz)
+{
+	uint8_t n = 0;
+
+	while (n < 7 && (SIM_PCLK_HZ >> (n + 1)) > max_hz) n++;
+
+	uint32_t hz = SIM_PCLK_HZ >> (n + 1);
+	byte_ns = (8000000000ULL + hz - 1) / hz;
+
+	return hz;
+}
+
+/**
+  * @brief  Transfiere un byte: avanza el reloj virtual el tiempo de 8 ciclos de SCK.
+  */
+static uint8_t port_xfer(uint8_t mosi)
+{
+	vclock_advance_ns(byte_ns);
+	return sdsim_xfer(mosi);
+}
@@ -0,0 +1,22 @@
+/*
+ *	@file sht30_null_port.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Port vacío de SHT30
+ *  @brief port.c alternativo para el host: sht30.c se enlaza sin bus
+ *
+ *  Reemplaza a myDrivers/SHT30/Src/port.c en los benchmarks que solo usan SHT30_decodeFrame y las
+ *  conversiones entre ticks y °C / %HR (sht30bench, recordbench). Toda transferencia falla.
+ */
+
+#include "sht30.h"
+
+sht30_err_t sht30_write_command(sht30_t *dev, uint16_t cmd) { (void)dev; (void)cmd; return SHT30_ERROR; }
+sht30_err_t sht30_read(sht30_t *dev, uint8_t *data, uint16_t len) { (void)dev; (void)data; (void)len; return SHT30_ERROR; }
+sht30_err_t sht30_write_data(sht30_t *dev, uint16_t cmd, const uint8_t *data, uint16_t len) { (void)dev; (void)cmd; (void)data; (void)len; return SHT30_ERROR; }
+sht30_err_t sht30_write_command_IT(sht30_t *dev, uint16_t cmd) { (void)dev; (void)cmd; return SHT30_ERROR; }
+sht30_err_t sht30_read_IT(sht30_t *dev, uint8_t *data, uint16_t len) { (void)dev; (void)data; (void)len; return SHT30_ERROR; }
+sht30_err_t sht30_TransferStatus(sht30_t *dev) { (void)dev; return SHT30_ERROR; }
+void sht30_delay(uint32_t ms) { (void)ms; }
+uint32_t sht30_GetTick(void) { return 0; }
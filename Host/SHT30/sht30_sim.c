@@ -0,0 +1,634 @@
+/*
+ *	@file sht30_sim.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Simulador de SHT30
+ *  @brief Modelo del sensor SHT30 sobre el I2C de la HAL simulada
+ *
+ *  Decodifica los comandos del datasheet (Sensirion SHT3x-DIS):
+ *    - Single shot con clock stretching (0x2C06/0x2C0D/0x2C10) y sin él (0x2400/0x240B/0x2416).
+ *      La medición dura 15/6/4 ms según la repetibilidad; una lectura anterior se estira hasta
+ *      terminar (con stretching) o responde NACK (sin stretching).
+ *    - Periódico a 0.5/1/2/4/10 mps (0x20xx..0x27xx) y ART (0x2B32, 4 mps). El fetch (0xE000)
+ *      entrega la última medición no leída; si no hay, la lectura responde NACK.
+ *    - Break (0x3093): vuelve a single shot; soft reset (0x30A2): solo en single shot, 1.5 ms sin responder.
+ *    - Registro de estado (0xF32D lectura, 0x3041 clear) y límites de alerta (lectura 0xE1xx,
+ *      escritura 0x61xx con dato + CRC), admitidos también en modo periódico.
+ *  En modo periódico cada medición se hace en su instante (timer de la HAL simulada) y se compara
+ *  con los límites con la resolución del sensor (9 bits de T y 7 de HR): el pin ALERT sube al pasar
+ *  un límite SET y baja al volver entre los CLEAR. El pin se conecta con sht30sim_connect_alert.
+ *  Mientras mide o se reinicia no reconoce su dirección. Los comandos desconocidos se aceptan y se cuentan.
+ *
+ *  Los valores salen de una onda configurable o de una traza CSV (t_s,temp,hum) interpolada, que
+ *  se repite al terminar. Las fallas (NACK y CRC) se inyectan con un generador con semilla.
+ *  Se pueden conectar varios sensores (distintas direcciones), cada uno con su estado y su ruido.
+ */
+
+#include "sht30_sim.h"
+#include "benchutil.h"
+#include "hal_shim.h"
+#include "vclock.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NS_PER_MS				1000000ULL
+#define RESET_NS				1500000ULL	// soft reset
+#define BREAK_NS				1000000ULL	// break: vuelta a single shot
+
+#define STATUS_ALERT_PENDING	0x8000
+#define STATUS_HUM_ALERT		0x0800
+#define STATUS_TEMP_ALERT		0x0400
+#define STATUS_RESET			0x0010
+#define STATUS_CMD_FAIL			0x0002
+#define STATUS_WRITE_CRC_FAIL	0x0001
+#define STATUS_CLEARABLE		(STATUS_ALERT_PENDING | STATUS_HUM_ALERT | STATUS_TEMP_ALERT | STATUS_RESET)
+
+typedef enum
+{
+	REP_HIGH,
+	REP_MEDIUM,
+	REP_LOW
+} sim_rep_t;
+
+static const uint64_t meas_ns[] = { 15 * NS_PER_MS, 6 * NS_PER_MS, 4 * NS_PER_MS };
+
+// límites de alerta: high set, high clear, low clear, low set
+static const uint16_t limit_read_cmd[] = { 0xE11F, 0xE114, 0xE109, 0xE102 };
+static const uint16_t limit_write_cmd[] = { 0x611D, 0x6116, 0x610B, 0x6100 };
+static const uint16_t limit_default[] = { 0xCD33, 0xC92D, 0x3869, 0x3466 }; // 80/79/22/20 %HR, 60/58/-9/-10 °C
+
+typedef struct
+{
+	sht30sim_config_t cfg;
+	uint8_t addr;
+	uint64_t rng_state;
+
+	uint64_t busy_until_ns;		// reset o break en curso: no reconoce la dirección
+
+	bool single;				// medición single shot en curso
+	bool single_stretch;
+	sim_rep_t single_rep;
+	uint64_t single_ready_ns;
+
+	bool periodic;
+	sim_rep_t periodic_rep;
+	uint64_t periodic_start_ns;
+	uint64_t periodic_period_ns;
+	int64_t periodic_last;		// índice de la última medición periódica entregada
+
+	bool data_valid;
+	uint8_t frame[6];
+
+	uint16_t status;
+	uint16_t limits[4];
+	bool temp_alert, hum_alert;
+	bool alert_level;			// pin ALERT
+	void (*alert_fn)(uint8_t addr, bool level);
+
+	bool reg_valid;				// respuesta de estado o de límite pendiente de lectura
+	uint8_t reg[3];
+} sim_sensor_t;
+
+static sim_sensor_t sensors[SHT30SIM_MAX_SENSORS];
+static uint8_t num_sensors;
+static sht30sim_stats_t stats;	// suma de todos los sensores
+
+static trace_point_t *trace;	// compartida por todos los sensores
+static size_t trace_len;
+
+static bool sim_write(void *ctx, const uint8_t *data, uint16_t len);
+static bool sim_read(void *ctx, uint8_t *data, uint16_t len);
+static bool sim_periodic_cmd(uint16_t cmd, sim_rep_t *rep, uint64_t *period_ns);
+static bool sim_write_limit(sim_sensor_t *s, uint16_t cmd, const uint8_t *data);
+static int sim_limit_index(const uint16_t *cmds, uint16_t cmd);
+static void sim_reply(sim_sensor_t *s, uint16_t word);
+static void sim_defaults(sim_sensor_t *s);
+static void sim_periodic_update(sim_sensor_t *s);
+static void sim_periodic_timer(void *ctx);
+static void sim_alert_update(sim_sensor_t *s);
+static void sim_measure(sim_sensor_t *s, uint64_t t_ns, sim_rep_t rep);
+static void sim_signal(sim_sensor_t *s, double t, sim_rep_t rep, double *temp, double *hum);
+static bool sim_nack(sim_sensor_t *s);
+static double sim_uniform(sim_sensor_t *s);
+static double sim_gauss(sim_sensor_t *s);
+static uint8_t sim_crc8(const uint8_t *data, uint8_t len);
+
+
+/**
+  * @brief  Configuración por defecto: 22 ± 4 °C y 50 ∓ 10 %HR con período diario, ruido de la hoja
+  * 		de datos (0.04 °C / 0.1 %HR en alta repetibilidad) y sin fallas.
+  */
+void sht30sim_default_config(sht30sim_config_t *config)
+{
+	config->temp_mean = 22.0;
+	config->temp_amplitude = 4.0;
+	config->hum_mean = 50.0;
+	config->hum_amplitude = 10.0;
+	config->period_s = 86400.0;
+	config->temp_noise = 0.04;
+	config->hum_noise = 0.1;
+	config->nack_rate = 0.0;
+	config->crc_rate = 0.0;
+	config->hang_rate = 0.0;
+	config->seed = 1;
+}
+
+/**
+  * @brief  Conecta un sensor al bus I2C simulado.
+  * @note   Cada llamada agrega un sensor independiente (hasta SHT30SIM_MAX_SENSORS), con su propio
+  * 		estado, ruido y fallas; todos leen la misma traza.
+  * @param  addr: Dirección de 7 bits (SHT30SIM_ADDR o SHT30SIM_ADDR_ALT).
+  * @param  config: Configuración; NULL para la de sht30sim_default_config().
+  * @retval false si no hay lugar para otro sensor o la dirección ya está ocupada.
+  */
+bool sht30sim_attach(uint8_t addr, const sht30sim_config_t *config)
+{
+	if (num_sensors >= SHT30SIM_MAX_SENSORS) return false;
+
+	sim_sensor_t *s = &sensors[num_sensors];
+	halshim_i2c_dev_t dev = { addr, s, sim_write, sim_read };
+
+	if (config != NULL) s->cfg = *config;
+	else sht30sim_default_config(&s->cfg);
+	s->addr = addr;
+	s->rng_state = 0x9E3779B97F4A7C15ULL ^ s->cfg.seed;
+	sim_defaults(s);
+
+	if (!halshim_i2c_attach(&dev)) return false;
+	num_sensors++;
+	return true;
+}
+
+/**
+  * @brief  Conecta el pin ALERT de un sensor: fn se llama en cada cambio de nivel.
+  * @retval false si no hay un sensor en esa dirección.
+  */
+bool sht30sim_connect_alert(uint8_t addr, void (*fn)(uint8_t addr, bool level))
+{
+	for (uint8_t i = 0; i < num_sensors; i++)
+	{
+		if (sensors[i].addr == addr)
+		{
+			sensors[i].alert_fn = fn;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+  * @brief  Carga una traza CSV con líneas "t_s,temp,hum" (también separadas por ';' o espacios).
+  * @note   Las líneas que no empiezan con un número (encabezado, comentarios) se ignoran. Los valores
+  * 		se interpolan linealmente y la traza se repite desde el principio al terminar.
+  * @retval false si no se pudo leer el archivo o tiene menos de dos puntos.
+  */
+bool sht30sim_load_trace(const char *path)
+{
+	trace_point_t *points;
+	size_t n = bench_load_trace(path, &points);
+
+	if (points == NULL) return false;
+
+	// se descartan los puntos que no avanzan en el tiempo
+	trace_len = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		if (trace_len > 0 && points[i].t <= points[trace_len - 1].t) continue;
+		points[trace_len++] = points[i];
+	}
+	free(trace);
+	trace = points;
+
+	return trace_len >= 2;
+}
+
+const sht30sim_stats_t *sht30sim_get_stats(void)
+{
+	return &stats;
+}
+
+/* ====================  Bus I2C  ======================================= */
+
+static bool sim_write(void *ctx, const uint8_t *data, uint16_t len)
+{
+	sim_sensor_t *s = ctx;
+	uint64_t now = vclock_now_ns();
+	sim_rep_t rep;
+	uint64_t period;
+
+	int limit;
+
+	if (sim_nack(s)) return false;
+	if (now < s->busy_until_ns || (s->single && now < s->single_ready_ns) || (len != 2 && len != 5))
+	{
+		stats.nacks++;
+		return false;
+	}
+
+	uint16_t cmd = (data[0] << 8) | data[1];
+	stats.commands++;
+	s->single = false;
+	s->reg_valid = false;
+
+	if (len == 5) return sim_write_limit(s, cmd, &data[2]);
+
+	if (cmd == 0xE000)
+	{
+		sim_periodic_update(s); // la medición ya hecha (si no se leyó) queda disponible
+		return true;
+	}
+	if (cmd == 0xF32D)
+	{
+		sim_reply(s, s->status);
+		return true;
+	}
+	if (cmd == 0x3041)
+	{
+		s->status &= ~STATUS_CLEARABLE;
+		return true;
+	}
+	if ((limit = sim_limit_index(limit_read_cmd, cmd)) >= 0)
+	{
+		sim_reply(s, s->limits[limit]);
+		return true;
+	}
+	if (cmd == 0x3093)
+	{
+		s->periodic = false;
+		s->data_valid = false;
+		s->busy_until_ns = now + BREAK_NS;
+		return true;
+	}
+	if (sim_periodic_cmd(cmd, &rep, &period))
+	{
+		s->periodic = true;
+		s->periodic_rep = rep;
+		s->periodic_period_ns = period;
+		s->periodic_start_ns = now;
+		s->periodic_last = -1;
+		s->data_valid = false;
+		halshim_timer(now + meas_ns[rep], sim_periodic_timer, s);
+		return true;
+	}
+	if (s->periodic)
+	{
+		s->status |= STATUS_CMD_FAIL;
+		stats.nacks++; // en modo periódico solo se aceptan fetch, break, cambio de modo, estado y límites
+		return false;
+	}
+
+	s->data_valid = false;
+	s->status &= ~STATUS_CMD_FAIL;
+
+	switch (cmd)
+	{
+		case 0x2C06: case 0x2400: s->single_rep = REP_HIGH; break;
+		case 0x2C0D: case 0x240B: s->single_rep = REP_MEDIUM; break;
+		case 0x2C10: case 0x2416: s->single_rep = REP_LOW; break;
+
+		case 0x30A2:
+			sim_defaults(s);
+			s->busy_until_ns = now + RESET_NS;
+			return true;
+
+		default:
+			s->status |= STATUS_CMD_FAIL;
+			stats.unknown_commands++;
+			return true;
+	}
+
+	s->single = true;
+	s->single_stretch = (data[0] == 0x2C);
+	s->single_ready_ns = now + meas_ns[s->single_rep];
+	return true;
+}
+
+static bool sim_read(void *ctx, uint8_t *data, uint16_t len)
+{
+	sim_sensor_t *s = ctx;
+	uint64_t now = vclock_now_ns();
+
+	if (sim_nack(s)) return false;
+	if (now < s->busy_until_ns)
+	{
+		stats.nacks++;
+		return false;
+	}
+
+	if (s->reg_valid)
+	{
+		for (uint16_t i = 0; i < len; i++) data[i] = (i < sizeof(s->reg)) ? s->reg[i] : 0xFF;
+		s->reg_valid = false;
+		return true;
+	}
+
+	if (s->single)
+	{
+		if (now < s->single_ready_ns)
+		{
+			if (!s->single_stretch)
+			{
+				stats.nacks++;
+				return false;
+			}
+			stats.stretch_ns += s->single_ready_ns - now;
+			vclock_advance_to_ns(s->single_ready_ns); // SCL retenido hasta terminar la medición
+		}
+		sim_measure(s, s->single_ready_ns, s->single_rep);
+		s->single = false;
+	}
+
+	if (!s->data_valid)
+	{
+		stats.nacks++;
+		return false;
+	}
+
+	if (s->cfg.hang_rate > 0 && sim_uniform(s) < s->cfg.hang_rate)
+	{
+		halshim_i2c_stall(1 + (uint8_t)(sim_uniform(s) * 9) % 9); // SDA retenida en medio de un byte
+		stats.hangs++;
+		return true;
+	}
+
+	for (uint16_t i = 0; i < len; i++) data[i] = (i < sizeof(s->frame)) ? s->frame[i] : 0xFF;
+	if (s->cfg.crc_rate > 0 && sim_uniform(s) < s->cfg.crc_rate)
+	{
+		uint32_t bit = (uint32_t)(sim_uniform(s) * 48) % 48;
+		if (bit / 8 < len) data[bit / 8] ^= 1 << (bit % 8);
+		stats.crc_faults++;
+	}
+
+	s->data_valid = false;
+	stats.reads++;
+	return true;
+}
+
+/* ====================  Funciones internas  ============================ */
+
+/**
+  * @brief  Decodifica los comandos de medición periódica.
+  * @retval true si cmd es uno de ellos.
+  */
+static bool sim_periodic_cmd(uint16_t cmd, sim_rep_t *rep, uint64_t *period_ns)
+{
+	static const struct { uint16_t cmd[3]; uint64_t period_ns; } table[] = {
+		{ { 0x2032, 0x2024, 0x202F }, 2000 * NS_PER_MS },
+		{ { 0x2130, 0x2126, 0x212D }, 1000 * NS_PER_MS },
+		{ { 0x2236, 0x2220, 0x222B }, 500 * NS_PER_MS },
+		{ { 0x2334, 0x2322, 0x2329 }, 250 * NS_PER_MS },
+		{ { 0x2737, 0x2721, 0x272A }, 100 * NS_PER_MS },
+	};
+
+	if (cmd == 0x2B32) // ART: 4 mps, repetibilidad alta
+	{
+		*rep = REP_HIGH;
+		*period_ns = 250 * NS_PER_MS;
+		return true;
+	}
+
+	for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++)
+	{
+		for (int r = 0; r < 3; r++)
+		{
+			if (table[i].cmd[r] == cmd)
+			{
+				*rep = (sim_rep_t)r;
+				*period_ns = table[i].period_ns;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+  * @brief  Escritura de un límite de alerta (comando + dato + CRC).
+  * @note   Con el CRC incorrecto el límite no cambia y se marca en el registro de estado.
+  */
+static bool sim_write_limit(sim_sensor_t *s, uint16_t cmd, const uint8_t *data)
+{
+	int limit = sim_limit_index(limit_write_cmd, cmd);
+
+	if (limit < 0)
+	{
+		s->status |= STATUS_CMD_FAIL;
+		stats.nacks++;
+		return false;
+	}
+
+	s->status &= ~(STATUS_CMD_FAIL | STATUS_WRITE_CRC_FAIL);
+	if (sim_crc8(data, 2) != data[2])
+	{
+		s->status |= STATUS_WRITE_CRC_FAIL;
+		return true;
+	}
+	s->limits[limit] = (data[0] << 8) | data[1];
+	stats.limit_writes++;
+	return true;
+}
+
+/**
+  * @brief  Índice del límite que corresponde a cmd en la tabla cmds (-1 si no está).
+  */
+static int sim_limit_index(const uint16_t *cmds, uint16_t cmd)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		if (cmds[i] == cmd) return i;
+	}
+	return -1;
+}
+
+/**
+  * @brief  Deja una palabra (con su CRC) como respuesta a la próxima lectura.
+  */
+static void sim_reply(sim_sensor_t *s, uint16_t word)
+{
+	s->reg[0] = word >> 8;
+	s->reg[1] = word & 0xFF;
+	s->reg[2] = sim_crc8(s->reg, 2);
+	s->reg_valid = true;
+	s->status &= ~STATUS_CMD_FAIL;
+}
+
+/**
+  * @brief  Estado de encendido o soft reset: límites de fábrica y reset marcado en el registro de estado.
+  */
+static void sim_defaults(sim_sensor_t *s)
+{
+	for (int i = 0; i < 4; i++) s->limits[i] = limit_default[i];
+	s->status = STATUS_ALERT_PENDING | STATUS_RESET;
+	s->temp_alert = s->hum_alert = false;
+	if (s->alert_level && s->alert_fn != NULL) s->alert_fn(s->addr, false);
+	s->alert_level = false;
+}
+
+/**
+  * @brief  Timer de cada medición periódica: la hace, evalúa la alerta y programa la siguiente.
+  */
+static void sim_periodic_timer(void *ctx)
+{
+	sim_sensor_t *s = ctx;
+	if (!s->periodic) return;
+
+	sim_periodic_update(s);
+
+	uint64_t first = s->periodic_start_ns + meas_ns[s->periodic_rep];
+	halshim_timer(first + (uint64_t)(s->periodic_last + 1) * s->periodic_period_ns, sim_periodic_timer, s);
+}
+
+/**
+  * @brief  Hace la última medición periódica terminada si todavía no se hizo (las intermedias que
+  * 		el reloj salteó se pierden, como en el sensor) y la compara con los límites.
+  */
+static void sim_periodic_update(sim_sensor_t *s)
+{
+	uint64_t now = vclock_now_ns();
+	uint64_t first = s->periodic_start_ns + meas_ns[s->periodic_rep];
+
+	if (!s->periodic || now < first) return;
+
+	int64_t last = (int64_t)((now - first) / s->periodic_period_ns);
+	if (last <= s->periodic_last) return;
+
+	s->periodic_last = last;
+	sim_measure(s, first + (uint64_t)last * s->periodic_period_ns, s->periodic_rep);
+	sim_alert_update(s);
+}
+
+/**
+  * @brief  Compara la última medición con los límites, con los bits que guarda cada límite
+  * 		(9 de T y 7 de HR), y actualiza el pin ALERT y el registro de estado.
+  */
+static void sim_alert_update(sim_sensor_t *s)
+{
+	uint16_t t = ((s->frame[0] << 8) | s->frame[1]) >> 7;
+	uint16_t h = s->frame[3] >> 1;
+	const uint16_t *lim = s->limits; // high set, high clear, low clear, low set
+
+	if (t > (lim[0] & 0x1FF) || t < (lim[3] & 0x1FF)) s->temp_alert = true;
+	else if (t <= (lim[1] & 0x1FF) && t >= (lim[2] & 0x1FF)) s->temp_alert = false;
+
+	if (h > (lim[0] >> 9) || h < (lim[3] >> 9)) s->hum_alert = true;
+	else if (h <= (lim[1] >> 9) && h >= (lim[2] >> 9)) s->hum_alert = false;
+
+	if (s->temp_alert) s->status |= STATUS_ALERT_PENDING | STATUS_TEMP_ALERT;
+	if (s->hum_alert) s->status |= STATUS_ALERT_PENDING | STATUS_HUM_ALERT;
+
+	bool level = s->temp_alert || s->hum_alert;
+	if (level == s->alert_level) return;
+
+	s->alert_level = level;
+	if (level) stats.alerts++;
+	if (s->alert_fn != NULL) s->alert_fn(s->addr, level);
+}
+
+/**
+  * @brief  Arma la trama (T, CRC, HR, CRC) con la señal en el instante en que terminó la medición.
+  */
+static void sim_measure(sim_sensor_t *s, uint64_t t_ns, sim_rep_t rep)
+{
+	double temp, hum;
+
+	sim_signal(s, t_ns / 1e9, rep, &temp, &hum);
+	if (temp < -45.0) temp = -45.0;
+	if (temp > 130.0) temp = 130.0;
+	if (hum < 0.0) hum = 0.0;
+	if (hum > 100.0) hum = 100.0;
+
+	uint16_t raw_t = (uint16_t)((temp + 45.0) / 175.0 * 65535.0 + 0.5);
+	uint16_t raw_h = (uint16_t)(hum / 100.0 * 65535.0 + 0.5);
+
+	s->frame[0] = raw_t >> 8;
+	s->frame[1] = raw_t & 0xFF;
+	s->frame[2] = sim_crc8(&s->frame[0], 2);
+	s->frame[3] = raw_h >> 8;
+	s->frame[4] = raw_h & 0xFF;
+	s->frame[5] = sim_crc8(&s->frame[3], 2);
+	s->data_valid = true;
+	stats.measurements++;
+}
+
+/**
+  * @brief  Valor de la señal: traza interpolada (si hay) u onda configurada, más el ruido de la repetibilidad.
+  */
+static void sim_signal(sim_sensor_t *s, double t, sim_rep_t rep, double *temp, double *hum)
+{
+	double noise_scale = (double)(1 << rep);
+
+	if (trace_len >= 2)
+	{
+		double span = trace[trace_len - 1].t - trace[0].t;
+		double x = trace[0].t + fmod(t, span);
+		size_t lo = 0, hi = trace_len - 1;
+
+		while (hi - lo > 1)
+		{
+			size_t mid = (lo + hi) / 2;
+			if (trace[mid].t <= x) lo = mid;
+			else hi = mid;
+		}
+
+		double k = (x - trace[lo].t) / (trace[hi].t - trace[lo].t);
+		*temp = trace[lo].temp + k * (trace[hi].temp - trace[lo].temp);
+		*hum = trace[lo].hum + k * (trace[hi].hum - trace[lo].hum);
+	}
+	else
+	{
+		double w = s->cfg.period_s > 0 ? sin(2.0 * M_PI * t / s->cfg.period_s) : 0.0;
+		*temp = s->cfg.temp_mean + s->cfg.temp_amplitude * w;
+		*hum = s->cfg.hum_mean - s->cfg.hum_amplitude * w;
+	}
+
+	*temp += s->cfg.temp_noise * noise_scale * sim_gauss(s);
+	*hum += s->cfg.hum_noise * noise_scale * sim_gauss(s);
+}
+
+/**
+  * @brief  Decide si se inyecta un NACK en esta transferencia.
+  */
+static bool sim_nack(sim_sensor_t *s)
+{
+	if (s->cfg.nack_rate <= 0 || sim_uniform(s) >= s->cfg.nack_rate) return false;
+	stats.injected_nacks++;
+	return true;
+}
+
+/**
+  * @brief  Uniforme en [0, 1) con xorshift64*.
+  */
+static double sim_uniform(sim_sensor_t *s)
+{
+	s->rng_state ^= s->rng_state >> 12;
+	s->rng_state ^= s->rng_state << 25;
+	s->rng_state ^= s->rng_state >> 27;
+	return ((s->rng_state * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+  * @brief  Normal estándar (Box-Muller).
+  */
+static double sim_gauss(sim_sensor_t *s)
+{
+	double u = sim_uniform(s);
+	double v = sim_uniform(s);
+	return sqrt(-2.0 * log(1.0 - u)) * cos(2.0 * M_PI * v);
+}
+
+/**
+  * @brief  CRC-8 de Sensirion: polinomio 0x31, valor inicial 0xFF.
+  */
+static uint8_t sim_crc8(const uint8_t *data, uint8_t len)
+{
+	uint8_t crc = 0xFF;
+	for (uint8_t i = 0; i < len; i++)
+	{
+		crc ^= data[i];
+		for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+	}
+	return crc;
+}
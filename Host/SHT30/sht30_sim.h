@@ -0,0 +1,59 @@
+/*
+ *	@file sht30_sim.h
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Simulador de SHT30 (.h)
+ *  @brief Definicion de funciones del modelo de SHT30 conectado al I2C de la HAL simulada
+ */
+
+#ifndef HOST_SHT30_SHT30_SIM_H_
+#define HOST_SHT30_SHT30_SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SHT30SIM_ADDR		0x44	// dirección de 7 bits (ADDR a GND)
+#define SHT30SIM_ADDR_ALT	0x45	// ADDR a VDD
+#define SHT30SIM_MAX_SENSORS	4
+
+/*
+ * Señal medida (si no hay traza cargada): media + amplitud * sin(2π t / período) + ruido gaussiano.
+ * El ruido configurado es el de repetibilidad alta; se duplica en media y se cuadruplica en baja.
+ * Las fallas se inyectan por transferencia con la probabilidad indicada (0 a 1).
+ */
+typedef struct
+{
+  double temp_mean, temp_amplitude;		// °C
+  double hum_mean, hum_amplitude;		// %HR (en contrafase con la temperatura)
+  double period_s;
+  double temp_noise, hum_noise;			// desvío estándar
+  double nack_rate;						// transferencias (escritura o lectura) respondidas con NACK
+  double crc_rate;						// lecturas con un bit invertido en la trama (falla de CRC)
+  double hang_rate;						// lecturas en que el sensor cuelga el bus reteniendo SDA
+  uint32_t seed;						// semilla del ruido y de las fallas (ejecución reproducible)
+} sht30sim_config_t;
+
+typedef struct
+{
+  uint32_t commands;
+  uint32_t unknown_commands;
+  uint32_t measurements;
+  uint32_t reads;						// tramas de medición entregadas
+  uint32_t nacks;						// NACK por estado del sensor (ocupado, sin datos, comando no admitido)
+  uint32_t injected_nacks;
+  uint32_t crc_faults;
+  uint32_t hangs;						// bus colgado (se libera con pulsos de SCL)
+  uint32_t limit_writes;				// límites de alerta escritos
+  uint32_t alerts;						// flancos ascendentes del pin ALERT
+  uint64_t stretch_ns;					// tiempo con SCL retenido por clock stretching
+} sht30sim_stats_t;
+
+// sht30_sim.c
+void sht30sim_default_config(sht30sim_config_t *config);
+bool sht30sim_attach(uint8_t addr, const sht30sim_config_t *config);
+bool sht30sim_connect_alert(uint8_t addr, void (*fn)(uint8_t addr, bool level));
+bool sht30sim_load_trace(const char *path);
+const sht30sim_stats_t *sht30sim_get_stats(void);
+
+#endif /* HOST_SHT30_SHT30_SIM_H_ */
@@ -0,0 +1,89 @@
+/*
+ *	@file benchutil.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Utilidades de los benchmarks de host
+ *  @brief Carga de trazas CSV, generador pseudoaleatorio con semilla fija y reloj monotónico
+ *
+ *  El generador es un LCG con semilla fija compartido por todo el proceso, de modo que las series
+ *  sintéticas de cada benchmark son las mismas en cada ejecución.
+ */
+
+#include "benchutil.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static uint32_t rng = 12345;
+
+/**
+  * @brief  Carga una traza CSV con líneas "t_s,temp,hum" (también separadas por ';' o espacios).
+  * @note   Las líneas que no empiezan con un número (encabezado, comentarios) se ignoran.
+  * @param  path: Archivo a leer.
+  * @param  points: Devuelve los puntos leídos, en el orden del archivo (se liberan con free).
+  * @retval Cantidad de puntos, 0 si no se pudo leer el archivo.
+  */
+size_t bench_load_trace(const char *path, trace_point_t **points)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	size_t len = 0, cap = 0;
+
+	*points = NULL;
+	if (f == NULL) return 0;
+
+	while (fgets(line, sizeof(line), f))
+	{
+		trace_point_t p;
+		if (sscanf(line, "%lf%*[,; \t]%lf%*[,; \t]%lf", &p.t, &p.temp, &p.hum) != 3) continue;
+
+		if (len == cap)
+		{
+			cap = cap ? 2 * cap : 4096;
+			trace_point_t *grown = realloc(*points, cap * sizeof(**points));
+			if (grown == NULL) break;
+			*points = grown;
+		}
+		(*points)[len++] = p;
+	}
+	fclose(f);
+
+	return len;
+}
+
+/**
+  * @brief  Siguiente valor del generador (24 bits).
+  */
+uint32_t bench_rand32(void)
+{
+	rng = rng * 1103515245 + 12345;
+	return rng >> 8;
+}
+
+/**
+  * @brief  Valor con distribución normal estándar (Box-Muller sobre bench_rand32).
+  */
+double bench_gauss(void)
+{
+	double u1, u2;
+	do
+	{
+		u1 = bench_rand32() / 16777216.0;
+	} while (u1 == 0);
+	u2 = bench_rand32() / 16777216.0;
+
+	return sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+/**
+  * @brief  Tiempo monotónico en segundos, para medir el costo de un tramo.
+  */
+double bench_now_s(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
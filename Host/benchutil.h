@@ -0,0 +1,27 @@
+/*
+ *	@file benchutil.h
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Utilidades de los benchmarks de host (.h)
+ *  @brief Definicion de funciones comunes a los benchmarks y al simulador: trazas CSV, generador con semilla y reloj
+ */
+
+#ifndef HOST_BENCHUTIL_H_
+#define HOST_BENCHUTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+	double t, temp, hum;		// s, °C, %HR
+} trace_point_t;
+
+// benchutil.c
+size_t bench_load_trace(const char *path, trace_point_t **points);
+uint32_t bench_rand32(void);
+double bench_gauss(void);
+double bench_now_s(void);
+
+#endif /* HOST_BENCHUTIL_H_ */
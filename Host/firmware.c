@@ -0,0 +1,379 @@
+/*
+ *	@file firmware.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Firmware completo en el host
+ *  @brief Ejecuta Core/Src/main.c (compilado como firmware_main) contra la HAL simulada
+ *
+ *  Uso:
+ *    firmware [imagen] [opciones]
+ *
+ *  Opciones:
+ *    -t <s>            termina luego de s segundos de tiempo virtual (por defecto 3600)
+ *    -q <ms>           quantum del salto de reloj en superloop ocioso (por defecto 1)
+ *    -p <s>[:<ms>]     pulsa B1 a los s segundos durante ms milisegundos (por defecto 100; repetible)
+ *    -b <bloques>      tamaño de la imagen (por defecto 8192 = 4 MB)
+ *    --sdsc            simula una tarjeta SDSC
+ *    --sht-trace <csv> valores del SHT30 desde una traza t_s,temp,hum (por defecto onda diaria)
+ *    --sht-nack <p>    probabilidad de NACK por transferencia I2C del SHT30
+ *    --sht-crc <p>     probabilidad de falla de CRC por lectura del SHT30
+ *    --sht-hang <p>    probabilidad de que el SHT30 cuelgue el bus en una lectura
+ *    --sht-seed <n>    semilla del ruido y de las fallas del SHT30
+ *    --sht-count <n>   sensores SHT30 en el bus, desde 0x44 (por defecto 2: 0x44 y 0x45)
+ *    --log-csv <csv>   al terminar exporta las muestras del log de la imagen como t_s,temp,hum
+ *    --ts              antepone el tiempo virtual a cada línea de la UART
+ *    --quiet           descarta la salida de la UART (para medir o perfilar)
+ *
+ *  Los pines ALERT de los sensores van juntos (OR) a PA8, la entrada EXTI del firmware.
+ *
+ *  Sin imagen (o con "-") el firmware arranca sin tarjeta. Al terminar se imprime en stderr el
+ *  tiempo virtual y real y los contadores de los buses; con imagen, además, la estadística que
+ *  resulta de combinar las parciales de cada bloque del log contra la del acumulado guardado.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "API_sdlog.h"
+#include "API_snapshot.h"
+#include "API_stats.h"
+#include "hal_shim.h"
+#include "main.h"
+#include "sd_sim.h"
+#include "sht30_sim.h"
+#include "vclock.h"
+
+int firmware_main(void);
+
+static struct timespec wall_start;
+static uint32_t alert_levels;	// bit por sensor con ALERT en alto
+static const char *log_csv;		// --log-csv
+
+static void alert_pin(uint8_t addr, bool level);
+
+static void summary(void);
+static void log_stats(void);
+static bool load_totals(Temp_data *total);
+static void replay_totals(Temp_data *total, uint32_t head_seq);
+static void export_log(const char *path);
+static const uint8_t *find_block(uint32_t seq);
+static double wall_seconds(void);
+static void usage(void);
+
+
+int main(int argc, char **argv)
+{
+	sdsim_config_t config;
+	sht30sim_config_t sht_config;
+	const char *image = NULL;
+	const char *trace = NULL;
+	uint32_t blocks = 8192;
+	uint64_t run_s = 3600;
+	uint8_t sht_count = 2;
+	bool quiet = false, timestamps = false;
+
+	sdsim_default_config(&config);
+	sht30sim_default_config(&sht_config);
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--sdsc")) config.sdhc = false;
+		else if (!strcmp(argv[i], "--ts")) timestamps = true;
+		else if (!strcmp(argv[i], "--quiet")) quiet = true;
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc) run_s = strtoull(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-q") && i + 1 < argc) halshim_set_quantum_ms(strtoul(argv[++i], NULL, 0));
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc) blocks = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "--sht-trace") && i + 1 < argc) trace = argv[++i];
+		else if (!strcmp(argv[i], "--sht-nack") && i + 1 < argc) sht_config.nack_rate = strtod(argv[++i], NULL);
+		else if (!strcmp(argv[i], "--sht-crc") && i + 1 < argc) sht_config.crc_rate = strtod(argv[++i], NULL);
+		else if (!strcmp(argv[i], "--sht-hang") && i + 1 < argc) sht_config.hang_rate = strtod(argv[++i], NULL);
+		else if (!strcmp(argv[i], "--sht-seed") && i + 1 < argc) sht_config.seed = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "--sht-count") && i + 1 < argc) sht_count = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "--log-csv") && i + 1 < argc) log_csv = argv[++i];
+		else if (!strcmp(argv[i], "-p") && i + 1 < argc)
+		{
+			char *end;
+			double at_s = strtod(argv[++i], &end);
+			uint32_t ms = (*end == ':') ? strtoul(end + 1, NULL, 0) : 100;
+			if (!halshim_button_press((uint64_t)(at_s * 1000), ms))
+			{
+				fprintf(stderr, "firmware: demasiadas pulsaciones\n");
+				return 2;
+			}
+		}
+		else if (argv[i][0] != '-' || !strcmp(argv[i], "-")) image = argv[i];
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+
+	if (image != NULL && strcmp(image, "-") != 0 && !sdsim_open(image, blocks, &config))
+	{
+		fprintf(stderr, "firmware: no se pudo abrir la imagen %s\n", image);
+		return 1;
+	}
+
+	if (trace != NULL && !sht30sim_load_trace(trace))
+	{
+		fprintf(stderr, "firmware: no se pudo leer la traza %s\n", trace);
+		return 1;
+	}
+	for (uint8_t i = 0; i < sht_count; i++)
+	{
+		if (!sht30sim_attach(SHT30SIM_ADDR + i, &sht_config))
+		{
+			fprintf(stderr, "firmware: no se pudo conectar el SHT30 0x%02X\n", SHT30SIM_ADDR + i);
+			return 1;
+		}
+		sht30sim_connect_alert(SHT30SIM_ADDR + i, alert_pin);
+		sht_config.seed++; // ruido independiente en cada sensor
+	}
+	halshim_uart_config(quiet, timestamps);
+	halshim_set_run_time_ms(run_s * 1000);
+
+	clock_gettime(CLOCK_MONOTONIC, &wall_start);
+	atexit(summary);
+
+	return firmware_main();
+}
+
+/**
+  * @brief  ALERT de un sensor: PA8 queda en alto mientras alguno de los sensores tenga la alerta activa.
+  */
+static void alert_pin(uint8_t addr, bool level)
+{
+	uint32_t bit = 1U << (addr - SHT30SIM_ADDR);
+
+	if (level) alert_levels |= bit;
+	else alert_levels &= ~bit;
+	halshim_gpio_input(GPIOA, GPIO_PIN_8, alert_levels != 0);
+}
+
+/**
+  * @brief  Resumen al terminar (por tiempo cumplido o por Error_Handler).
+  */
+static void summary(void)
+{
+	const halshim_stats_t *hal = halshim_get_stats();
+	const sdsim_stats_t *sd = sdsim_get_stats();
+	const sht30sim_stats_t *sht = sht30sim_get_stats();
+	double virt = vclock_now_ns() / 1e9;
+	double wall = wall_seconds();
+
+	fflush(stdout);
+	fprintf(stderr, "\n--- %.1f s virtuales en %.3f s reales (x%.0f)\n", virt, wall, wall > 0 ? virt / wall : 0);
+	fprintf(stderr, "superloop: %llu consultas de tick, %llu saltos ociosos (%.1f%% del tiempo)\n",
+			(unsigned long long)hal->tick_calls, (unsigned long long)hal->idle_skips,
+			virt > 0 ? hal->skipped_ns / 1e7 / virt : 0);
+	fprintf(stderr, "núcleo: %llu sleeps (%.1f%% del tiempo dormido), %u interrupciones EXTI\n",
+			(unsigned long long)hal->sleeps, virt > 0 ? hal->sleep_ns / 1e7 / virt : 0, hal->exti_events);
+	fprintf(stderr, "uart: %llu bytes, led: %u destellos\n", (unsigned long long)hal->uart_bytes, hal->led_toggles);
+	fprintf(stderr, "i2c: %u transferencias, %u NACK, %u colgadas, %u resets\n",
+			hal->i2c_transfers, hal->i2c_nacks, hal->i2c_stalls, hal->i2c_resets);
+	fprintf(stderr, "sht30: %u comandos, %u mediciones, %u leídas, %u NACK (+%u inyectados), %u CRC inyectados, %u bus colgado, %.1f ms de stretching\n",
+			sht->commands, sht->measurements, sht->reads, sht->nacks, sht->injected_nacks, sht->crc_faults, sht->hangs, sht->stretch_ns / 1e6);
+	fprintf(stderr, "sht30: %u límites escritos, %u alertas\n", sht->limit_writes, sht->alerts);
+	fprintf(stderr, "spi: %llu bytes, %u comandos, %u bloques leídos, %u escritos, %u borrados, %u errores\n",
+			(unsigned long long)hal->spi_bytes, sd->commands, sd->blocks_read, sd->blocks_written, sd->erases, sd->errors);
+	log_stats();
+	if (log_csv != NULL) export_log(log_csv);
+
+	sdsim_close();
+}
+
+/**
+  * @brief  Combina las estadísticas parciales (block_T/block_H) de los bloques del log en la imagen y
+  * 		las compara con las totales (stats_T/stats_H) del acumulado guardado en la imagen.
+  * @note	Recorre hacia atrás desde el bloque de mayor secuencia mientras las secuencias sean consecutivas,
+  * 		sin decodificar ninguna muestra, como una consulta sobre un rango del historial. Al acumulado se le
+  * 		suman antes las muestras del log posteriores a su posición, como al arrancar el firmware. Si el
+  * 		log dio la vuelta desde el último reset las parciales cubren solo los bloques que quedan.
+  */
+static void log_stats(void)
+{
+	logHeader_t hdr;
+	const uint8_t *head = NULL;
+	uint32_t head_seq = 0;
+
+	for (uint32_t b = 0; b < sdsim_blocks(); b++)
+	{
+		memcpy(&hdr, sdsim_block(b), sizeof(hdr));
+		if (hdr.magic != SDLOG_MAGIC || hdr.state_len != sizeof(Block_data)) continue;
+		if (head == NULL || hdr.seq > head_seq)
+		{
+			head = sdsim_block(b);
+			head_seq = hdr.seq;
+		}
+	}
+
+	Temp_data total;
+	if (head == NULL || !load_totals(&total)) return;
+	replay_totals(&total, head_seq);
+
+	Block_data part;
+	stats_t acc[2];
+	uint32_t blocks = 0;
+
+	statsInit(&acc[0]);
+	statsInit(&acc[1]);
+
+	const uint8_t *blk = head;
+	while (blk != NULL)
+	{
+		memcpy(&part, blk + sizeof(logHeader_t), sizeof(part));
+		statsMerge(&part.block_T, &acc[0]); // el bloque anterior va primero: conserva el primer extremo ante empates
+		statsMerge(&part.block_H, &acc[1]);
+		acc[0] = part.block_T;
+		acc[1] = part.block_H;
+		blocks++;
+		blk = (blocks <= head_seq) ? find_block(head_seq - blocks) : NULL;
+	}
+
+	const stats_t *tot[2] = { &total.stats_T, &total.stats_H };
+	const char *name[2] = { "T", "HR" };
+
+	for (int c = 0; c < 2; c++)
+	{
+		double var = statsVariance(tot[c]);
+		bool same = acc[c].count == tot[c]->count && acc[c].min == tot[c]->min && acc[c].max == tot[c]->max &&
+				acc[c].min_time == tot[c]->min_time && acc[c].max_time == tot[c]->max_time;
+
+		fprintf(stderr, "log %s: %u bloques combinados, %u/%u muestras (%.1f por bloque), media %+.1e ticks, varianza %+.1e relativa, extremos %s\n",
+				name[c], blocks, acc[c].count, tot[c]->count, (double)acc[c].count / blocks, acc[c].mean - tot[c]->mean,
+				var > 0 ? statsVariance(&acc[c]) / var - 1 : 0, same ? "iguales" : "distintos");
+	}
+}
+
+/**
+  * @brief  Lee de la imagen la copia más reciente del acumulado (API_snapshot).
+  * @retval true si hay una copia con el tamaño de Temp_data.
+  */
+static bool load_totals(Temp_data *total)
+{
+	snapshotHeader_t hdr;
+	const uint8_t *best = NULL;
+	uint32_t best_seq = 0;
+
+	for (uint32_t b = 0; b < sdsim_blocks(); b++)
+	{
+		memcpy(&hdr, sdsim_block(b), sizeof(hdr));
+		if (hdr.magic != SNAPSHOT_MAGIC || hdr.len != sizeof(Temp_data)) continue;
+		if (best == NULL || hdr.seq > best_seq)
+		{
+			best = sdsim_block(b);
+			best_seq = hdr.seq;
+		}
+	}
+	if (best == NULL) return false;
+
+	memcpy(total, best + sizeof(snapshotHeader_t), sizeof(*total));
+	return true;
+}
+
+/**
+  * @brief  Suma al acumulado las muestras del log posteriores a su posición, hasta el bloque head_seq.
+  */
+static void replay_totals(Temp_data *total, uint32_t head_seq)
+{
+	logSample_t batch[64];
+	uint16_t first = total->log_count;
+
+	for (uint32_t seq = total->log_seq; seq <= head_seq; seq++, first = 0)
+	{
+		const uint8_t *blk = find_block(seq);
+		uint16_t n;
+
+		while (blk != NULL && (n = sdlogDecodeBlock(blk, first, batch, 64)) > 0)
+		{
+			for (uint16_t i = 0; i < n; i++)
+			{
+				statsPush(&total->stats_T, batch[i].raw_temp, batch[i].time);
+				statsPush(&total->stats_H, batch[i].raw_hum, batch[i].time);
+			}
+			first += n;
+		}
+	}
+}
+
+/**
+  * @brief  Exporta las muestras del log de la imagen, de la más vieja a la más nueva, en el formato de
+  * 		sht30sim_load_trace (t_s,temp,hum). Con 3 decimales los ticks crudos se recuperan exactos.
+  */
+static void export_log(const char *path)
+{
+	logHeader_t hdr;
+	uint32_t head_seq = 0, first_seq;
+	bool found = false;
+
+	for (uint32_t b = 0; b < sdsim_blocks(); b++)
+	{
+		memcpy(&hdr, sdsim_block(b), sizeof(hdr));
+		if (hdr.magic != SDLOG_MAGIC || hdr.state_len != sizeof(Block_data)) continue;
+		if (!found || hdr.seq > head_seq) head_seq = hdr.seq;
+		found = true;
+	}
+	if (!found) return;
+
+	for (first_seq = head_seq; first_seq > 0 && find_block(first_seq - 1) != NULL; first_seq--);
+
+	FILE *f = fopen(path, "w");
+	if (f == NULL)
+	{
+		fprintf(stderr, "firmware: no se pudo crear %s\n", path);
+		return;
+	}
+
+	logSample_t batch[64];
+	uint32_t samples = 0;
+
+	for (uint32_t seq = first_seq; seq <= head_seq; seq++)
+	{
+		const uint8_t *blk = find_block(seq);
+		uint16_t first = 0, n;
+
+		while ((n = sdlogDecodeBlock(blk, first, batch, 64)) > 0)
+		{
+			for (uint16_t i = 0; i < n; i++) fprintf(f, "%lu,%.3f,%.3f\n", (unsigned long)batch[i].time, batch[i].temp, batch[i].hum);
+			first += n;
+			samples += n;
+		}
+	}
+	fclose(f);
+	fprintf(stderr, "log: %lu muestras de %lu bloques exportadas a %s\n",
+			(unsigned long)samples, (unsigned long)(head_seq - first_seq + 1), path);
+}
+
+/**
+  * @brief  Busca en la imagen el bloque del log con el número de secuencia dado.
+  * @retval Puntero al bloque, o NULL si no está.
+  */
+static const uint8_t *find_block(uint32_t seq)
+{
+	logHeader_t hdr;
+
+	for (uint32_t b = 0; b < sdsim_blocks(); b++)
+	{
+		memcpy(&hdr, sdsim_block(b), sizeof(hdr));
+		if (hdr.magic == SDLOG_MAGIC && hdr.state_len == sizeof(Block_data) && hdr.seq == seq) return sdsim_block(b);
+	}
+	return NULL;
+}
+
+static double wall_seconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - wall_start.tv_sec) + (now.tv_nsec - wall_start.tv_nsec) / 1e9;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "uso: firmware [imagen|-] [-t s] [-q ms] [-p s[:ms]]... [-b bloques] [--sdsc] [--ts] [--quiet]\n"
+			"               [--sht-trace csv] [--sht-nack p] [--sht-crc p] [--sht-hang p] [--sht-seed n] [--sht-count n]\n"
+			"               [--log-csv csv]\n");
+}
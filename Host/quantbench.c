@@ -0,0 +1,227 @@
+/*
+ *	@file quantbench.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Exactitud y costo de API_quantile
+ *  @brief Compara los percentiles P² de API_quantile con los exactos (ordenando) sobre trazas
+ *
+ *  Uso:
+ *    quantbench [-n <muestras>] [traza.csv]...      (por defecto 1000000)
+ *
+ *  Las trazas CSV tienen el formato de sht30sim_load_trace (t_s,temp,hum, en °C y %HR); cada una
+ *  aporta una serie de temperatura y una de humedad, convertidas a ticks. Sin trazas se usan
+ *  series sintéticas de -n muestras cada 5 s:
+ *    - diaria:   onda diaria de 18 a 26 °C con ruido gaussiano
+ *    - puerta:   22 °C con la puerta abierta 10 min tres veces por día (6 °C menos)
+ *    - escalon:  20 °C la primera mitad y 24 °C la segunda
+ *    - humedad:  onda diaria de 40 a 60 %HR con ruido y picos de 90 %HR
+ *  Para cada serie se informa la estimación de p5/p50/p95 contra el exacto (rango más cercano),
+ *  el error en ticks, en °C o %HR y en rango (fracción de muestras por debajo de la estimación menos p),
+ *  y el costo por muestra de quantilePush y de ordenar la serie. Termina con error si alguna estimación
+ *  está a más de 0,01 en rango y a más de 20 ticks del exacto.
+ *  Los dos errores miden cosas distintas: en el escalón p50 cae en el hueco entre los dos niveles, donde
+ *  cualquier valor deja la mitad de las muestras de cada lado (error de rango 0) aunque esté a 2,5 °C del
+ *  exacto; en un grupo angosto de valores unos pocos ticks mueven mucho el rango.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "API_quantile.h"
+#include "benchutil.h"
+
+#define RANK_TOL		0.01
+#define TICK_TOL		20		// ~0,05 °C o 0,03 %HR: en un grupo denso de valores el error de rango crece aunque el valor sea bueno
+#define SAMPLE_PERIOD	5		// s
+#define DAY				(86400 / SAMPLE_PERIOD)
+
+typedef struct{
+	char name[64];
+	uint16_t *v;
+	uint32_t n;
+	double span;			// °C o %HR de 0 a 65535 ticks: 175 para temperatura, 100 para humedad
+} series_t;
+
+static bool load_csv(const char *path, series_t *temp, series_t *hum);
+static void synth(series_t *s, const char *name, uint32_t n, int kind);
+static bool run(const series_t *s);
+static uint32_t rank_below(const uint16_t *sorted, uint32_t n, float x);
+static int cmp_u16(const void *a, const void *b);
+static uint16_t to_ticks(double value, double offset, double span);
+
+
+int main(int argc, char **argv)
+{
+	uint32_t n = 1000000;
+	series_t series[32];
+	int count = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) n = strtoul(argv[++i], NULL, 0);
+		else if (argv[i][0] == '-')
+		{
+			fprintf(stderr, "uso: quantbench [-n muestras] [traza.csv]...\n");
+			return 2;
+		}
+		else if (count + 2 <= (int)(sizeof(series) / sizeof(series[0])))
+		{
+			if (!load_csv(argv[i], &series[count], &series[count + 1]))
+			{
+				fprintf(stderr, "quantbench: no se pudo leer la traza %s\n", argv[i]);
+				return 1;
+			}
+			count += 2;
+		}
+	}
+	if (count == 0)
+	{
+		synth(&series[count++], "diaria", n, 0);
+		synth(&series[count++], "puerta", n, 1);
+		synth(&series[count++], "escalon", n, 2);
+		synth(&series[count++], "humedad", n, 3);
+	}
+
+	printf("%-22s %9s %4s %10s %10s %9s %9s %9s %10s %10s\n",
+			"serie", "muestras", "p", "exacto", "P2", "err tick", "err unid", "err rango", "ns push", "ns orden");
+
+	bool ok = true;
+	for (int i = 0; i < count; i++)
+	{
+		ok = run(&series[i]) && ok;
+		free(series[i].v);
+	}
+
+	if (!ok) printf("quantbench: error mayor que %.2f en rango y %d ticks\n", RANK_TOL, TICK_TOL);
+	return ok ? 0 : 1;
+}
+
+/**
+  * @brief  Estima los percentiles de una serie, los compara con los exactos e imprime una línea por percentil.
+  * @retval true si todos los errores de rango están dentro de la tolerancia.
+  */
+static bool run(const series_t *s)
+{
+	quantile_t q;
+	uint16_t *sorted = malloc(s->n * sizeof(uint16_t));
+	bool ok = true;
+
+	if (s->n == 0 || sorted == NULL)
+	{
+		free(sorted);
+		return s->n == 0;
+	}
+
+	quantileInit(&q);
+	double t0 = bench_now_s();
+	for (uint32_t i = 0; i < s->n; i++) quantilePush(&q, s->v[i]);
+	double t_push = bench_now_s() - t0;
+
+	memcpy(sorted, s->v, s->n * sizeof(uint16_t));
+	t0 = bench_now_s();
+	qsort(sorted, s->n, sizeof(uint16_t), cmp_u16);
+	double t_sort = bench_now_s() - t0;
+
+	for (uint8_t k = 0; k < QUANTILE_COUNT; k++)
+	{
+		double p = QUANTILE_P[k];
+		uint16_t exact = sorted[(uint32_t)(p * (s->n - 1) + 0.5)];
+		float est = quantileGet(&q, k);
+		double rank = (double)rank_below(sorted, s->n, est) / s->n - p;
+
+		if (fabs(rank) > RANK_TOL && fabs(est - exact) > TICK_TOL) ok = false;
+		printf("%-22s %9u %4.0f %10u %10.1f %+9.1f %+9.3f %+9.4f", k == 0 ? s->name : "", s->n, p * 100, exact, est,
+				est - exact, (est - exact) * s->span / 65535.0, rank);
+		if (k == 0) printf(" %10.2f %10.2f\n", t_push * 1e9 / s->n, t_sort * 1e9 / s->n);
+		else printf("\n");
+	}
+
+	free(sorted);
+	return ok;
+}
+
+/**
+  * @brief  Cantidad de muestras menores que x más la mitad de las iguales (rango medio de los empates).
+  */
+static uint32_t rank_below(const uint16_t *sorted, uint32_t n, float x)
+{
+	uint32_t lo = 0, hi = n;
+	while (lo < hi)
+	{
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (sorted[mid] < x) lo = mid + 1;
+		else hi = mid;
+	}
+
+	uint32_t eq = lo;
+	while (eq < n && sorted[eq] <= x) eq++;
+	return lo + (eq - lo) / 2;
+}
+
+/* ====================  Series  ======================================== */
+
+static bool load_csv(const char *path, series_t *temp, series_t *hum)
+{
+	trace_point_t *points;
+	uint32_t n = (uint32_t)bench_load_trace(path, &points);
+
+	memset(temp, 0, sizeof(*temp));
+	memset(hum, 0, sizeof(*hum));
+	snprintf(temp->name, sizeof(temp->name), "%.56s:T", path);
+	snprintf(hum->name, sizeof(hum->name), "%.56s:HR", path);
+	temp->span = 175.0;
+	hum->span = 100.0;
+	temp->v = malloc(n * sizeof(uint16_t));
+	hum->v = malloc(n * sizeof(uint16_t));
+
+	for (uint32_t i = 0; i < n && temp->v != NULL && hum->v != NULL; i++)
+	{
+		temp->v[i] = to_ticks(points[i].temp, -45.0, 175.0);
+		hum->v[i] = to_ticks(points[i].hum, 0.0, 100.0);
+	}
+	temp->n = hum->n = n;
+	free(points);
+	return n > 0 && temp->v != NULL && hum->v != NULL;
+}
+
+static void synth(series_t *s, const char *name, uint32_t n, int kind)
+{
+	snprintf(s->name, sizeof(s->name), "%s", name);
+	s->n = n;
+	s->span = (kind == 3) ? 100.0 : 175.0;
+	s->v = malloc(n * sizeof(uint16_t));
+
+	for (uint32_t i = 0; i < n && s->v != NULL; i++)
+	{
+		double day = 2 * M_PI * (i % DAY) / DAY;
+		double v;
+
+		switch (kind)
+		{
+			case 0:  v = 22.0 + 4.0 * sin(day) + 0.1 * bench_gauss(); break;
+			case 1:  v = 22.0 + 0.1 * bench_gauss() - ((i % (DAY / 3)) < 600 / SAMPLE_PERIOD ? 6.0 : 0.0); break;
+			case 2:  v = (i < n / 2 ? 20.0 : 24.0) + 0.1 * bench_gauss(); break;
+			default:
+				v = 50.0 + 10.0 * sin(day) + 0.5 * bench_gauss() + ((i % 1000) == 0 ? 40.0 : 0.0);
+				s->v[i] = to_ticks(v, 0.0, 100.0);
+				continue;
+		}
+		s->v[i] = to_ticks(v, -45.0, 175.0);
+	}
+}
+
+static uint16_t to_ticks(double value, double offset, double span)
+{
+	double t = (value - offset) * 65535.0 / span + 0.5;
+	return (t < 0) ? 0 : (t > 65535) ? 65535 : (uint16_t)t;
+}
+
+static int cmp_u16(const void *a, const void *b)
+{
+	return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
@@ -0,0 +1,418 @@
+/*
+ *	@file recordbench.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Ida y vuelta de API_record y API_gorilla
+ *  @brief Codifica series con recordEncode o gorillaEncode empaquetándolas en bloques como API_sdlog y las decodifica
+ *
+ *  Uso:
+ *    recordbench [-n <muestras>] [-s <bytes de estado>] [traza.csv]...
+ *        (por defecto 1000000 muestras y el estado por bloque del firmware, sizeof(Block_data))
+ *
+ *  Las trazas CSV tienen el formato de sht30sim_load_trace (t_s,temp,hum, en °C y %HR) y se
+ *  convierten a ticks con las inversas de SHT30. Sin trazas se usan series sintéticas de -n muestras:
+ *    - paseo:    paseo aleatorio de los ticks cada 5 s, del orden del ruido del sensor
+ *    - saltos:   el mismo paseo con saltos de rango completo (0 <-> 65535), intervalos de 1 s a 1 día
+ *                y saltos de reloj de 2^28 s junto con ambos ticks (registros de RECORD_MAX_SIZE bytes)
+ *    - especiales: valores repetidos, cambios de signo (+-0), NaN con distintos bits, infinitos,
+ *                extremos de float y bits al azar con intervalos irregulares (peor caso de GORILLA)
+ *  Cada serie se prueba con SDLOG_ENC_DELTA (API_record) y con SDLOG_ENC_GORILLA (API_gorilla).
+ *  Los bloques se arman como en sdlogAppend: la primera muestra se codifica contra el tiempo del
+ *  bloque y valores en 0, y el bloque se cierra cuando el siguiente registro podría no entrar
+ *  (usados + RECORD_MAX_SIZE o GORILLA_MAX_RECORD > capacidad). Cada bloque se decodifica solo con
+ *  sus bytes y se compara muestra por muestra (con GORILLA, los bits de los float y los ticks que
+ *  reconstruye sdlogDecode); además se verifica que el último registro truncado no se decodifique.
+ *  Se informan las muestras por bloque, los bytes por muestra, el tamaño del primer registro de
+ *  cada bloque y el costo por muestra. Termina con error ante cualquier diferencia.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "API_gorilla.h"
+#include "API_record.h"
+#include "API_sdlog.h"
+#include "benchutil.h"
+#include "main.h"
+#include "sht30.h"
+
+#define SAMPLE_PERIOD	5		// s
+
+typedef struct{
+	char name[64];
+	logSample_t *v;
+	uint32_t n;
+} series_t;
+
+typedef struct{
+	uint32_t blocks;
+	uint32_t bytes;				// bytes de registros usados
+	uint32_t first_bytes;		// bytes de los primeros registros de cada bloque
+	uint8_t max_record;
+	uint32_t errors;
+	double t_encode;
+	double t_decode;
+} result_t;
+
+static bool load_csv(const char *path, series_t *s);
+static void synth(series_t *s, const char *name, uint32_t n, int kind);
+static bool run(const series_t *s, uint8_t encoding, uint16_t capacity);
+static uint16_t encode_record(uint8_t encoding, gorilla_t *g, uint8_t *payload, uint16_t used,
+		const logSample_t *first, const logSample_t *prev, const logSample_t *sample);
+static uint16_t decode_block(uint8_t encoding, uint32_t time, const uint8_t *payload, uint16_t len,
+		logSample_t *out, uint16_t count, uint16_t *end);
+static uint32_t check_block(uint8_t encoding, const logSample_t *expected, uint16_t count, const uint8_t *payload,
+		uint16_t used, result_t *r);
+static void special(logSample_t *sample, uint32_t i, uint32_t *time);
+static void set_ticks(logSample_t *sample, int32_t raw_temp, int32_t raw_hum);
+
+
+int main(int argc, char **argv)
+{
+	uint32_t n = 1000000;
+	uint32_t state_len = sizeof(Block_data);
+	series_t series[16];
+	int count = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) n = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) state_len = strtoul(argv[++i], NULL, 0);
+		else if (argv[i][0] == '-')
+		{
+			fprintf(stderr, "uso: recordbench [-n muestras] [-s bytes de estado] [traza.csv]...\n");
+			return 2;
+		}
+		else if (count < (int)(sizeof(series) / sizeof(series[0])))
+		{
+			if (!load_csv(argv[i], &series[count]))
+			{
+				fprintf(stderr, "recordbench: no se pudo leer la traza %s\n", argv[i]);
+				return 1;
+			}
+			count++;
+		}
+	}
+	if (sizeof(logHeader_t) + state_len + GORILLA_MAX_RECORD > SD_BLOCK_SIZE)
+	{
+		fprintf(stderr, "recordbench: %lu bytes de estado no dejan lugar para un registro\n", (unsigned long)state_len);
+		return 2;
+	}
+	if (count == 0)
+	{
+		synth(&series[count++], "paseo", n, 0);
+		synth(&series[count++], "saltos", n, 1);
+		synth(&series[count++], "especiales", n, 2);
+	}
+
+	uint16_t capacity = SD_BLOCK_SIZE - sizeof(logHeader_t) - state_len;
+	printf("bloque de %u bytes: cabecera %u, estado %lu, registros %u\n",
+			SD_BLOCK_SIZE, (unsigned)sizeof(logHeader_t), (unsigned long)state_len, capacity);
+	printf("%-26s %-8s %9s %7s %11s %9s %9s %6s %8s %9s %8s\n", "serie", "formato",
+			"muestras", "bloques", "muest/bloq", "B/muestra", "B primero", "B max", "ns cod", "ns decod", "errores");
+
+	bool ok = true;
+	for (int i = 0; i < count; i++)
+	{
+		ok = run(&series[i], SDLOG_ENC_DELTA, capacity) && ok;
+		ok = run(&series[i], SDLOG_ENC_GORILLA, capacity) && ok;
+		free(series[i].v);
+	}
+
+	if (!ok) printf("recordbench: la decodificación no reproduce las muestras\n");
+	return ok ? 0 : 1;
+}
+
+/**
+  * @brief  Codifica la serie en bloques como sdlogAppend, decodifica cada bloque e imprime una línea.
+  * @retval true si todas las muestras se recuperaron exactas.
+  */
+static bool run(const series_t *s, uint8_t encoding, uint16_t capacity)
+{
+	uint8_t payload[SD_BLOCK_SIZE];
+	gorilla_t g;
+	result_t r;
+	uint32_t start = 0;
+	uint16_t used = 0, count = 0;
+	const uint16_t max_record = encoding == SDLOG_ENC_GORILLA ? GORILLA_MAX_RECORD : RECORD_MAX_SIZE;
+	double t0 = 0;
+
+	memset(&r, 0, sizeof(r));
+
+	for (uint32_t i = 0; i < s->n; i++)
+	{
+		if (count == 0)
+		{
+			memset(payload, 0xFF, sizeof(payload));
+			start = i;
+			t0 = bench_now_s();
+		}
+
+		// la primera muestra va contra el tiempo del bloque (el suyo) y valores en 0
+		uint16_t end = encode_record(encoding, &g, payload, used, &s->v[start], count ? &s->v[i - 1] : NULL, &s->v[i]);
+
+		if (end - used > max_record) r.errors++;
+		if (end - used > r.max_record) r.max_record = end - used;
+		if (count == 0) r.first_bytes += end - used;
+		used = end;
+		count++;
+
+		if (used + max_record > capacity || i + 1 == s->n)
+		{
+			r.t_encode += bench_now_s() - t0;
+			if (used > capacity) r.errors++;
+			check_block(encoding, &s->v[start], count, payload, used, &r);
+			r.bytes += used;
+			r.blocks++;
+			used = 0;
+			count = 0;
+		}
+	}
+
+	printf("%-26s %-8s %9u %7u %11.1f %9.2f %9.2f %6u %8.1f %9.1f %8u\n",
+			s->name, encoding == SDLOG_ENC_GORILLA ? "gorilla" : "delta", s->n, r.blocks,
+			r.blocks ? (double)s->n / r.blocks : 0, s->n ? (double)r.bytes / s->n : 0,
+			r.blocks ? (double)r.first_bytes / r.blocks : 0, r.max_record,
+			s->n ? r.t_encode * 1e9 / s->n : 0, s->n ? r.t_decode * 1e9 / s->n : 0, r.errors);
+	return r.errors == 0;
+}
+
+/**
+  * @brief  Codifica una muestra a continuación de used, como sdlogEncode.
+  * @param  prev: muestra anterior del bloque, o NULL para la primera.
+  * @retval Bytes usados del bloque incluyendo la muestra.
+  */
+static uint16_t encode_record(uint8_t encoding, gorilla_t *g, uint8_t *payload, uint16_t used,
+		const logSample_t *first, const logSample_t *prev, const logSample_t *sample)
+{
+	if (encoding == SDLOG_ENC_GORILLA)
+	{
+		float values[GORILLA_VALUES] = { sample->temp, sample->hum };
+
+		if (prev == NULL) gorillaInit(g, first->time);
+		return gorillaEncode(g, payload, sample->time, values);
+	}
+
+	logSample_t ref;
+	if (prev == NULL)
+	{
+		memset(&ref, 0, sizeof(ref));
+		ref.time = first->time;
+		prev = &ref;
+	}
+	return used + recordEncode(&payload[used], sample, prev);
+}
+
+/**
+  * @brief  Decodifica hasta count muestras de los primeros len bytes de un bloque, como sdlogDecodeBlock.
+  * @retval Cantidad de muestras decodificadas; *end queda en los bytes consumidos.
+  */
+static uint16_t decode_block(uint8_t encoding, uint32_t time, const uint8_t *payload, uint16_t len,
+		logSample_t *out, uint16_t count, uint16_t *end)
+{
+	gorilla_t g;
+	logSample_t ref;
+	uint16_t off = 0, i;
+
+	memset(&ref, 0, sizeof(ref));
+	ref.time = time;
+	gorillaInit(&g, time);
+
+	for (i = 0; i < count; i++)
+	{
+		if (encoding == SDLOG_ENC_GORILLA)
+		{
+			float values[GORILLA_VALUES];
+
+			memset(&out[i], 0, sizeof(out[i]));
+			if (!gorillaDecode(&g, payload, len, &out[i].time, values)) break;
+			out[i].temp = values[0];
+			out[i].hum = values[1];
+			out[i].raw_temp = SHT30_temperatureToRaw(values[0]); // como sdlogDecode
+			out[i].raw_hum = SHT30_humidityToRaw(values[1]);
+			off = (uint16_t)((g.bit + 7) / 8);
+		}
+		else
+		{
+			uint8_t n = recordDecode(&payload[off], len - off, &out[i], &ref);
+			if (n == 0) break;
+			off += n;
+			ref = out[i];
+		}
+	}
+
+	*end = off;
+	return i;
+}
+
+/**
+  * @brief  Decodifica un bloque solo con sus bytes y lo compara con las muestras originales.
+  * @note	Con DELTA se comparan tiempo y ticks (°C y %HR salen de los ticks). Con GORILLA se comparan
+  * 		tiempo, los bits de los float (NaN, -0 e infinitos incluidos) y que los ticks se reconstruyan.
+  * 		Sin el último byte del bloque el último registro no debe decodificarse.
+  * @retval Cantidad de muestras distintas o no decodificadas.
+  */
+static uint32_t check_block(uint8_t encoding, const logSample_t *expected, uint16_t count, const uint8_t *payload,
+		uint16_t used, result_t *r)
+{
+	static logSample_t out[SD_BLOCK_SIZE * 8];
+	uint32_t errors = 0;
+	uint16_t end;
+
+	double t0 = bench_now_s();
+	uint16_t n = decode_block(encoding, expected[0].time, payload, used, out, count, &end);
+	r->t_decode += bench_now_s() - t0;
+
+	errors += count - n;
+	if (end != used) errors++;
+
+	for (uint16_t i = 0; i < n; i++)
+	{
+		const logSample_t *e = &expected[i];
+		bool same = out[i].time == e->time && out[i].raw_temp == e->raw_temp && out[i].raw_hum == e->raw_hum;
+
+		if (encoding == SDLOG_ENC_GORILLA) same = same && !memcmp(&out[i].temp, &e->temp, sizeof(float)) &&
+				!memcmp(&out[i].hum, &e->hum, sizeof(float));
+		else same = same && out[i].temp == SHT30_rawToTemperature(e->raw_temp) && out[i].hum == SHT30_rawToHumidity(e->raw_hum);
+
+		if (!same) errors++;
+	}
+
+	// con GORILLA el último byte puede tener bits de los dos últimos registros: basta que no salga el último
+	if (used > 0 && decode_block(encoding, expected[0].time, payload, used - 1, out, count, &end) >= count) errors++;
+
+	r->errors += errors;
+	return errors;
+}
+
+/* ====================  Series  ======================================== */
+
+static bool load_csv(const char *path, series_t *s)
+{
+	trace_point_t *points;
+	uint32_t n = (uint32_t)bench_load_trace(path, &points);
+
+	memset(s, 0, sizeof(*s));
+	snprintf(s->name, sizeof(s->name), "%.60s", path);
+	s->v = malloc(n * sizeof(logSample_t));
+
+	for (uint32_t i = 0; i < n && s->v != NULL; i++)
+	{
+		logSample_t *sample = &s->v[s->n++];
+		sample->time = (uint32_t)(points[i].t + 0.5);
+		set_ticks(sample, SHT30_temperatureToRaw((float)points[i].temp), SHT30_humidityToRaw((float)points[i].hum));
+	}
+	free(points);
+	return s->n > 0;
+}
+
+static void synth(series_t *s, const char *name, uint32_t n, int kind)
+{
+	int32_t temp = SHT30_temperatureToRaw(22.0f);
+	int32_t hum = SHT30_humidityToRaw(50.0f);
+	uint32_t time = 0;
+
+	snprintf(s->name, sizeof(s->name), "%s", name);
+	s->n = n;
+	s->v = malloc(n * sizeof(logSample_t));
+
+	for (uint32_t i = 0; i < n && s->v != NULL; i++)
+	{
+		if (kind == 2)
+		{
+			special(&s->v[i], i, &time);
+			continue;
+		}
+
+		temp += (int32_t)lround(15.0 * bench_gauss());	// ~0,04 °C
+		hum += (int32_t)lround(65.0 * bench_gauss());		// ~0,1 %HR
+		time += SAMPLE_PERIOD;
+
+		if (kind == 1 && (bench_rand32() % 100) == 0)
+		{
+			switch (bench_rand32() % 5)
+			{
+				case 0:  temp = 0; hum = 65535; break;
+				case 1:  temp = 65535; hum = 0; break;
+				case 2:  time += bench_rand32() % 86400; break;
+				case 3:  time -= SAMPLE_PERIOD - 1; break;
+				default: time += 1UL << 28; temp = 65535 - temp; hum = 65535 - hum; break; // registro de RECORD_MAX_SIZE
+			}
+		}
+		set_ticks(&s->v[i], temp, hum);
+		s->v[i].time = time;
+		temp = s->v[i].raw_temp;
+		hum = s->v[i].raw_hum;
+	}
+}
+
+/**
+  * @brief  Muestra i de la serie de casos especiales para GORILLA, en tramos de 64 muestras: valores repetidos,
+  * 		cambios de signo (+-0 incluido), NaN con distintos bits, infinitos y extremos de float, bits al azar
+  * 		con intervalos irregulares (registros del peor caso) y un paseo normal alrededor de 22 °C.
+  */
+static void special(logSample_t *sample, uint32_t i, uint32_t *time)
+{
+	static const uint32_t nan_bits[] = { 0x7FC00000, 0xFFC00000, 0x7FC00123, 0x7F800001 };
+	float temp, hum;
+	uint32_t bits;
+
+	*time += SAMPLE_PERIOD;
+
+	switch ((i / 64) % 6)
+	{
+		case 0:
+			temp = 21.5f;
+			hum = 48.25f;
+			break;
+		case 1:
+			temp = (i & 1) ? 0.25f : -0.25f;
+			hum = (i & 2) ? 0.0f : -0.0f;
+			break;
+		case 2:
+			memcpy(&temp, &nan_bits[i % 4], sizeof(temp));
+			memcpy(&hum, &nan_bits[(i + 1) % 4], sizeof(hum));
+			if (i & 4) temp = -45.0f;
+			break;
+		case 3:
+		{
+			const float extreme[] = { INFINITY, -INFINITY, FLT_MAX, -FLT_MAX, FLT_MIN, 1e-45f, -1e-45f, 130.0f };
+			temp = extreme[i % 8];
+			hum = extreme[(i + 3) % 8];
+			break;
+		}
+		case 4:
+			bits = bench_rand32() << 8 ^ bench_rand32();
+			memcpy(&temp, &bits, sizeof(temp));
+			bits = bench_rand32() << 8 ^ bench_rand32();
+			memcpy(&hum, &bits, sizeof(hum));
+			*time += bench_rand32() % 100000;
+			break;
+		default:
+			temp = 22.0f + 0.04f * (float)bench_gauss();
+			hum = 50.0f + 0.1f * (float)bench_gauss();
+			break;
+	}
+
+	sample->time = *time;
+	sample->temp = temp;
+	sample->hum = hum;
+	sample->raw_temp = SHT30_temperatureToRaw(temp);
+	sample->raw_hum = SHT30_humidityToRaw(hum);
+}
+
+/**
+  * @brief  Fija los ticks de una muestra (saturados a 16 bits) y los valores convertidos, como los deja recordDecode.
+  */
+static void set_ticks(logSample_t *sample, int32_t raw_temp, int32_t raw_hum)
+{
+	sample->raw_temp = (uint16_t)(raw_temp < 0 ? 0 : raw_temp > 65535 ? 65535 : raw_temp);
+	sample->raw_hum = (uint16_t)(raw_hum < 0 ? 0 : raw_hum > 65535 ? 65535 : raw_hum);
+	sample->temp = SHT30_rawToTemperature(sample->raw_temp);
+	sample->hum = SHT30_rawToHumidity(sample->raw_hum);
+}
@@ -0,0 +1,286 @@
+/*
+ *	@file sdtool.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Herramienta de host para el driver de SD Card
+ *  @brief Ejecuta el driver (sd_card.c) contra el simulador (sd_sim.c) para medir throughput y verificarlo
+ *
+ *  Uso:
+ *    sdtool info  <imagen> [opciones]            inicializa la tarjeta y muestra OCR/CSD/CID
+ *    sdtool bench <imagen> [opciones]            mide y verifica lecturas, escrituras y borrado
+ *
+ *  Opciones:
+ *    -b <bloques>      tamaño de la imagen (por defecto 8192 = 4 MB; 0 usa el tamaño del archivo)
+ *    -n <bloques>      bloques por prueba (por defecto 256)
+ *    -l <us>           latencia de acceso de cada comando de lectura
+ *    -L <us>           latencia entre bloques de una lectura multi-bloque
+ *    -w <us>           busy de programación de cada comando de escritura
+ *    -W <us>           busy por bloque de una escritura multi-bloque
+ *    --sdsc            simula una tarjeta SDSC (direccionamiento por byte)
+ *
+ *  Los tiempos son virtuales (reloj SPI + latencias de la tarjeta simulada).
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sd_card.h"
+#include "sd_sim.h"
+#include "vclock.h"
+
+#define MULTI_CHUNK		32	// bloques por transferencia multi-bloque
+#define SPEEDUP_TOL		0.9	// fracción de la mejora del modelo que debe alcanzar cada operación multi-bloque
+
+static uint32_t test_blocks = 256;
+static sdsim_config_t config;
+
+static void fill_pattern(uint8_t *buf, uint32_t block, uint32_t seed);
+static const char *err_name(sd_err_t err);
+static void print_info(void);
+static double print_result(const char *name, uint32_t blocks, uint64_t t0_ns, sd_op_t op);
+static bool check_speedup(const char *name, double single_kbs, double multi_kbs, uint32_t command_us, uint32_t block_us);
+static int bench(void);
+static void usage(void);
+
+
+int main(int argc, char **argv)
+{
+	uint32_t blocks = 8192;
+
+	sdsim_default_config(&config);
+
+	if (argc < 3)
+	{
+		usage();
+		return 2;
+	}
+
+	for (int i = 3; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--sdsc")) config.sdhc = false;
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc) blocks = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) test_blocks = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-l") && i + 1 < argc) config.read_access_us = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-L") && i + 1 < argc) config.read_block_us = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-w") && i + 1 < argc) config.write_program_us = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-W") && i + 1 < argc) config.write_block_us = strtoul(argv[++i], NULL, 0);
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+
+	if (!sdsim_open(argv[2], blocks, &config))
+	{
+		fprintf(stderr, "sdtool: no se pudo abrir la imagen %s\n", argv[2]);
+		return 1;
+	}
+
+	uint64_t t0 = vclock_now_ns();
+	sd_err_t err = SD_init();
+	if (err != SD_OK)
+	{
+		fprintf(stderr, "sdtool: SD_init: %s\n", err_name(err));
+		sdsim_close();
+		return 1;
+	}
+	printf("init: %.2f ms\n", (vclock_now_ns() - t0) / 1e6);
+	print_info();
+
+	int ret = 0;
+	if (!strcmp(argv[1], "bench")) ret = bench();
+	else if (strcmp(argv[1], "info") != 0)
+	{
+		usage();
+		ret = 2;
+	}
+
+	sdsim_close();
+	return ret;
+}
+
+/**
+  * @brief  Escribe, lee y verifica test_blocks bloques con cada tipo de operación y luego borra el rango.
+  * @retval 0 si todas las verificaciones pasaron.
+  */
+static int bench(void)
+{
+	static uint8_t buf[MULTI_CHUNK * SD_BLOCK_SIZE];
+	uint32_t n = test_blocks;
+	uint32_t base = 1;
+	int fails = 0;
+
+	if (n == 0 || base + n > sdsim_blocks())
+	{
+		fprintf(stderr, "sdtool: la imagen es chica para %u bloques\n", n);
+		return 1;
+	}
+
+	printf("\n%-14s %8s %10s %10s %10s\n", "prueba", "bloques", "KB/s", "prom us", "max us");
+
+	// escritura y lectura de a un bloque
+	SD_resetLatency();
+	uint64_t t0 = vclock_now_ns();
+	for (uint32_t b = 0; b < n; b++)
+	{
+		fill_pattern(buf, base + b, 1);
+		if (SD_write(base + b, buf) != SD_OK) fails++;
+	}
+	double write_kbs = print_result("SD_write", n, t0, SD_OP_WRITE);
+
+	t0 = vclock_now_ns();
+	for (uint32_t b = 0; b < n; b++)
+	{
+		uint8_t expected[SD_BLOCK_SIZE];
+		fill_pattern(expected, base + b, 1);
+		if (SD_read(base + b, buf) != SD_OK || memcmp(buf, expected, SD_BLOCK_SIZE)) fails++;
+	}
+	double read_kbs = print_result("SD_read", n, t0, SD_OP_READ);
+
+	// escritura no bloqueante (DMA)
+	t0 = vclock_now_ns();
+	for (uint32_t b = 0; b < n; b++)
+	{
+		fill_pattern(buf, base + b, 2);
+		if (SD_writeStart(base + b, buf) != SD_OK)
+		{
+			fails++;
+			continue;
+		}
+		sd_err_t err;
+		while ((err = SD_writeProcess()) == SD_BUSY) { }
+		if (err != SD_OK) fails++;
+		if (memcmp(sdsim_block(base + b), buf, SD_BLOCK_SIZE)) fails++;
+	}
+	print_result("SD_writeStart", n, t0, SD_OP_WRITE);
+
+	// multi-bloque
+	t0 = vclock_now_ns();
+	for (uint32_t b = 0; b < n; b += MULTI_CHUNK)
+	{
+		uint32_t count = (n - b < MULTI_CHUNK) ? n - b : MULTI_CHUNK;
+		for (uint32_t i = 0; i < count; i++) fill_pattern(&buf[i * SD_BLOCK_SIZE], base + b + i, 3);
+		if (SD_writeMulti(base + b, buf, count) != SD_OK) fails++;
+	}
+	double write_multi_kbs = print_result("SD_writeMulti", n, t0, SD_OP_WRITE_MULTI);
+
+	t0 = vclock_now_ns();
+	for (uint32_t b = 0; b < n; b += MULTI_CHUNK)
+	{
+		uint32_t count = (n - b < MULTI_CHUNK) ? n - b : MULTI_CHUNK;
+		if (SD_readMulti(base + b, buf, count) != SD_OK) fails++;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint8_t expected[SD_BLOCK_SIZE];
+			fill_pattern(expected, base + b + i, 3);
+			if (memcmp(&buf[i * SD_BLOCK_SIZE], expected, SD_BLOCK_SIZE)) fails++;
+		}
+	}
+	double read_multi_kbs = print_result("SD_readMulti", n, t0, SD_OP_READ_MULTI);
+
+	// borrado del rango
+	t0 = vclock_now_ns();
+	if (SD_eraseRange(base, base + n - 1) != SD_OK) fails++;
+	printf("%-14s %8u %10s %10.0f\n", "SD_eraseRange", n, "-", (vclock_now_ns() - t0) / 1e3);
+	for (uint32_t b = 0; b < n; b++)
+	{
+		const uint8_t *block = sdsim_block(base + b);
+		for (int i = 0; i < SD_BLOCK_SIZE; i++)
+		{
+			if (block[i] != SD_getCardInfo()->erased_byte)
+			{
+				fails++;
+				break;
+			}
+		}
+	}
+
+	printf("\n");
+	if (!check_speedup("SD_writeMulti / SD_write", write_kbs, write_multi_kbs, config.write_program_us, config.write_block_us)) fails++;
+	if (!check_speedup("SD_readMulti / SD_read", read_kbs, read_multi_kbs, config.read_access_us, config.read_block_us)) fails++;
+
+	const sdsim_stats_t *st = sdsim_get_stats();
+	printf("\nbus: %llu bytes, %u comandos, %u bloques leídos, %u escritos, %u errores\n",
+			(unsigned long long)st->bytes, st->commands, st->blocks_read, st->blocks_written, st->errors);
+	printf("verificación: %s (%d fallas)\n", fails ? "FALLA" : "OK", fails);
+
+	return fails ? 1 : 0;
+}
+
+/**
+  * @brief  Contenido de prueba de un bloque: depende del número de bloque y de la pasada.
+  */
+static void fill_pattern(uint8_t *buf, uint32_t block, uint32_t seed)
+{
+	uint32_t x = block * 2654435761u + seed * 40503u + 1;
+	for (int i = 0; i < SD_BLOCK_SIZE; i++)
+	{
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		buf[i] = (uint8_t)x;
+	}
+}
+
+static const char *err_name(sd_err_t err)
+{
+	switch (err)
+	{
+		case SD_OK: return "SD_OK";
+		case SD_BUSY: return "SD_BUSY";
+		case SD_TIMEOUT: return "SD_TIMEOUT";
+		default: return "SD_ERROR";
+	}
+}
+
+static void print_info(void)
+{
+	const sd_card_info_t *info = SD_getCardInfo();
+
+	printf("tipo: %s, %u bloques (%u MB), OCR 0x%08X\n", info->type == SD_TYPE_SDHC ? "SDHC/SDXC" : "SDSC",
+			info->blocks, info->blocks / 2048, info->ocr);
+	printf("reloj: %u kHz (max %u kHz), bloques borrados = 0x%02X\n",
+			info->clock_hz / 1000, info->max_clock_hz / 1000, info->erased_byte);
+	printf("CID: %.5s\n", (const char *)&info->cid[3]);
+}
+
+static double print_result(const char *name, uint32_t blocks, uint64_t t0_ns, sd_op_t op)
+{
+	double s = (vclock_now_ns() - t0_ns) / 1e9;
+	const sd_latency_t *l = SD_getLatency(op);
+	double avg = l->count ? (double)l->total_us / l->count : 0;
+
+	double kbs = blocks * SD_BLOCK_SIZE / 1024.0 / s;
+
+	printf("%-14s %8u %10.1f %10.0f %10u\n", name, blocks, kbs, avg, l->max_us);
+	SD_resetLatency();
+	return kbs;
+}
+
+/**
+  * @brief  Compara la mejora de una operación multi-bloque con la que predice el modelo de la tarjeta.
+  * @note   Por bloque, de a uno cuesta la transferencia más el costo del comando; en un stream de
+  *         MULTI_CHUNK bloques, la transferencia, el costo por bloque y el del comando repartido.
+  * @param  command_us: latencia de acceso o busy de programación que se paga una vez por comando.
+  * @param  block_us: latencia o busy por bloque dentro del stream.
+  * @retval true si la mejora medida alcanza SPEEDUP_TOL de la esperada.
+  */
+static bool check_speedup(const char *name, double single_kbs, double multi_kbs, uint32_t command_us, uint32_t block_us)
+{
+	double xfer_us = (SD_BLOCK_SIZE + 4) * 8e6 / SD_getCardInfo()->clock_hz;	// token, datos, CRC y respuesta
+	double expected = (xfer_us + command_us) / (xfer_us + block_us + (double)command_us / MULTI_CHUNK);
+	double measured = multi_kbs / single_kbs;
+	bool ok = measured >= expected * SPEEDUP_TOL;
+
+	printf("%-26s x%.2f (modelo x%.2f) %s\n", name, measured, expected, ok ? "OK" : "FALLA");
+	return ok;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "uso: sdtool info|bench <imagen> [-b bloques] [-n bloques] [-l us] [-L us] [-w us] [-W us] [--sdsc]\n");
+}
@@ -0,0 +1,209 @@
+/*
+ *	@file sht30bench.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Micro-benchmark de la decodificación de tramas del SHT30
+ *  @brief Compara la validación y conversión de sht30.c con la implementación anterior
+ *
+ *  Uso:
+ *    sht30bench [-n <tramas>]      (por defecto 10000000)
+ *
+ *  Verifica primero que el CRC por tabla coincida con el bit a bit para todas las palabras de 16 bits
+ *  y que la conversión en punto fijo (de una palabra y del promedio de una suma de palabras) sea el
+ *  redondeo exacto de la fórmula en double. Después mide,
+ *  con tiempo real de la máquina, el costo por trama de:
+ *    - ref:    CRC bit a bit y conversión a float con división (código anterior)
+ *    - float:  SHT30_decodeFrame sin usar la conversión + SHT30_rawTo* en float
+ *    - fixed:  SHT30_decodeFrame (CRC por tabla y conversión en centésimas)
+ *  La mitad de las tramas de prueba más una de cada 64 tienen el CRC alterado.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchutil.h"
+#include "sht30.h"
+
+#define NUM_FRAMES		4096	// tramas distintas, recorridas en ciclo
+
+static uint8_t frames[NUM_FRAMES][6];
+static volatile int32_t sink;
+
+static uint8_t ref_crc8(const uint8_t *data, uint8_t len);
+static sht30_err_t ref_decode(const uint8_t *data, float *temp, float *hum);
+static bool verify(void);
+static void make_frames(void);
+static double bench_ref(uint32_t n);
+static double bench_float(uint32_t n);
+static double bench_fixed(uint32_t n);
+
+
+int main(int argc, char **argv)
+{
+	uint32_t n = 10000000;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) n = strtoul(argv[++i], NULL, 0);
+		else
+		{
+			fprintf(stderr, "uso: sht30bench [-n tramas]\n");
+			return 2;
+		}
+	}
+
+	if (!verify()) return 1;
+	make_frames();
+
+	double ref = bench_ref(n);
+	double flt = bench_float(n);
+	double fix = bench_fixed(n);
+
+	printf("%-8s %10s %8s\n", "camino", "ns/trama", "speedup");
+	printf("%-8s %10.2f %8.2f\n", "ref", ref * 1e9 / n, 1.0);
+	printf("%-8s %10.2f %8.2f\n", "float", flt * 1e9 / n, ref / flt);
+	printf("%-8s %10.2f %8.2f\n", "fixed", fix * 1e9 / n, ref / fix);
+	return 0;
+}
+
+/* ====================  Implementación anterior  ======================= */
+
+static uint8_t ref_crc8(const uint8_t *data, uint8_t len)
+{
+	uint8_t crc = 0xFF;
+	for (uint8_t i = 0; i < len; i++)
+	{
+		crc ^= data[i];
+		for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+	}
+	return crc;
+}
+
+static sht30_err_t ref_decode(const uint8_t *data, float *temp, float *hum)
+{
+	if (ref_crc8(data, 2) != data[2] || ref_crc8(&data[3], 2) != data[5]) return SHT30_CRC_FAIL;
+
+	uint16_t raw_temp = (data[0] << 8) | data[1];
+	uint16_t raw_hum = (data[3] << 8) | data[4];
+	*temp = -45 + 175 * ((float)raw_temp / 65535.0f);
+	*hum = 100 * ((float)raw_hum / 65535.0f);
+	return SHT30_OK;
+}
+
+/* ====================  Verificación  ================================== */
+
+/**
+  * @brief  CRC por tabla contra bit a bit y punto fijo contra double, para los 65536 valores.
+  */
+static bool verify(void)
+{
+	uint32_t errors = 0;
+	double max_float_err = 0;
+
+	for (uint32_t w = 0; w <= 0xFFFF; w++)
+	{
+		uint8_t f[6] = { w >> 8, w & 0xFF, 0, w >> 8, w & 0xFF, 0 };
+		sht30_measurement_t m;
+
+		f[2] = f[5] = ref_crc8(f, 2);
+		if (SHT30_decodeFrame(f, &m) != SHT30_OK) errors++;
+		f[5] ^= 0x01;
+		if (SHT30_decodeFrame(f, &m) != SHT30_CRC_FAIL) errors++;
+		f[5] ^= 0x01;
+		SHT30_decodeFrame(f, &m);
+
+		long temp = lround(-4500.0 + 17500.0 * w / 65535.0);
+		long hum = lround(10000.0 * w / 65535.0);
+		if (m.temp_centi != temp || m.hum_centi != hum || m.raw_temp != w || m.raw_hum != w) errors++;
+
+		double exact = -45.0 + 175.0 * w / 65535.0;
+		double e = fabs(SHT30_rawToTemperature(w) - exact);
+		if (e > max_float_err) max_float_err = e;
+	}
+
+	// promedio de sumas de ticks: desde una muestra hasta el máximo de un contador de 32 bits
+	uint32_t x = 777;
+	for (uint32_t i = 0; i < 100000; i++)
+	{
+		x = x * 1103515245 + 12345;
+		uint32_t count = (i < 50000) ? 1 + (x >> 16) : UINT32_MAX - (x >> 8);
+		uint64_t sum = (uint64_t)count * ((x >> 4) & 0xFFFF) + (x & 0xFFF) % count;
+
+		long temp = lround(-4500.0 + 17500.0 * sum / (65535.0 * count));
+		long hum = lround(10000.0 * sum / (65535.0 * count));
+		if (SHT30_sumToCentiCelsius(sum, count) != temp || SHT30_sumToCentiPercent(sum, count) != hum) errors++;
+	}
+
+	printf("verificación: %u errores en 65536 palabras y 100000 sumas, error máximo float %.2e °C\n", errors, max_float_err);
+	return errors == 0;
+}
+
+/* ====================  Medición  ====================================== */
+
+static void make_frames(void)
+{
+	uint32_t x = 12345;
+
+	for (uint32_t i = 0; i < NUM_FRAMES; i++)
+	{
+		x = x * 1103515245 + 12345;
+		uint16_t t = 0x6000 + ((x >> 16) & 0x0FFF); // rango ambiente, como las tramas reales
+		uint16_t h = 0x7000 + ((x >> 4) & 0x0FFF);
+
+		frames[i][0] = t >> 8;
+		frames[i][1] = t & 0xFF;
+		frames[i][2] = ref_crc8(frames[i], 2);
+		frames[i][3] = h >> 8;
+		frames[i][4] = h & 0xFF;
+		frames[i][5] = ref_crc8(&frames[i][3], 2);
+		if ((i & 63) == 0) frames[i][5] ^= 0x80;
+	}
+}
+
+static double bench_ref(uint32_t n)
+{
+	float temp, hum;
+	int32_t acc = 0;
+	double t0 = bench_now_s();
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		if (ref_decode(frames[i % NUM_FRAMES], &temp, &hum) == SHT30_OK) acc += (int32_t)(temp * 100) + (int32_t)hum;
+	}
+	sink = acc;
+	return bench_now_s() - t0;
+}
+
+static double bench_float(uint32_t n)
+{
+	sht30_measurement_t m;
+	int32_t acc = 0;
+	double t0 = bench_now_s();
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		if (SHT30_decodeFrame(frames[i % NUM_FRAMES], &m) == SHT30_OK)
+		{
+			acc += (int32_t)(SHT30_rawToTemperature(m.raw_temp) * 100) + (int32_t)SHT30_rawToHumidity(m.raw_hum);
+		}
+	}
+	sink = acc;
+	return bench_now_s() - t0;
+}
+
+static double bench_fixed(uint32_t n)
+{
+	sht30_measurement_t m;
+	int32_t acc = 0;
+	double t0 = bench_now_s();
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		if (SHT30_decodeFrame(frames[i % NUM_FRAMES], &m) == SHT30_OK) acc += m.temp_centi + m.hum_centi / 100;
+	}
+	sink = acc;
+	return bench_now_s() - t0;
+}
@@ -0,0 +1,180 @@
+/*
+ *	@file statsbench.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Estabilidad numérica de API_stats
+ *  @brief Compara media y varianza de API_stats con una referencia de dos pasadas en long double
+ *
+ *  Uso:
+ *    statsbench [-n <muestras>] [-b <muestras por bloque>]      (por defecto 100000000 y 150)
+ *
+ *  La serie son ticks crudos en el rango ambiente (lejos de 0, donde las sumas de cuadrados
+ *  pierden precisión) con una deriva lenta y ruido. Se calcula:
+ *    - ref:     media exacta (suma entera) y m2 con una segunda pasada en long double
+ *    - welford: statsPush muestra por muestra
+ *    - chan:    statsPush por bloques de -b muestras combinados con statsMerge, como las
+ *               parciales de los bloques del log
+ *    - float:   sumas de x y x^2 en float (como el acumulado anterior), solo para comparar
+ *  La serie se genera de nuevo en cada pasada con la misma semilla. Termina con error si
+ *  welford o chan difieren de la referencia en más de 1e-12 (media) o 1e-9 (varianza) relativos,
+ *  o si no coinciden mínimo, máximo y sus tiempos.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "API_stats.h"
+#include "benchutil.h"
+
+#define MEAN_TOL		1e-12
+#define VAR_TOL			1e-9
+
+typedef struct{
+	uint32_t x;		// xorshift32
+	uint32_t i;
+} gen_t;
+
+static void gen_init(gen_t *g);
+static uint16_t gen_next(gen_t *g);
+static bool report(const char *name, const stats_t *s, long double mean, long double var, const stats_t *ref);
+
+
+int main(int argc, char **argv)
+{
+	uint32_t n = 100000000;
+	uint32_t block = 150;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) n = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc) block = strtoul(argv[++i], NULL, 0);
+		else
+		{
+			fprintf(stderr, "uso: statsbench [-n muestras] [-b muestras por bloque]\n");
+			return 2;
+		}
+	}
+	if (n < 2 || block == 0)
+	{
+		fprintf(stderr, "statsbench: se necesitan al menos 2 muestras y bloques no vacíos\n");
+		return 2;
+	}
+
+	gen_t g;
+	stats_t welford, chan, part, ref;
+	uint64_t sum = 0;
+
+	// referencia: suma exacta y extremos, luego m2 alrededor de la media exacta
+	statsInit(&ref);
+	gen_init(&g);
+	for (uint32_t i = 0; i < n; i++)
+	{
+		uint16_t v = gen_next(&g);
+		sum += v;
+		if (i == 0 || v < ref.min) { ref.min = v; ref.min_time = i; }
+		if (i == 0 || v > ref.max) { ref.max = v; ref.max_time = i; }
+	}
+	ref.count = n;
+
+	long double mean = (long double)sum / n;
+	long double m2 = 0;
+	gen_init(&g);
+	for (uint32_t i = 0; i < n; i++)
+	{
+		long double d = gen_next(&g) - mean;
+		m2 += d * d;
+	}
+	long double var = m2 / (n - 1);
+
+	// Welford muestra por muestra
+	statsInit(&welford);
+	gen_init(&g);
+	double t0 = bench_now_s();
+	for (uint32_t i = 0; i < n; i++) statsPush(&welford, gen_next(&g), i);
+	double t_welford = bench_now_s() - t0;
+
+	// parciales por bloque combinadas en orden
+	statsInit(&chan);
+	statsInit(&part);
+	gen_init(&g);
+	t0 = bench_now_s();
+	for (uint32_t i = 0; i < n; i++)
+	{
+		statsPush(&part, gen_next(&g), i);
+		if (part.count == block || i == n - 1)
+		{
+			statsMerge(&chan, &part);
+			statsInit(&part);
+		}
+	}
+	double t_chan = bench_now_s() - t0;
+
+	// sumas en float
+	float fsum = 0, fsq = 0;
+	gen_init(&g);
+	for (uint32_t i = 0; i < n; i++)
+	{
+		float v = gen_next(&g);
+		fsum += v;
+		fsq += v * v;
+	}
+	stats_t flt = ref;
+	flt.mean = fsum / n;
+	flt.m2 = fsq - fsum * ((double)fsum / n);
+
+	printf("%u muestras, bloques de %u, media %.6Lf ticks, desvío %.6Lf ticks\n", n, block, mean, sqrtl(var));
+	printf("%-8s %12s %12s %9s %9s\n", "camino", "err media", "err var", "extremos", "ns/muestra");
+	bool ok = report("welford", &welford, mean, var, &ref);
+	printf(" %9.2f\n", t_welford * 1e9 / n);
+	ok = report("chan", &chan, mean, var, &ref) && ok;
+	printf(" %9.2f\n", t_chan * 1e9 / n);
+	report("float", &flt, mean, var, &ref);
+	printf("\n");
+
+	if (!ok) printf("statsbench: error fuera de tolerancia (media %.0e, varianza %.0e)\n", MEAN_TOL, VAR_TOL);
+	return ok ? 0 : 1;
+}
+
+/**
+  * @brief  Imprime los errores relativos de un camino respecto de la referencia.
+  * @retval true si está dentro de la tolerancia y los extremos coinciden.
+  */
+static bool report(const char *name, const stats_t *s, long double mean, long double var, const stats_t *ref)
+{
+	double e_mean = fabsl((s->mean - mean) / mean);
+	double e_var = fabsl((statsVariance(s) - var) / var);
+	bool ext = s->count == ref->count && s->min == ref->min && s->max == ref->max &&
+			s->min_time == ref->min_time && s->max_time == ref->max_time;
+
+	printf("%-8s %12.2e %12.2e %9s", name, e_mean, e_var, ext ? "iguales" : "distintos");
+	return e_mean <= MEAN_TOL && e_var <= VAR_TOL && ext;
+}
+
+/* ====================  Serie de prueba  =============================== */
+
+static void gen_init(gen_t *g)
+{
+	g->x = 2463534242U;
+	g->i = 0;
+}
+
+/**
+  * @brief  Próximo valor: 0x6000 más una deriva triangular de 4096 ticks de amplitud
+  * 		(período 2^21 muestras) y ruido uniforme de ±256 ticks.
+  */
+static uint16_t gen_next(gen_t *g)
+{
+	g->x ^= g->x << 13;
+	g->x ^= g->x >> 17;
+	g->x ^= g->x << 5;
+
+	uint32_t phase = (g->i++ >> 8) & 0x1FFF;
+	uint32_t drift = (phase < 0x1000) ? phase : 0x1FFF - phase;
+
+	return 0x6000 + drift + (g->x & 0x1FF) - 0x100;
+}
+
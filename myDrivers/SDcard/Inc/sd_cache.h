@@ -0,0 +1,44 @@
+/*
+ *	@file sd_cache.h
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Cache de bloques de SD Card (.h)
+ *  @brief Definicion de funciones de la cache write-back en RAM delante de SD_read/SD_write
+ */
+
+#ifndef SDCARD_INC_SD_CACHE_H_
+#define SDCARD_INC_SD_CACHE_H_
+
+#include "sd_card.h"
+
+/*
+ * Geometría de la cache: SD_CACHE_SETS conjuntos de SD_CACHE_WAYS vías.
+ * Consumo de RAM aproximado: SD_CACHE_SETS * SD_CACHE_WAYS * 512 bytes.
+ */
+#ifndef SD_CACHE_SETS
+#define SD_CACHE_SETS	4
+#endif
+
+#ifndef SD_CACHE_WAYS
+#define SD_CACHE_WAYS	2
+#endif
+
+typedef struct
+{
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t writebacks;
+} sd_cache_stats_t;
+
+// sd_cache.c
+sd_err_t SD_cacheRead(uint32_t block_addr, uint8_t *buffer);
+sd_err_t SD_cacheWrite(uint32_t block_addr, const uint8_t *buffer);
+sd_err_t SD_flush(void);
+sd_err_t SD_cacheInvalidateRange(uint32_t first_block, uint32_t last_block);
+void SD_flushStart(void);
+sd_err_t SD_cacheProcess(void);
+const sd_cache_stats_t *SD_cacheGetStats(void);
+void SD_cacheResetStats(void);
+
+#endif /* SDCARD_INC_SD_CACHE_H_ */
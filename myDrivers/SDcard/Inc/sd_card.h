@@ -19,10 +19,22 @@
 
 #define CMD0  	0x40
 #define CMD8  	0x48
+#define CMD9  	0x49
+#define CMD10  	0x4A
+#define CMD12 	0x4C
+#define CMD16 	0x50
 #define CMD17 	0x51
+#define CMD18 	0x52
 #define CMD24 	0x58
+#define CMD25 	0x59
+#define CMD32 	0x60
+#define CMD33 	0x61
+#define CMD38 	0x66
 #define CMD55 	0x77
+#define CMD58 	0x7A
+#define ACMD23 	0x57
 #define ACMD41 	0x69
+#define ACMD51 	0x73
 
 typedef enum
 {
@@ -32,18 +44,89 @@ typedef enum
   SD_TIMEOUT  = 0x03U
 } sd_err_t;
 
+#define SD_INIT_CLOCK_HZ	400000	// reloj máximo durante la inicialización (especificación SD)
+
+typedef enum
+{
+  SD_TYPE_UNKNOWN,
+  SD_TYPE_SDSC,		// direccionamiento por byte
+  SD_TYPE_SDHC		// SDHC/SDXC, direccionamiento por bloque
+} sd_type_t;
+
+/*
+ * Información de la tarjeta leída durante la inicialización (OCR, CSD y CID).
+ */
+typedef struct
+{
+  sd_type_t type;
+  uint32_t ocr;
+  uint8_t csd[16];
+  uint8_t cid[16];
+  uint8_t scr[8];
+  uint32_t blocks;			// capacidad en bloques de 512 bytes
+  uint32_t max_clock_hz;	// TRAN_SPEED del CSD
+  uint32_t clock_hz;		// reloj SPI configurado
+  uint8_t erased_byte;		// valor de los datos luego de un ERASE (DATA_STAT_AFTER_ERASE del SCR)
+} sd_card_info_t;
+
+#define SD_LATENCY_BUCKETS	16
+
+typedef enum
+{
+  SD_OP_READ,
+  SD_OP_WRITE,
+  SD_OP_READ_MULTI,
+  SD_OP_WRITE_MULTI,
+  SD_OP_COUNT
+} sd_op_t;
+
+/*
+ * Histograma de latencias por tipo de operación.
+ * hist[0] cuenta latencias menores a 64 us, hist[i] latencias en [2^(i+5), 2^(i+6)) us
+ * y la última posición acumula todo lo que la supera.
+ */
+typedef struct
+{
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t total_us;
+  uint32_t hist[SD_LATENCY_BUCKETS];
+} sd_latency_t;
+
 // port.c
 void cs_Low(void);
 void cs_High(void);
 void sd_Delay(uint32_t ms);
+uint32_t sd_GetTick(void);
+uint32_t sd_GetMicros(void);
 sd_err_t sd_Transmit(const uint8_t *dataTx, uint16_t size);
 sd_err_t sd_TransmitReceive(const uint8_t *dataTx, uint8_t *dataRx, uint16_t size);
 sd_err_t sd_Receive(uint8_t *dataRx, uint16_t size);
+sd_err_t sd_TransmitDMA(const uint8_t *dataTx, uint16_t size);
+sd_err_t sd_ReceiveDMA(uint8_t *dataRx, uint16_t size);
+sd_err_t sd_TransferStatus(void);
+uint32_t sd_SetClock(uint32_t max_hz);
 
 // sd_card.c
 sd_err_t SD_init();
+void SD_initStart(void);
+sd_err_t SD_initProcess(void);
 sd_err_t SD_read(uint32_t block_addr, uint8_t *buffer);
 sd_err_t SD_write(uint32_t block_addr, const uint8_t *buffer);
 sd_err_t SD_erase(uint32_t block_addr);
+sd_err_t SD_eraseRange(uint32_t first_block, uint32_t last_block);
+sd_err_t SD_readMulti(uint32_t block_addr, uint8_t *buffer, uint32_t count);
+sd_err_t SD_writeMulti(uint32_t block_addr, const uint8_t *buffer, uint32_t count);
+sd_err_t SD_streamOpen(uint32_t block_addr);
+sd_err_t SD_streamOpenPreErase(uint32_t block_addr, uint32_t count);
+sd_err_t SD_streamAppend(const uint8_t *buffer);
+sd_err_t SD_streamClose(void);
+sd_err_t SD_writeStart(uint32_t block_addr, const uint8_t *buffer);
+sd_err_t SD_writeProcess(void);
+bool SD_writeBusy(void);
+const sd_card_info_t *SD_getCardInfo(void);
+const sd_latency_t *SD_getLatency(sd_op_t op);
+void SD_resetLatency(void);
 
 #endif /* SDCARD_INC_SD_CARD_H_ */
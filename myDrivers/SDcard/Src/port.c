@@ -1,4 +1,3 @@
-
 /*
  *	@file port.c
  *	@version 1.0
@@ -16,8 +15,7 @@ extern SPI_HandleTypeDef hspi2;
 #define SPI2_CS_Pin GPIO_PIN_12
 #define SPI2_CS_GPIO_Port GPIOB
 
-static GPIO_TypeDef * csPort;
-static uint16_t csbuttonPin;
+static volatile sd_err_t dma_status = SD_OK;
 
 /**
   * @brief  cs_Low Activa la línea CS (Chip Select) llevándola a nivel bajo.
@@ -46,6 +44,69 @@ void sd_Delay(uint32_t ms)
 	HAL_Delay(ms);
 }
 
+/**
+  * @brief  Devuelve el tiempo actual en milisegundos (base para los deadlines del driver).
+  */
+uint32_t sd_GetTick(void)
+{
+	return HAL_GetTick();
+}
+
+/**
+  * @brief  Devuelve un contador de microsegundos basado en el contador de ciclos DWT.
+  * @note   El contador se habilita en la primera llamada. La cuenta se acumula de forma
+  * 		incremental para que la resta de dos lecturas sea válida aunque CYCCNT desborde,
+  * 		siempre que entre ambas no pasen más de 2^32 ciclos (~51 s a 84 MHz).
+  */
+uint32_t sd_GetMicros(void)
+{
+	static uint32_t last_cycles, micros, rem;
+
+	if(!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+	{
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+		last_cycles = 0;
+	}
+
+	uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+	uint32_t now = DWT->CYCCNT;
+	uint32_t delta = (now - last_cycles) + rem;
+	last_cycles = now;
+
+	micros += delta / cycles_per_us;
+	rem = delta % cycles_per_us;
+
+	return micros;
+}
+
+/**
+  * @brief  Configura el reloj SPI más rápido que no supere max_hz.
+  * @note   SPI2 cuelga de APB1; el reloj resulta PCLK1 / 2^(n+1) con n = 0..7.
+  * @param  max_hz: Frecuencia máxima admitida por la tarjeta.
+  * @retval Frecuencia configurada en Hz.
+  */
+uint32_t sd_SetClock(uint32_t max_hz)
+{
+	static const uint32_t prescaler[] = {
+		SPI_BAUDRATEPRESCALER_2, SPI_BAUDRATEPRESCALER_4, SPI_BAUDRATEPRESCALER_8, SPI_BAUDRATEPRESCALER_16,
+		SPI_BAUDRATEPRESCALER_32, SPI_BAUDRATEPRESCALER_64, SPI_BAUDRATEPRESCALER_128, SPI_BAUDRATEPRESCALER_256
+	};
+	uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+	uint8_t n = 0;
+
+	while (n < 7 && (pclk >> (n + 1)) > max_hz) n++;
+
+	if (hspi2.Init.BaudRatePrescaler != prescaler[n])
+	{
+		hspi2.Init.BaudRatePrescaler = prescaler[n];
+		HAL_SPI_Init(&hspi2);
+	}
+
+	return pclk >> (n + 1);
+}
+
 /**
   * @brief  Envía y recibe datos simultáneamente por SPI.
   * @param  dataTx: Puntero al buffer de datos a transmitir.
@@ -79,3 +140,78 @@ sd_err_t sd_Receive(uint8_t *dataRx, uint16_t size)
 {
 	return (sd_err_t)HAL_SPI_Receive(&hspi2, dataRx, size, HAL_MAX_DELAY);
 }
+
+/**
+  * @brief  Inicia la transmisión de un bloque de datos por SPI usando DMA (no bloqueante).
+  * @note   El buffer debe permanecer válido hasta que sd_TransferStatus() deje de devolver SD_BUSY.
+  * @param  dataTx: Puntero al buffer de datos a transmitir.
+  * @param  size: Cantidad de bytes a enviar.
+  * @retval Código de error de tipo sd_err_t
+  */
+sd_err_t sd_TransmitDMA(const uint8_t *dataTx, uint16_t size)
+{
+	dma_status = SD_BUSY;
+	sd_err_t err = (sd_err_t)HAL_SPI_Transmit_DMA(&hspi2, dataTx, size);
+	if(err != SD_OK) dma_status = SD_ERROR;
+	return err;
+}
+
+/**
+  * @brief  Inicia la recepción de un bloque de datos por SPI usando DMA (no bloqueante).
+  * @note   En modo master full-duplex la HAL transmite el propio buffer de recepción,
+  * 		por eso se completa con 0xFF antes de iniciar la transferencia.
+  * @param  dataRx: Puntero al buffer donde se almacenarán los datos recibidos.
+  * @param  size: Cantidad de bytes a recibir.
+  * @retval Código de error de tipo sd_err_t
+  */
+sd_err_t sd_ReceiveDMA(uint8_t *dataRx, uint16_t size)
+{
+	memset(dataRx, 0xFF, size);
+	dma_status = SD_BUSY;
+	sd_err_t err = (sd_err_t)HAL_SPI_Receive_DMA(&hspi2, dataRx, size);
+	if(err != SD_OK) dma_status = SD_ERROR;
+	return err;
+}
+
+/**
+  * @brief  Estado de la última transferencia iniciada por DMA.
+  * @retval SD_BUSY: transferencia en curso.
+  * 		SD_OK: transferencia completada.
+  * 		SD_ERROR: la transferencia falló.
+  */
+sd_err_t sd_TransferStatus(void)
+{
+	return dma_status;
+}
+
+/**
+  * @brief  Callback de la HAL: transmisión por DMA completada.
+  */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+	if(hspi == &hspi2) dma_status = SD_OK;
+}
+
+/**
+  * @brief  Callback de la HAL: recepción por DMA completada.
+  */
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+	if(hspi == &hspi2) dma_status = SD_OK;
+}
+
+/**
+  * @brief  Callback de la HAL: transmisión/recepción por DMA completada.
+  */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+	if(hspi == &hspi2) dma_status = SD_OK;
+}
+
+/**
+  * @brief  Callback de la HAL: error en la transferencia por DMA.
+  */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+	if(hspi == &hspi2) dma_status = SD_ERROR;
+}
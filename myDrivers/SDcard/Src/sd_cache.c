@@ -0,0 +1,354 @@
+/*
+ *	@file sd_cache.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Cache de bloques de SD Card
+ *  @brief cache write-back asociativa por conjuntos (N vías, reemplazo LRU) en RAM
+ */
+
+#include "sd_cache.h"
+
+typedef struct
+{
+	uint32_t block;
+	uint32_t last_use;
+	bool valid;
+	bool dirty;
+	uint8_t data[SD_BLOCK_SIZE];
+} cache_line_t;
+
+static cache_line_t lines[SD_CACHE_SETS][SD_CACHE_WAYS];
+static sd_cache_stats_t stats;
+static uint32_t use_counter;
+
+static cache_line_t *inflight = NULL;
+static bool flush_pending = false;
+
+static cache_line_t *cache_lookup(uint32_t block_addr);
+static sd_err_t cache_allocate(uint32_t block_addr, cache_line_t **line);
+static sd_err_t cache_writeback(cache_line_t *line);
+static sd_err_t cache_wait_inflight(void);
+static void cache_complete(sd_err_t err);
+static void cache_touch(cache_line_t *line);
+
+
+/* ====================  Funciones principales  ========================= */
+
+/**
+  * @brief  Lee un bloque a través de la cache.
+  * @note	Si el bloque está en cache se copia desde RAM sin acceder a la tarjeta.
+  * 		En caso contrario se reemplaza la vía menos usada recientemente del conjunto
+  * 		(escribiéndola antes si estaba modificada) y se lee el bloque con SD_read().
+  * @param  block_addr: Dirección del bloque a leer.
+  * @param  buffer: Puntero al buffer de destino (512 bytes).
+  * @retval SD_OK: si la lectura fue exitosa.
+  * 		Otro código de error de tipo sd_err_t si falló el acceso a la tarjeta.
+  */
+sd_err_t SD_cacheRead(uint32_t block_addr, uint8_t *buffer)
+{
+	cache_line_t *line = cache_lookup(block_addr);
+
+	if (line != NULL)
+	{
+		stats.hits++;
+	}
+	else
+	{
+		stats.misses++;
+
+		sd_err_t err = cache_allocate(block_addr, &line);
+		if (err != SD_OK) return err;
+
+		err = SD_read(block_addr, line->data);
+		if (err != SD_OK) return err;
+
+		line->block = block_addr;
+		line->valid = true;
+		line->dirty = false;
+	}
+
+	cache_touch(line);
+	memcpy(buffer, line->data, SD_BLOCK_SIZE);
+
+	return SD_OK;
+}
+
+/**
+  * @brief  Escribe un bloque en la cache (write-back).
+  * @note	El bloque solo se marca como modificado; llega a la tarjeta cuando es desalojado,
+  * 		con SD_flush() o con la escritura en segundo plano (SD_flushStart / SD_cacheProcess).
+  * 		Escrituras repetidas al mismo bloque entre dos flush se agrupan en una sola escritura física.
+  * 		Como se escribe el bloque completo no es necesario leerlo de la tarjeta en un miss.
+  * @param  block_addr: Dirección del bloque a escribir.
+  * @param  buffer: Puntero al buffer de origen (512 bytes).
+  * @retval SD_OK: si el bloque quedó en cache.
+  * 		Otro código de error de tipo sd_err_t si falló el desalojo de otro bloque.
+  */
+sd_err_t SD_cacheWrite(uint32_t block_addr, const uint8_t *buffer)
+{
+	cache_line_t *line = cache_lookup(block_addr);
+
+	if (line != NULL)
+	{
+		stats.hits++;
+		if (line == inflight)
+		{
+			sd_err_t err = cache_wait_inflight();
+			if (err != SD_OK) return err;
+		}
+	}
+	else
+	{
+		stats.misses++;
+
+		sd_err_t err = cache_allocate(block_addr, &line);
+		if (err != SD_OK) return err;
+
+		line->block = block_addr;
+		line->valid = true;
+	}
+
+	memcpy(line->data, buffer, SD_BLOCK_SIZE);
+	line->dirty = true;
+	cache_touch(line);
+
+	return SD_OK;
+}
+
+/**
+  * @brief  Escribe en la tarjeta todos los bloques modificados (bloqueante).
+  * @retval SD_OK: si todos los bloques quedaron escritos.
+  * 		Otro código de error de tipo sd_err_t si alguna escritura falló.
+  */
+sd_err_t SD_flush(void)
+{
+	sd_err_t err = cache_wait_inflight();
+	flush_pending = false;
+
+	for (int s = 0; s < SD_CACHE_SETS; s++)
+	{
+		for (int w = 0; w < SD_CACHE_WAYS; w++)
+		{
+			cache_line_t *line = &lines[s][w];
+			if (line->valid && line->dirty)
+			{
+				sd_err_t e = cache_writeback(line);
+				if (e != SD_OK) err = e;
+			}
+		}
+	}
+
+	return err;
+}
+
+/**
+  * @brief  Descarta de la cache los bloques de un rango, sin escribirlos.
+  * @note	Se usa antes de borrar el rango en la tarjeta (SD_eraseRange), para que la cache no
+  * 		devuelva ni escriba después contenido anterior al borrado. Si hay una escritura en
+  * 		segundo plano en curso se espera a que termine.
+  * @param  first_block: Primer bloque del rango.
+  * @param  last_block: Último bloque del rango (inclusive).
+  * @retval Resultado de la escritura en curso (SD_OK si no había ninguna).
+  */
+sd_err_t SD_cacheInvalidateRange(uint32_t first_block, uint32_t last_block)
+{
+	sd_err_t err = cache_wait_inflight();
+
+	for (int s = 0; s < SD_CACHE_SETS; s++)
+	{
+		for (int w = 0; w < SD_CACHE_WAYS; w++)
+		{
+			cache_line_t *line = &lines[s][w];
+			if (line->valid && line->block >= first_block && line->block <= last_block)
+			{
+				line->valid = false;
+				line->dirty = false;
+			}
+		}
+	}
+
+	return err;
+}
+
+/**
+  * @brief  Solicita un flush en segundo plano.
+  * @note	Los bloques modificados se escriben de a uno con la escritura no bloqueante del driver,
+  * 		avanzando en cada llamada a SD_cacheProcess().
+  */
+void SD_flushStart(void)
+{
+	flush_pending = true;
+}
+
+/**
+  * @brief  Avanza el flush en segundo plano. Debe llamarse periódicamente desde el superloop.
+  * @retval SD_BUSY: hay una escritura en curso.
+  * 		SD_OK: no hay flush pendiente o terminó en esta llamada.
+  * 		Otro código de error de tipo sd_err_t si una escritura falló (se cancela el flush).
+  */
+sd_err_t SD_cacheProcess(void)
+{
+	if (inflight != NULL)
+	{
+		sd_err_t err = SD_writeProcess();
+		if (err == SD_BUSY) return SD_BUSY;
+
+		cache_complete(err);
+		if (err != SD_OK)
+		{
+			flush_pending = false;
+			return err;
+		}
+	}
+
+	if (!flush_pending) return SD_OK;
+
+	for (int s = 0; s < SD_CACHE_SETS; s++)
+	{
+		for (int w = 0; w < SD_CACHE_WAYS; w++)
+		{
+			cache_line_t *line = &lines[s][w];
+			if (line->valid && line->dirty)
+			{
+				sd_err_t err = SD_writeStart(line->block, line->data);
+				if (err == SD_OK) inflight = line;
+				else if (err != SD_BUSY) flush_pending = false;
+
+				return (err == SD_OK) ? SD_BUSY : err;
+			}
+		}
+	}
+
+	flush_pending = false;
+	return SD_OK;
+}
+
+/**
+  * @brief  Devuelve los contadores de la cache (hits, misses y escrituras a la tarjeta).
+  */
+const sd_cache_stats_t *SD_cacheGetStats(void)
+{
+	return &stats;
+}
+
+/**
+  * @brief  Reinicia los contadores de la cache.
+  */
+void SD_cacheResetStats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+/* =====================  Utilidad y control  =========================== */
+
+/**
+  * @brief  Busca un bloque en su conjunto.
+  * @param  block_addr: Dirección del bloque.
+  * @retval Puntero a la línea que contiene el bloque o NULL si no está en cache.
+  */
+static cache_line_t *cache_lookup(uint32_t block_addr)
+{
+	cache_line_t *set = lines[block_addr % SD_CACHE_SETS];
+
+	for (int w = 0; w < SD_CACHE_WAYS; w++)
+	{
+		if (set[w].valid && set[w].block == block_addr) return &set[w];
+	}
+	return NULL;
+}
+
+/**
+  * @brief  Obtiene una línea libre para un bloque, desalojando la menos usada del conjunto.
+  * @note	Se prefiere una vía inválida. Si la víctima está modificada se escribe antes en la tarjeta.
+  * 		Si hay una escritura en segundo plano en curso se espera a que termine.
+  * @param  block_addr: Dirección del bloque a alojar.
+  * @param  line: Puntero donde se devuelve la línea asignada.
+  * @retval SD_OK: si se obtuvo la línea.
+  * 		Otro código de error de tipo sd_err_t si falló la escritura de la víctima.
+  */
+static sd_err_t cache_allocate(uint32_t block_addr, cache_line_t **line)
+{
+	cache_line_t *set = lines[block_addr % SD_CACHE_SETS];
+	cache_line_t *victim = &set[0];
+
+	for (int w = 0; w < SD_CACHE_WAYS; w++)
+	{
+		if (!set[w].valid)
+		{
+			victim = &set[w];
+			break;
+		}
+		if (set[w].last_use < victim->last_use) victim = &set[w];
+	}
+
+	sd_err_t err = cache_wait_inflight(); // el bus debe quedar libre para leer o desalojar
+	if (err != SD_OK) return err;
+
+	if (victim->valid && victim->dirty)
+	{
+		err = cache_writeback(victim);
+		if (err != SD_OK) return err;
+	}
+
+	victim->valid = false;
+	*line = victim;
+
+	return SD_OK;
+}
+
+/**
+  * @brief  Escribe una línea modificada en la tarjeta (bloqueante).
+  * @param  line: Línea a escribir.
+  * @retval Código de error de tipo sd_err_t
+  */
+static sd_err_t cache_writeback(cache_line_t *line)
+{
+	sd_err_t err = SD_write(line->block, line->data);
+	if (err == SD_OK)
+	{
+		line->dirty = false;
+		stats.writebacks++;
+	}
+	return err;
+}
+
+/**
+  * @brief  Espera a que termine la escritura en segundo plano en curso, si la hay.
+  * @retval Resultado de la escritura (SD_OK si no había ninguna en curso).
+  */
+static sd_err_t cache_wait_inflight(void)
+{
+	sd_err_t err;
+
+	if (inflight == NULL) return SD_OK;
+
+	do {
+		err = SD_writeProcess();
+	} while (err == SD_BUSY);
+
+	cache_complete(err);
+	return err;
+}
+
+/**
+  * @brief  Cierra la escritura en segundo plano de la línea en curso.
+  * @param  err: Resultado de la escritura. Si falló la línea queda modificada.
+  */
+static void cache_complete(sd_err_t err)
+{
+	if (err == SD_OK)
+	{
+		inflight->dirty = false;
+		stats.writebacks++;
+	}
+	inflight = NULL;
+}
+
+/**
+  * @brief  Marca una línea como la usada más recientemente.
+  */
+static void cache_touch(cache_line_t *line)
+{
+	line->last_use = ++use_counter;
+}
@@ -9,43 +9,161 @@
 
 #include "sd_card.h"
 
+#define SD_POWERUP_MS			1		// espera mínima desde el encendido antes de los ciclos de reloj
+#define SD_INIT_TIMEOUT_MS		1000	// ACMD41: la tarjeta debe inicializar en menos de 1 s
+#define SD_READ_TIMEOUT_MS		100		// espera máxima del token de datos
+#define SD_WRITE_TIMEOUT_MS		500		// espera máxima de fin de programación (SDHC/SDXC)
+#define SD_ERASE_TIMEOUT_MS		30000	// espera máxima de ERASE (crece con el tamaño del rango)
+#define SD_CMD_RETRIES			10
+
 static const uint8_t dummy = 0xFF;
 static const uint8_t start_token = 0xFE;
+static const uint8_t multi_start_token = 0xFC;
+static const uint8_t stop_tran_token = 0xFD;
+
+static bool stream_open = false;
+static uint32_t stream_start_us;
+
+typedef enum
+{
+	SD_ASYNC_IDLE,
+	SD_ASYNC_DATA,
+	SD_ASYNC_BUSY
+} sd_async_state_t;
+
+static sd_async_state_t async_state = SD_ASYNC_IDLE;
+static uint32_t async_start_ms;
+static uint32_t async_start_us;
+
+typedef enum
+{
+	SD_INIT_NONE,
+	SD_INIT_POWERUP,
+	SD_INIT_ACMD41,
+	SD_INIT_READY,
+	SD_INIT_FAILED
+} sd_init_state_t;
+
+static sd_init_state_t init_state = SD_INIT_NONE;
+static uint32_t init_start_ms;
+static sd_err_t init_err = SD_ERROR;
+
+static sd_card_info_t card_info;
+
+static sd_latency_t latency[SD_OP_COUNT];
 
 static void sd_dummy();
 static void send_dummy_clocks();
-static void waitBusy();
+static bool sd_expired(uint32_t start_ms, uint32_t timeout_ms);
+static sd_err_t sd_wait_ready(uint32_t timeout_ms);
 static uint8_t sd_send_cmd(uint8_t cmd, uint32_t arg, uint8_t crc, bool cs);
+static uint32_t sd_addr(uint32_t block_addr);
+static sd_err_t sd_receive_block(uint8_t *buffer, uint16_t len);
+static sd_err_t sd_send_block(uint8_t token, const uint8_t *buffer);
 static sd_err_t send_CMD0();
 static sd_err_t send_CMD8();
-static sd_err_t send_ACMD41(bool force);
+static sd_err_t send_CMD12();
+static uint8_t send_ACMD41();
+static uint8_t send_ACMD23(uint32_t count);
+static sd_err_t send_CMD58(uint32_t *ocr);
+static sd_err_t sd_read_register(uint8_t cmd, uint8_t *reg, uint16_t len);
+static sd_err_t sd_probe();
+static sd_err_t init_fail(sd_err_t err);
+static bool sd_locked();
+static sd_err_t async_finish(sd_err_t err);
+static void latency_record(sd_op_t op, uint32_t start_us);
 
 
 /* ====================  Funciones principales  ========================= */
 
 /**
-  * @brief  Inicializa la SD card en modo SPI.
-  * @note   Realiza el procedimiento CMD0 -> CMD8 -> ACMD41.
+  * @brief  Inicializa la SD card en modo SPI (bloqueante).
+  * @note   Realiza el procedimiento CMD0 -> CMD8 -> ACMD41 esperando a que termine.
+  * 		Para no demorar el arranque usar SD_initStart() / SD_initProcess().
   * @retval SD_OK: si la inicialización fue exitosa
-  * 		SD_ERROR: caso contrario.
+  * 		SD_ERROR / SD_TIMEOUT: caso contrario.
   */
 sd_err_t SD_init()
 {
-	send_dummy_clocks();
+	sd_err_t err;
 
-	if(send_CMD0() != SD_OK) return SD_ERROR;
+	SD_initStart();
+	do {
+		err = SD_initProcess();
+	} while (err == SD_BUSY);
 
-	sd_dummy();
+	return err;
+}
 
-	if(send_CMD8() != SD_OK) return SD_ERROR;
+/**
+  * @brief  Comienza la inicialización no bloqueante de la SD card.
+  * @note	La inicialización avanza con cada llamada a SD_initProcess(), que debe hacerse
+  * 		periódicamente desde el superloop. Cada llamada ocupa el bus solo durante un comando.
+  */
+void SD_initStart(void)
+{
+	cs_High();
+	memset(&card_info, 0, sizeof(card_info));
+	card_info.clock_hz = sd_SetClock(SD_INIT_CLOCK_HZ);
+	init_state = SD_INIT_POWERUP;
+	init_start_ms = sd_GetTick();
+}
 
-	sd_dummy();
+/**
+  * @brief  Avanza la inicialización no bloqueante de la SD card.
+  * @note	1- Espera el tiempo mínimo de encendido sin bloquear y envía los ciclos de reloj iniciales.
+  * 		2- CMD0 y CMD8.
+  * 		3- Un intento de CMD55 + ACMD41 por llamada hasta que la tarjeta salga de IDLE
+  * 		   o venza el deadline de inicialización.
+  * 		4- Lee OCR, CSD y CID (ver SD_getCardInfo()) y sube el reloj SPI al máximo admitido.
+  * @retval SD_BUSY: la inicialización está en curso.
+  * 		SD_OK: la tarjeta está lista.
+  * 		SD_ERROR / SD_TIMEOUT: la inicialización falló (se puede reintentar con SD_initStart()).
+  */
+sd_err_t SD_initProcess(void)
+{
+	switch (init_state)
+	{
+		case SD_INIT_POWERUP:
+		{
+			if (!sd_expired(init_start_ms, SD_POWERUP_MS)) return SD_BUSY;
 
-	send_ACMD41(false);
+			send_dummy_clocks();
 
-	sd_dummy();
+			if (send_CMD0() != SD_OK) return init_fail(SD_ERROR);
+			sd_dummy();
 
-	return SD_OK;
+			if (send_CMD8() != SD_OK) return init_fail(SD_ERROR);
+			sd_dummy();
+
+			init_state = SD_INIT_ACMD41;
+			init_start_ms = sd_GetTick();
+			return SD_BUSY;
+		}
+
+		case SD_INIT_ACMD41:
+		{
+			if (send_ACMD41() == 0x00)
+			{
+				if (sd_probe() != SD_OK) return init_fail(SD_ERROR);
+				init_state = SD_INIT_READY;
+				return SD_OK;
+			}
+			if (sd_expired(init_start_ms, SD_INIT_TIMEOUT_MS)) return init_fail(SD_TIMEOUT);
+
+			return SD_BUSY;
+		}
+
+		case SD_INIT_READY:
+			return SD_OK;
+
+		case SD_INIT_FAILED:
+			return init_err;
+
+		case SD_INIT_NONE:
+		default:
+			return SD_ERROR;
+	}
 }
 
 /**
@@ -53,160 +171,518 @@ sd_err_t SD_init()
   * @note	1- Ejecuta CMD17 (READ_SINGLE_BLOCK). La SD card debe responder con el token de inicio
   * 		de datos (0xFE) para confirmar lectura.
   * 		2- Se recibe un bloque (512 bytes) y 2 bytes de CRC (se descartan)
-  * 		3- Se envia dummy para asegurar estabilidad.
+  * 		3- Se envia dummy para liberar la línea MISO.
+  * 		Las esperas se resuelven consultando la tarjeta contra un deadline, sin retardos fijos.
   * @param  block_addr: Dirección del bloque a leer
   * @param  buffer: Puntero al buffer de destino.
   * @retval SD_OK: si la lectura fue exitosa.
-  * 		SD_ERROR: caso contrario.
+  * 		SD_BUSY: si hay otra operación en curso.
+  * 		SD_ERROR / SD_TIMEOUT: caso contrario.
   */
 sd_err_t SD_read(uint32_t block_addr, uint8_t *buffer)
 {
-	uint8_t token;
-	uint8_t crc;
+	if (sd_locked()) return SD_BUSY;
 
-	sd_dummy();
-	sd_dummy();
-	sd_dummy();
+	uint32_t t0 = sd_GetMicros();
 
-	if (sd_send_cmd(CMD17, block_addr, 0x01, true) != 0x00)
+	if (sd_send_cmd(CMD17, sd_addr(block_addr), 0x01, false) != 0x00)
 	{
+		cs_High();
 		return SD_ERROR;
 	}
 
-	cs_Low();
-	for (int i = 0; i < 10000; i++) {
-		sd_TransmitReceive(&dummy, &token, 1);
-		if (token == 0xFE) break;
-	}
-
-	sd_Receive(buffer, SD_BLOCK_SIZE);
-	// discard CRC
-	sd_Receive(&crc, 1);
-	sd_Receive(&crc, 1);
+	sd_err_t err = sd_receive_block(buffer, SD_BLOCK_SIZE);
 	cs_High();
 
-	waitBusy();
-
-	sd_dummy();
-	sd_dummy();
 	sd_dummy();
 
-	return SD_OK;
+	if (err == SD_OK) latency_record(SD_OP_READ, t0);
+
+	return err;
 }
 
 /**
   * @brief  Escribe un bloque de datos en la SD card en modo SPI.
-  * @note	1- Envia comando CMD55 + ACMD41 para despertar la SD en caso que haya quedado en estado IDLE.
-  *  		2- Ejecuta CMD24 (WRITE_BLOCK). Debe responder 0x00.
-  *  		3- Se envía un token de inicio de escritura (0xFE).
-  *  		4- Se transmite el bloque de datos y un CRC (puede ser falso).
-  *  		5- Se recibe respuesta de aceptación. LSB debe ser 0x05 para indicar éxito.
-  *  		6- Se espera que termine la escritura con waitBusy().
+  * @note	1- Ejecuta CMD24 (WRITE_BLOCK) una vez que la tarjeta está libre. Debe responder 0x00.
+  *  		2- Se envía un token de inicio de escritura (0xFE).
+  *  		3- Se transmite el bloque de datos y un CRC (puede ser falso).
+  *  		4- Se recibe respuesta de aceptación. LSB debe ser 0x05 para indicar éxito.
+  *  		5- Se consulta la línea de busy hasta que termine la programación o venza el deadline.
   * @param  block_addr: Dirección del bloque donde se escribirá la información.
   * @param  buffer: Puntero al buffer de origen que contiene los 512 bytes a escribir.
   * @retval SD_OK: si la escritura fue aceptada y completada.
+  * 		SD_BUSY: si hay otra operación en curso.
   *			SD_ERROR: si la respuesta fue negativa o si el token fue rechazado.
   */
 sd_err_t SD_write(uint32_t block_addr, const uint8_t *buffer)
 {
-	waitBusy();
+	if (sd_locked()) return SD_BUSY;
+
+	uint32_t t0 = sd_GetMicros();
+
+	if (sd_send_cmd(CMD24, sd_addr(block_addr), 0x01, false) != 0x00)
+	{
+		cs_High();
+		return SD_ERROR;
+	}
+
+	sd_err_t err = sd_send_block(start_token, buffer);
+	cs_High();
+
+	sd_dummy();
+
+	if (err == SD_OK) latency_record(SD_OP_WRITE, t0);
+
+	return err;
+}
+
+
+/**
+  * @brief  Borra un bloque de la SD card.
+  * @note	Ver SD_eraseRange().
+  * @param  block_addr: Dirección del bloque a borrar.
+  * @retval SD_OK: si la operación fue exitosa
+  * 		SD_ERROR: caso contrario.
+  */
+sd_err_t SD_erase(uint32_t block_addr)
+{
+	return SD_eraseRange(block_addr, block_addr);
+}
 
-	send_ACMD41(true);
+/**
+  * @brief  Borra un rango de bloques de la SD card con un único comando.
+  * @note	1- CMD32 (ERASE_WR_BLK_START) y CMD33 (ERASE_WR_BLK_END) fijan el rango.
+  * 		2- CMD38 (ERASE) borra el rango; la tarjeta queda ocupada (R1b) hasta terminar.
+  * 		La tarjeta borra unidades completas internamente, por lo que el tiempo casi no depende
+  * 		de la cantidad de bloques. Los bloques borrados se leen con el valor
+  * 		SD_getCardInfo()->erased_byte (0x00 o 0xFF según la tarjeta).
+  * 		No pasa por la cache de bloques: ver SD_cacheInvalidateRange().
+  * @param  first_block: Primer bloque del rango.
+  * @param  last_block: Último bloque del rango (inclusive).
+  * @retval SD_OK: si el rango quedó borrado.
+  * 		SD_BUSY: si hay otra operación en curso.
+  * 		SD_ERROR / SD_TIMEOUT: caso contrario.
+  */
+sd_err_t SD_eraseRange(uint32_t first_block, uint32_t last_block)
+{
+	if (last_block < first_block) return SD_ERROR;
+	if (sd_locked()) return SD_BUSY;
 
+	if (sd_send_cmd(CMD32, sd_addr(first_block), 0x01, true) != 0x00) return SD_ERROR;
 	sd_dummy();
+
+	if (sd_send_cmd(CMD33, sd_addr(last_block), 0x01, true) != 0x00) return SD_ERROR;
 	sd_dummy();
 
-	cs_Low();
-	uint8_t ret = sd_send_cmd(CMD24, block_addr, 0x01, false);
-	if (ret != 0x00) {
+	if (sd_send_cmd(CMD38, 0, 0x01, false) != 0x00)
+	{
 		cs_High();
 		return SD_ERROR;
 	}
 
-	sd_Transmit(&start_token, 1);
-	sd_Transmit((uint8_t *)buffer, SD_BLOCK_SIZE);
-	uint8_t crc[2] = {0xFF, 0xFF};
-	sd_Transmit(crc, 2);
+	sd_err_t err = sd_wait_ready(SD_ERASE_TIMEOUT_MS);
+	cs_High();
 
-	uint8_t resp;
-	sd_TransmitReceive(&dummy, &resp, 1);
-	if ((resp & 0x1F) != 0x05) {
+	sd_dummy();
+
+	return err;
+}
+
+/* ====================  Transferencias multi-bloque  ==================== */
+
+/**
+  * @brief  Lee varios bloques consecutivos de la SD card en modo SPI.
+  * @note	1- Ejecuta CMD18 (READ_MULTIPLE_BLOCK) manteniendo CS en bajo.
+  * 		2- Por cada bloque espera el token de inicio (0xFE), recibe 512 bytes y descarta el CRC.
+  * 		3- Finaliza la transferencia con CMD12 (STOP_TRANSMISSION).
+  * 		Se paga el overhead de comando una sola vez para todos los bloques.
+  * @param  block_addr: Dirección del primer bloque a leer.
+  * @param  buffer: Puntero al buffer de destino (count * 512 bytes).
+  * @param  count: Cantidad de bloques a leer.
+  * @retval SD_OK: si la lectura fue exitosa.
+  * 		SD_ERROR: caso contrario.
+  */
+sd_err_t SD_readMulti(uint32_t block_addr, uint8_t *buffer, uint32_t count)
+{
+	if (count == 0) return SD_OK;
+	if (count == 1) return SD_read(block_addr, buffer);
+	if (sd_locked()) return SD_BUSY;
+
+	uint32_t t0 = sd_GetMicros();
+
+	if (sd_send_cmd(CMD18, sd_addr(block_addr), 0x01, false) != 0x00)
+	{
 		cs_High();
 		return SD_ERROR;
 	}
 
+	sd_err_t err = SD_OK;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		err = sd_receive_block(&buffer[i * SD_BLOCK_SIZE], SD_BLOCK_SIZE);
+		if (err != SD_OK) break;
+	}
+
+	if (send_CMD12() != SD_OK) err = SD_ERROR;
 	cs_High();
 
-	waitBusy();
+	sd_dummy();
 
-	return SD_OK;
+	if (err == SD_OK) latency_record(SD_OP_READ_MULTI, t0);
+
+	return err;
 }
 
+/**
+  * @brief  Escribe varios bloques consecutivos en la SD card en modo SPI.
+  * @note	Utiliza la API de streaming (CMD25 + token 0xFC por bloque + token 0xFD de fin),
+  * 		informando antes la cantidad de bloques para que la tarjeta los pre-borre (ACMD23).
+  * @param  block_addr: Dirección del primer bloque a escribir.
+  * @param  buffer: Puntero al buffer de origen (count * 512 bytes).
+  * @param  count: Cantidad de bloques a escribir.
+  * @retval SD_OK: si todos los bloques fueron aceptados y la tarjeta terminó de programarlos.
+  * 		SD_ERROR: caso contrario.
+  */
+sd_err_t SD_writeMulti(uint32_t block_addr, const uint8_t *buffer, uint32_t count)
+{
+	if (count == 0) return SD_OK;
+	if (count == 1) return SD_write(block_addr, buffer);
+
+	sd_err_t err = SD_streamOpenPreErase(block_addr, count);
+	if (err != SD_OK) return err;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		err = SD_streamAppend(&buffer[i * SD_BLOCK_SIZE]);
+		if (err != SD_OK) break;
+	}
+
+	if (SD_streamClose() != SD_OK) err = SD_ERROR;
+
+	return err;
+}
 
 /**
-  * @brief  Borra (sobrescribe) un bloque de la SD card con 0xFF.
-  * @param  block_addr: Dirección del bloque a sobrescribir.
-  * @retval SD_OK: si la operación fue exitosa
+  * @brief  Abre un stream de escritura secuencial a partir de un bloque.
+  * @note	Envía CMD25 (WRITE_MULTIPLE_BLOCK) y deja CS en bajo. Los bloques se agregan
+  * 		con SD_streamAppend() y el stream se cierra con SD_streamClose().
+  * 		Mientras el stream está abierto no se pueden usar las demás funciones del driver.
+  * @param  block_addr: Dirección del primer bloque del stream.
+  * @retval SD_OK: si la tarjeta aceptó el comando.
+  * 		SD_BUSY: si ya hay un stream abierto.
   * 		SD_ERROR: caso contrario.
   */
-sd_err_t SD_erase(uint32_t block_addr)
+sd_err_t SD_streamOpen(uint32_t block_addr)
+{
+	if (sd_locked()) return SD_BUSY;
+
+	stream_start_us = sd_GetMicros();
+
+	if (sd_send_cmd(CMD25, sd_addr(block_addr), 0x01, false) != 0x00)
+	{
+		cs_High();
+		return SD_ERROR;
+	}
+
+	stream_open = true;
+	return SD_OK;
+}
+
+/**
+  * @brief  Abre un stream de escritura indicando cuántos bloques se van a escribir.
+  * @note	Envía CMD55 + ACMD23 (SET_WR_BLK_ERASE_COUNT) antes de CMD25, para que la tarjeta
+  * 		borre de antemano los bloques y programe más rápido. Es solo una sugerencia: si la
+  * 		tarjeta no la acepta el stream se abre igual, y se pueden escribir más o menos bloques.
+  * @param  block_addr: Dirección del primer bloque del stream.
+  * @param  count: Cantidad de bloques que se prevé escribir (hasta 2^23 - 1).
+  * @retval Ídem SD_streamOpen().
+  */
+sd_err_t SD_streamOpenPreErase(uint32_t block_addr, uint32_t count)
+{
+	if (sd_locked()) return SD_BUSY;
+
+	if (count > 0) send_ACMD23(count);
+
+	return SD_streamOpen(block_addr);
+}
+
+/**
+  * @brief  Agrega un bloque de 512 bytes al stream de escritura abierto.
+  * @note	Transmite token 0xFC + datos + CRC y espera a que la tarjeta termine de programar el bloque.
+  * @param  buffer: Puntero al bloque a escribir.
+  * @retval SD_OK: si el bloque fue aceptado.
+  * 		SD_ERROR: si no hay stream abierto o la tarjeta rechazó el bloque.
+  */
+sd_err_t SD_streamAppend(const uint8_t *buffer)
+{
+	if (!stream_open) return SD_ERROR;
+
+	return sd_send_block(multi_start_token, buffer);
+}
+
+/**
+  * @brief  Cierra el stream de escritura abierto.
+  * @note	Envía el token STOP_TRAN (0xFD) y espera a que la tarjeta se libere.
+  * @retval SD_OK: si el stream se cerró correctamente.
+  * 		SD_ERROR: si no había stream abierto o la tarjeta no se liberó.
+  */
+sd_err_t SD_streamClose(void)
+{
+	if (!stream_open) return SD_ERROR;
+
+	stream_open = false;
+
+	sd_Transmit(&stop_tran_token, 1);
+	sd_Transmit(&dummy, 1); // byte de espera antes del busy
+
+	sd_err_t err = sd_wait_ready(SD_WRITE_TIMEOUT_MS);
+	cs_High();
+
+	sd_dummy();
+
+	if (err == SD_OK) latency_record(SD_OP_WRITE_MULTI, stream_start_us);
+
+	return err;
+}
+
+/* ====================  Escritura no bloqueante  ======================== */
+
+/**
+  * @brief  Inicia la escritura no bloqueante de un bloque en la SD card.
+  * @note	Envía CMD24 y el token de inicio, y deja la transmisión de los 512 bytes a cargo del DMA.
+  * 		El resto de la operación (CRC, respuesta de aceptación y espera de fin de programación)
+  * 		avanza con cada llamada a SD_writeProcess(), sin bloquear el superloop.
+  * 		El buffer debe permanecer sin modificar hasta que la escritura termine (SD_writeBusy() == false).
+  * @param  block_addr: Dirección del bloque donde se escribirá la información.
+  * @param  buffer: Puntero al buffer de origen que contiene los 512 bytes a escribir.
+  * @retval SD_OK: si la escritura quedó en curso.
+  * 		SD_BUSY: si hay otra operación en curso.
+  *			SD_ERROR: si la tarjeta rechazó el comando o no se pudo iniciar el DMA.
+  */
+sd_err_t SD_writeStart(uint32_t block_addr, const uint8_t *buffer)
 {
-    uint8_t buffer[SD_BLOCK_SIZE];
-    memset(buffer, 0xFF, sizeof(buffer));
+	if (sd_locked()) return SD_BUSY;
+
+	async_start_us = sd_GetMicros();
+
+	if (sd_send_cmd(CMD24, sd_addr(block_addr), 0x01, false) != 0x00)
+	{
+		cs_High();
+		return SD_ERROR;
+	}
+
+	sd_Transmit(&start_token, 1);
+	if (sd_TransmitDMA(buffer, SD_BLOCK_SIZE) != SD_OK)
+	{
+		cs_High();
+		return SD_ERROR;
+	}
 
-    return SD_write(block_addr, buffer);
+	async_state = SD_ASYNC_DATA;
+	return SD_OK;
+}
+
+/**
+  * @brief  Avanza la escritura no bloqueante en curso. Debe llamarse periódicamente.
+  * @note	Cada llamada realiza a lo sumo una transferencia corta (CRC + respuesta o un byte de
+  * 		consulta de busy), por lo que el tiempo de ejecución es acotado.
+  * @retval SD_BUSY: la escritura sigue en curso.
+  * 		SD_OK: la escritura terminó correctamente en esta llamada, o no hay escritura en curso.
+  * 		SD_ERROR / SD_TIMEOUT: la escritura terminó con error en esta llamada.
+  */
+sd_err_t SD_writeProcess(void)
+{
+	switch (async_state)
+	{
+		case SD_ASYNC_IDLE:
+			return SD_OK;
+
+		case SD_ASYNC_DATA:
+		{
+			sd_err_t status = sd_TransferStatus();
+			if (status == SD_BUSY) return SD_BUSY;
+			if (status != SD_OK) return async_finish(SD_ERROR);
+
+			uint8_t crc[2] = {0xFF, 0xFF};
+			uint8_t resp;
+			sd_Transmit(crc, 2);
+			sd_TransmitReceive(&dummy, &resp, 1);
+			if ((resp & 0x1F) != 0x05) return async_finish(SD_ERROR);
+
+			async_start_ms = sd_GetTick();
+			async_state = SD_ASYNC_BUSY;
+			return SD_BUSY;
+		}
+
+		case SD_ASYNC_BUSY:
+		{
+			uint8_t resp;
+			sd_TransmitReceive(&dummy, &resp, 1);
+			if (resp == 0xFF)
+			{
+				latency_record(SD_OP_WRITE, async_start_us);
+				return async_finish(SD_OK);
+			}
+			if (sd_expired(async_start_ms, SD_WRITE_TIMEOUT_MS)) return async_finish(SD_TIMEOUT);
+			return SD_BUSY;
+		}
+	}
+
+	return SD_ERROR;
+}
+
+/**
+  * @brief  Indica si hay una escritura no bloqueante en curso.
+  * @retval true: escritura en curso (el buffer no debe modificarse).
+  * 		false: caso contrario.
+  */
+bool SD_writeBusy(void)
+{
+	return async_state != SD_ASYNC_IDLE;
+}
+
+/* ====================  Información de la tarjeta  ====================== */
+
+/**
+  * @brief  Devuelve la información de la tarjeta leída en la inicialización.
+  * @note	Los campos son válidos una vez que SD_initProcess() devolvió SD_OK.
+  * @retval Puntero a la información de la tarjeta.
+  */
+const sd_card_info_t *SD_getCardInfo(void)
+{
+	return &card_info;
+}
+
+/* ====================  Estadísticas de latencia  ======================= */
+
+/**
+  * @brief  Devuelve el histograma de latencias de un tipo de operación.
+  * @note	Se registran solo las operaciones completadas con éxito, desde el envío del
+  * 		comando hasta que la tarjeta queda libre.
+  * @param  op: Tipo de operación (SD_OP_READ, SD_OP_WRITE, ...).
+  * @retval Puntero a las estadísticas de la operación (NULL si op es inválido).
+  */
+const sd_latency_t *SD_getLatency(sd_op_t op)
+{
+	if (op >= SD_OP_COUNT) return NULL;
+	return &latency[op];
+}
+
+/**
+  * @brief  Reinicia los histogramas de latencia de todas las operaciones.
+  */
+void SD_resetLatency(void)
+{
+	memset(latency, 0, sizeof(latency));
 }
 
 /* =====================  Utilidad y control  =========================== */
 
+/**
+  * @brief  Indica si el bus está tomado por un stream abierto o una escritura no bloqueante.
+  */
+static bool sd_locked()
+{
+	return stream_open || async_state != SD_ASYNC_IDLE;
+}
+
+/**
+  * @brief  Finaliza la escritura no bloqueante liberando CS.
+  * @param  err: Resultado de la operación.
+  * @retval El mismo resultado recibido.
+  */
+static sd_err_t async_finish(sd_err_t err)
+{
+	cs_High();
+	sd_dummy();
+	async_state = SD_ASYNC_IDLE;
+	return err;
+}
+
+/**
+  * @brief  Registra la latencia de una operación en su histograma.
+  * @param  op: Tipo de operación.
+  * @param  start_us: Marca de tiempo (us) del inicio de la operación.
+  */
+static void latency_record(sd_op_t op, uint32_t start_us)
+{
+	uint32_t us = sd_GetMicros() - start_us;
+	sd_latency_t *l = &latency[op];
+
+	uint8_t b = 0;
+	while ((b < SD_LATENCY_BUCKETS - 1) && (us >> (b + 6))) b++;
+	l->hist[b]++;
+
+	if (l->count == 0 || us < l->min_us) l->min_us = us;
+	if (us > l->max_us) l->max_us = us;
+	l->total_us += us;
+	l->count++;
+}
+
 /**
   * @brief  Envía un byte dummy (0xFF) por SPI manteniendo CS en alto.
   * @note   Necesario luego de completar un comando. Genera 8 ciclos de clock dummy
-  * 		para que la tarjeta SD pueda completar procesos internos. Mantiene la linea
-  * 		SPI activa.
+  * 		para que la tarjeta SD libere la línea MISO.
   */
 static void sd_dummy()
 {
 	cs_High();
 	sd_Transmit(&dummy, 1);
-	sd_Delay(1);
 }
 
 /**
   * @brief  Envía 80 ciclos de reloj (10 bytes dummy) con CS alto.
   * @note   Requerido por el estándar de inicialización de tarjetas SD en modo SPI.
-  * 		Permite salir a la SD de modo reset y prepararse para recibir comandos
+  * 		Permite salir a la SD de modo reset y prepararse para recibir comandos.
+  * 		La espera mínima luego del encendido la resuelve SD_initProcess().
   */
 static void send_dummy_clocks()
 {
 	cs_High();
-	sd_Delay(10);
 	for (int i = 0; i < 10; i++) {
-		cs_High();
 		sd_Transmit(&dummy, 1);
 	}
 }
 
 /**
-  * @brief  Espera hasta que la SD card se libere.
-  * @note   Envía dummy hasta recibir una respuesta distinta de 0x00.
+  * @brief  Indica si venció un deadline en milisegundos.
+  * @param  start_ms: Tick de inicio.
+  * @param  timeout_ms: Duración máxima.
   */
-static void waitBusy()
+static bool sd_expired(uint32_t start_ms, uint32_t timeout_ms)
+{
+	return (sd_GetTick() - start_ms) >= timeout_ms;
+}
+
+/**
+  * @brief  Espera con CS en bajo a que la SD card quede libre.
+  * @note   Mientras programa, la tarjeta mantiene MISO en 0x00. Se considera libre al recibir 0xFF.
+  * 		Se consulta byte a byte (sin retardos) hasta que la tarjeta se libere o venza el deadline.
+  * @param  timeout_ms: Tiempo máximo de espera.
+  * @retval SD_OK: si la tarjeta quedó libre.
+  * 		SD_TIMEOUT: si venció el deadline.
+  */
+static sd_err_t sd_wait_ready(uint32_t timeout_ms)
 {
 	uint8_t resp;
+	uint32_t start = sd_GetTick();
 	do {
-		cs_High();
 		sd_TransmitReceive(&dummy, &resp, 1);
-		sd_Delay(1);
-	} while (resp == 0x00);
+		if (resp == 0xFF) return SD_OK;
+	} while (!sd_expired(start, timeout_ms));
+
+	return SD_TIMEOUT;
 }
 
 /**
   * @brief  Envía un comando a la SD card en modo SPI.
+  * @note   Baja CS y, salvo para CMD0, espera que la tarjeta esté libre antes de enviar el comando.
+  * 		La respuesta R1 llega dentro de los 8 bytes siguientes (NCR).
   * @param  cmd: Comando.
   * @param  arg: Argumento de 32 bits del comando.
   * @param  crc: CRC del comando (obligatorio solo para algunos comandos).
-  * @retval Respuesta R1 del comando (byte de estado).
+  * @param  cs: Si es true se libera CS luego de la respuesta.
+  * @retval Respuesta R1 del comando (byte de estado). 0xFF si la tarjeta no respondió.
   */
 static uint8_t sd_send_cmd(uint8_t cmd, uint32_t arg, uint8_t crc, bool cs)
 {
@@ -222,18 +698,87 @@ static uint8_t sd_send_cmd(uint8_t cmd, uint32_t arg, uint8_t crc, bool cs)
 
     cs_Low();
 
+    if (cmd != CMD0 && sd_wait_ready(SD_WRITE_TIMEOUT_MS) != SD_OK)
+    {
+    	if(cs) cs_High();
+    	return resp;
+    }
+
     if(sd_Transmit(buf, 6) == SD_OK) // envia comando
     {
 		for (int i = 0; i < 10; i++) {
 			sd_TransmitReceive(&dummy, &resp, 1); // espera respuesta
 			if ((resp & 0x80) == 0) break;
 		}
-		if(cs) cs_High();
     }
+    if(cs) cs_High();
 
     return resp;
 }
 
+/**
+  * @brief  Convierte un número de bloque en el argumento de los comandos de lectura/escritura.
+  * @note   Las tarjetas SDSC se direccionan por byte; SDHC/SDXC por bloque.
+  */
+static uint32_t sd_addr(uint32_t block_addr)
+{
+	return card_info.type == SD_TYPE_SDHC ? block_addr : block_addr * SD_BLOCK_SIZE;
+}
+
+/**
+  * @brief  Recibe un bloque de datos de una transferencia de lectura en curso (CS en bajo).
+  * @note   Espera el token de inicio 0xFE contra un deadline, recibe los datos y descarta
+  * 		los 2 bytes de CRC.
+  * @param  buffer: Puntero al buffer de destino.
+  * @param  len: Cantidad de bytes del bloque (512, o 16 para los registros CSD/CID).
+  * @retval SD_OK: si se recibió el bloque.
+  * 		SD_ERROR: si la tarjeta respondió con un token de error.
+  * 		SD_TIMEOUT: si no llegó el token de inicio.
+  */
+static sd_err_t sd_receive_block(uint8_t *buffer, uint16_t len)
+{
+	uint8_t token;
+	uint8_t crc[2];
+	uint32_t start = sd_GetTick();
+
+	do {
+		sd_TransmitReceive(&dummy, &token, 1);
+		if (token == start_token) break;
+		if (token != 0xFF) return SD_ERROR; // data error token (0000xxxx)
+	} while (!sd_expired(start, SD_READ_TIMEOUT_MS));
+
+	if (token != start_token) return SD_TIMEOUT;
+
+	sd_Receive(buffer, len);
+	sd_Receive(crc, 2);
+
+	return SD_OK;
+}
+
+/**
+  * @brief  Envía un bloque de datos de una transferencia de escritura en curso (CS en bajo).
+  * @note   Transmite token + 512 bytes + CRC (falso), verifica la respuesta de aceptación
+  * 		(xxx00101) y espera a que la tarjeta termine de programar.
+  * @param  token: Token de inicio (0xFE para CMD24, 0xFC para CMD25).
+  * @param  buffer: Puntero al bloque a transmitir.
+  * @retval SD_OK: si el bloque fue aceptado y programado.
+  * 		SD_ERROR: caso contrario.
+  */
+static sd_err_t sd_send_block(uint8_t token, const uint8_t *buffer)
+{
+	uint8_t crc[2] = {0xFF, 0xFF};
+	uint8_t resp;
+
+	sd_Transmit(&token, 1);
+	sd_Transmit(buffer, SD_BLOCK_SIZE);
+	sd_Transmit(crc, 2);
+
+	sd_TransmitReceive(&dummy, &resp, 1);
+	if ((resp & 0x1F) != 0x05) return SD_ERROR;
+
+	return sd_wait_ready(SD_WRITE_TIMEOUT_MS) == SD_OK ? SD_OK : SD_ERROR;
+}
+
 /* ====================  Comandos específicos  ========================== */
 
 /**
@@ -246,12 +791,10 @@ static uint8_t sd_send_cmd(uint8_t cmd, uint32_t arg, uint8_t crc, bool cs)
   */
 static sd_err_t send_CMD0()
 {
-	uint8_t tries = 10;
-
-	for (int i = 0; i < tries; i++) {
+	for (int i = 0; i < SD_CMD_RETRIES; i++) {
 		uint8_t resp = sd_send_cmd(CMD0, 0, 0x95, true);
 		if (resp == 0x01) return SD_OK;
-		sd_Delay(10);
+		sd_dummy();
 	}
 	return SD_ERROR;
 }
@@ -270,61 +813,196 @@ static sd_err_t send_CMD0()
 static sd_err_t send_CMD8()
 {
 	uint8_t r7[4];
-	uint8_t resp = sd_send_cmd(CMD8, 0x1AA, 0x87, true);
-	cs_Low();
-	if(resp == 0x01)
+	uint8_t resp = sd_send_cmd(CMD8, 0x1AA, 0x87, false);
+	if(resp != 0x01)
 	{
-		for (int i = 0; i < 4; i++) {
-		    uint8_t b = 0xFF;
-		    uint16_t timeout = 1000;
-		    while (b == 0xFF && timeout--) {
-		        sd_TransmitReceive(&dummy, &b, 1);
-		    }
-		    r7[i] = b;
-		}
-
 		cs_High();
+		return SD_ERROR;
+	}
+
+	sd_Receive(r7, 4); // R7 llega inmediatamente después de R1
+	cs_High();
+
+	uint16_t echo = ((r7[2] & 0x0F) << 8) | r7[3];
+	if (echo != 0x1AA) return SD_ERROR;
+
+	return SD_OK;
+}
 
-		uint16_t echo = (r7[2] << 8) | r7[3];
-		if (echo != 0x1AA) return SD_ERROR;
+/**
+  * @brief  Envía comando CMD12 (STOP_TRANSMISSION) para finalizar una lectura multi-bloque.
+  * @note   Se llama con CS en bajo. El byte siguiente al comando es un "stuff byte" y se descarta
+  * 		antes de esperar la respuesta R1. Luego la tarjeta puede quedar ocupada.
+  * @retval SD_OK: si la respuesta R1 es válida y la tarjeta quedó libre.
+  *         SD_ERROR: caso contrario
+  */
+static sd_err_t send_CMD12()
+{
+	uint8_t buf[6] = {CMD12, 0x00, 0x00, 0x00, 0x00, 0x01};
+	uint8_t resp = 0xFF;
 
-		return SD_OK;
+	sd_Transmit(buf, 6);
+	sd_TransmitReceive(&dummy, &resp, 1); // stuff byte
+
+	for (int i = 0; i < 10; i++) {
+		sd_TransmitReceive(&dummy, &resp, 1);
+		if ((resp & 0x80) == 0) break;
 	}
-	else
+	if (resp != 0x00) return SD_ERROR;
+
+	return sd_wait_ready(SD_WRITE_TIMEOUT_MS);
+}
+
+/**
+  * @brief  Envía la secuencia de comandos CMD55 + ACMD41 (un intento).
+  * @note   ACMD41 es el comando de inicialización usado por tarjetas SD versión 2.0 en adelante.
+  *         Debe ser precedido por CMD55 (APP_CMD) para indicar que el siguiente comando es una aplicación (ACMD).
+  *         SD_initProcess() lo repite hasta que la respuesta R1 sea 0x00 (indica card lista) o venza
+  *         el deadline de inicialización.
+  * @retval Respuesta R1 de ACMD41 (0x00 si la tarjeta está lista, 0x01 si sigue en IDLE).
+  */
+static uint8_t send_ACMD41()
+{
+	sd_send_cmd(CMD55, 0, 0x01, true); // no es necesario argumento
+
+	uint8_t resp = sd_send_cmd(ACMD41, 0x40000000, 0x01, true); // 0x40000000 -> bit HCS (Host Capacity Support) indica soporte a SDHC/SDXC.
+
+	sd_dummy();
+
+	return resp;
+}
+
+/**
+  * @brief  Envía la secuencia de comandos CMD55 + ACMD23 (SET_WR_BLK_ERASE_COUNT).
+  * @param  count: Cantidad de bloques a pre-borrar (23 bits).
+  * @retval Respuesta R1 de ACMD23 (0x00 si la tarjeta la aceptó).
+  */
+static uint8_t send_ACMD23(uint32_t count)
+{
+	sd_send_cmd(CMD55, 0, 0x01, true);
+
+	uint8_t resp = sd_send_cmd(ACMD23, count & 0x7FFFFF, 0x01, true);
+
+	sd_dummy();
+
+	return resp;
+}
+
+/**
+  * @brief  Envía comando CMD58 (READ_OCR).
+  * @note   La respuesta R3 es R1 seguido de los 4 bytes del OCR. Luego de ACMD41 el bit 30 (CCS)
+  * 		indica si la tarjeta es SDHC/SDXC (direccionamiento por bloque).
+  * @param  ocr: Puntero donde se almacena el OCR.
+  * @retval SD_OK: si la respuesta R1 es 0x00.
+  *         SD_ERROR: caso contrario
+  */
+static sd_err_t send_CMD58(uint32_t *ocr)
+{
+	uint8_t r3[4];
+	uint8_t resp = sd_send_cmd(CMD58, 0, 0x01, false);
+	if (resp != 0x00)
 	{
+		cs_High();
 		return SD_ERROR;
 	}
+
+	sd_Receive(r3, 4);
+	cs_High();
+
+	*ocr = ((uint32_t)r3[0] << 24) | ((uint32_t)r3[1] << 16) | ((uint32_t)r3[2] << 8) | r3[3];
+	return SD_OK;
 }
 
 /**
-  * @brief  Envía la secuencia de comandos CMD55 + ACMD41.
-  * @note   ACMD41 es el comando de inicialización usado por tarjetas SD versión 2.0 en adelante.
-  *         Debe ser precedido por CMD55 (APP_CMD) para indicar que el siguiente comando es una aplicación (ACMD).
-  *         Este comando debe repetirse hasta que la respuesta R1 sea 0x00 (indica card lista).
-  * @param  force: Si es true, fuerza solo un intento sin bucle de espera (modo "rápido").
-  * @retval SD_OK si la tarjeta fue inicializada correctamente, SD_TIMEOUT si se excedieron los intentos.
+  * @brief  Lee un registro de la tarjeta: CMD9 (SEND_CSD), CMD10 (SEND_CID) o ACMD51 (SEND_SCR).
+  * @note   En modo SPI el registro llega como un bloque de datos (token 0xFE + datos + CRC).
+  * 		Para ACMD51 se envía antes CMD55.
+  * @param  cmd: CMD9, CMD10 o ACMD51.
+  * @param  reg: Puntero al buffer de destino.
+  * @param  len: Tamaño del registro (16 bytes CSD/CID, 8 bytes SCR).
+  * @retval SD_OK: si se recibió el registro.
+  *         SD_ERROR / SD_TIMEOUT: caso contrario
   */
-static sd_err_t send_ACMD41(bool force)
+static sd_err_t sd_read_register(uint8_t cmd, uint8_t *reg, uint16_t len)
 {
-	uint8_t resp = 0xFF;
-	uint16_t tries = 10000;
-	do
+	if (cmd == ACMD51) sd_send_cmd(CMD55, 0, 0x01, true);
+
+	if (sd_send_cmd(cmd, 0, 0x01, false) != 0x00)
 	{
-		sd_send_cmd(CMD55, 0, 0x01, true); // no es necesario argumento
+		cs_High();
+		return SD_ERROR;
+	}
 
-		resp = sd_send_cmd(ACMD41, 0x40000000, 0x01, true); // 0x40000000 -> bit HCS (Host Capacity Support) indica soporte a SDHC/SDXC.
+	sd_err_t err = sd_receive_block(reg, len);
+	cs_High();
+	sd_dummy();
 
+	return err;
+}
+
+/**
+  * @brief  Lee OCR, CSD y CID de la tarjeta recién inicializada y ajusta el driver.
+  * @note	1- CMD58: tipo de tarjeta (CCS). Las SDSC se fijan en bloques de 512 bytes con CMD16.
+  * 		2- CMD9: capacidad y TRAN_SPEED (velocidad máxima del bus).
+  * 		3- CMD10: identificación de la tarjeta. ACMD51: valor de los bloques borrados.
+  * 		4- Sube el reloj SPI al máximo que admite la tarjeta.
+  * @retval SD_OK: si se leyeron los registros.
+  *         SD_ERROR: caso contrario
+  */
+static sd_err_t sd_probe()
+{
+	// TRAN_SPEED: unidad (100 kbit/s .. 100 Mbit/s) y multiplicador x10
+	static const uint32_t tran_unit[] = { 10000, 100000, 1000000, 10000000 };
+	static const uint8_t tran_mult[] = { 0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80 };
+
+	if (send_CMD58(&card_info.ocr) != SD_OK) return SD_ERROR;
+	sd_dummy();
+
+	card_info.type = (card_info.ocr & 0x40000000) ? SD_TYPE_SDHC : SD_TYPE_SDSC;
+
+	if (card_info.type == SD_TYPE_SDSC)
+	{
+		if (sd_send_cmd(CMD16, SD_BLOCK_SIZE, 0x01, true) != 0x00) return SD_ERROR;
 		sd_dummy();
+	}
 
-		tries--;
-		if(tries <= 0) {
-			return SD_TIMEOUT;
-		}
+	if (sd_read_register(CMD9, card_info.csd, sizeof(card_info.csd)) != SD_OK) return SD_ERROR;
+	if (sd_read_register(CMD10, card_info.cid, sizeof(card_info.cid)) != SD_OK) return SD_ERROR;
+	if (sd_read_register(ACMD51, card_info.scr, sizeof(card_info.scr)) != SD_OK) return SD_ERROR;
 
-		if(force) break;
-	} while (resp != 0x00);
+	const uint8_t *csd = card_info.csd;
+	if ((csd[0] >> 6) == 1) // CSD v2.0: C_SIZE de 22 bits en unidades de 512 KB
+	{
+		uint32_t c_size = ((uint32_t)(csd[7] & 0x3F) << 16) | ((uint32_t)csd[8] << 8) | csd[9];
+		card_info.blocks = (c_size + 1) * 1024;
+	}
+	else // CSD v1.0: (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) * 2^READ_BL_LEN bytes
+	{
+		uint32_t c_size = ((uint32_t)(csd[6] & 0x03) << 10) | ((uint32_t)csd[7] << 2) | (csd[8] >> 6);
+		uint8_t c_size_mult = ((csd[9] & 0x03) << 1) | (csd[10] >> 7);
+		uint8_t read_bl_len = csd[5] & 0x0F;
+		card_info.blocks = (c_size + 1) << (c_size_mult + 2 + read_bl_len - 9);
+	}
+
+	card_info.erased_byte = (card_info.scr[1] & 0x80) ? 0xFF : 0x00; // DATA_STAT_AFTER_ERASE (bit 55 del SCR)
+
+	card_info.max_clock_hz = tran_unit[csd[3] & 0x03] * tran_mult[(csd[3] >> 3) & 0x0F];
+	if (card_info.max_clock_hz == 0) card_info.max_clock_hz = SD_INIT_CLOCK_HZ;
+
+	card_info.clock_hz = sd_SetClock(card_info.max_clock_hz);
 
 	return SD_OK;
 }
 
-
+/**
+  * @brief  Marca la inicialización como fallida.
+  * @param  err: Código de error a informar.
+  * @retval err
+  */
+static sd_err_t init_fail(sd_err_t err)
+{
+	cs_High();
+	init_state = SD_INIT_FAILED;
+	init_err = err;
+	return err;
+}
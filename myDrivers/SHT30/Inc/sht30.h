@@ -37,18 +37,112 @@ typedef enum{
 	SHT30_MPS_10
 } sht30_mps_t;
 
+/*
+ * Límites de alerta: el sensor los compara con cada medición del modo periódico y mantiene el pin
+ * ALERT en alto desde que T o HR pasan un límite SET hasta que vuelven a estar entre los CLEAR.
+ */
+typedef enum{
+	SHT30_ALERT_HIGH_SET,
+	SHT30_ALERT_HIGH_CLEAR,
+	SHT30_ALERT_LOW_CLEAR,
+	SHT30_ALERT_LOW_SET
+} sht30_alert_limit_t;
+
+// bits del registro de estado (SHT30_readStatus)
+#define SHT30_STATUS_ALERT_PENDING	0x8000	// hay al menos una alerta pendiente
+#define SHT30_STATUS_HEATER_ON		0x2000
+#define SHT30_STATUS_HUM_ALERT		0x0800
+#define SHT30_STATUS_TEMP_ALERT		0x0400
+#define SHT30_STATUS_RESET			0x0010	// reset (alimentación o soft reset) desde el último clear
+#define SHT30_STATUS_CMD_FAIL		0x0002	// el último comando no se ejecutó
+#define SHT30_STATUS_WRITE_CRC_FAIL	0x0001	// CRC incorrecto en la última escritura de datos
+
+#define SHT30_ADDR_DEFAULT		0x44	// ADDR a GND
+#define SHT30_ADDR_ALT			0x45	// ADDR a VDD
+
+/*
+ * Bus I2C del sensor: índice en la tabla de buses de port.c (hoy solo I2C1, PB8/PB9).
+ * Los sensores de un mismo bus comparten el periférico: mientras uno transfiere, los demás
+ * reciben SHT30_BUSY y reintentan en la próxima llamada.
+ */
+#define SHT30_BUS_I2C1			0
+
+typedef enum
+{
+	SHT30_ASYNC_IDLE,
+	SHT30_ASYNC_COMMAND,	// comando de medición en el bus
+	SHT30_ASYNC_MEASURING,	// el sensor está midiendo
+	SHT30_ASYNC_READING		// lectura de la trama en el bus
+} sht30_async_t;
+
+/*
+ * Medición decodificada: ticks crudos y su conversión en punto fijo (centésimas), sin float.
+ */
+typedef struct
+{
+	uint16_t raw_temp;
+	uint16_t raw_hum;
+	int16_t temp_centi;					// centésimas de °C (-4500 a 13000)
+	uint16_t hum_centi;					// centésimas de %HR (0 a 10000)
+} sht30_measurement_t;
+
+/*
+ * Instancia del driver, una por sensor. Se inicializa con SHT30_init; los campos se consideran
+ * privados del driver (sht30.c) y de su port.c.
+ */
+typedef struct
+{
+	uint8_t bus;
+	uint8_t addr;						// dirección de 7 bits
+	sht30_repeatability_t repeatability;
+
+	uint16_t single_shot_cmd;
+	uint32_t single_shot_delay_ms;
+	sht30_async_t async_state;
+	bool periodic_mode;					// SHT30_trigger/SHT30_poll hacen fetch en lugar de single shot
+	uint32_t trigger_tick;
+	uint8_t frame[6];
+
+	volatile sht30_err_t xfer_status;	// port.c: última transferencia por interrupciones
+	uint32_t xfer_start;
+	uint8_t tx_buf[5];					// comando y, si lleva, dato + CRC (límites de alerta)
+} sht30_t;
+
 // port.c
-sht30_err_t sht30_write_command(uint16_t cmd);
-sht30_err_t sht30_read(uint8_t *data, uint16_t len);
+sht30_err_t sht30_write_command(sht30_t *dev, uint16_t cmd);
+sht30_err_t sht30_read(sht30_t *dev, uint8_t *data, uint16_t len);
+sht30_err_t sht30_write_data(sht30_t *dev, uint16_t cmd, const uint8_t *data, uint16_t len);
+sht30_err_t sht30_write_command_IT(sht30_t *dev, uint16_t cmd);
+sht30_err_t sht30_read_IT(sht30_t *dev, uint8_t *data, uint16_t len);
+sht30_err_t sht30_TransferStatus(sht30_t *dev);
 void sht30_delay(uint32_t ms);
+uint32_t sht30_GetTick(void);
 
 // sht30.c
-sht30_err_t SHT30_init(bool clock_stretching, sht30_repeatability_t repeatability);
-void SHT30_config(bool clock_stretching, sht30_repeatability_t repeatability);
-sht30_err_t SHT30_softReset(void);
-sht30_err_t SHT30_readTemperatureAndHumidity(float *temperature, float *humidity);
-sht30_err_t SHT30_startPeriodicRead(sht30_repeatability_t repeatability, sht30_mps_t mps);
-sht30_err_t SHT30_stopPeriodicRead(void);
-sht30_err_t SHT30_periodicRead(float *temperature, float *humidity);
+sht30_err_t SHT30_init(sht30_t *dev, uint8_t bus, uint8_t addr, bool clock_stretching, sht30_repeatability_t repeatability);
+void SHT30_config(sht30_t *dev, bool clock_stretching, sht30_repeatability_t repeatability);
+sht30_err_t SHT30_softReset(sht30_t *dev);
+sht30_err_t SHT30_readTemperatureAndHumidity(sht30_t *dev, float *temperature, float *humidity);
+sht30_err_t SHT30_readRaw(sht30_t *dev, uint16_t *raw_temp, uint16_t *raw_hum);
+sht30_err_t SHT30_trigger(sht30_t *dev);
+sht30_err_t SHT30_poll(sht30_t *dev, uint16_t *raw_temp, uint16_t *raw_hum);
+float SHT30_rawToTemperature(uint16_t raw_temp);
+float SHT30_rawToHumidity(uint16_t raw_hum);
+uint16_t SHT30_temperatureToRaw(float temperature);
+uint16_t SHT30_humidityToRaw(float humidity);
+int16_t SHT30_rawToCentiCelsius(uint16_t raw_temp);
+uint16_t SHT30_rawToCentiPercent(uint16_t raw_hum);
+int16_t SHT30_sumToCentiCelsius(uint64_t sum_raw, uint32_t count);
+uint16_t SHT30_sumToCentiPercent(uint64_t sum_raw, uint32_t count);
+sht30_err_t SHT30_decodeFrame(const uint8_t *frame, sht30_measurement_t *m);
+sht30_err_t SHT30_startPeriodicRead(sht30_t *dev, sht30_repeatability_t repeatability, sht30_mps_t mps);
+sht30_err_t SHT30_startART(sht30_t *dev);
+sht30_err_t SHT30_stopPeriodicRead(sht30_t *dev);
+sht30_err_t SHT30_periodicRead(sht30_t *dev, float *temperature, float *humidity);
+sht30_err_t SHT30_writeAlertLimit(sht30_t *dev, sht30_alert_limit_t limit, uint16_t raw_temp, uint16_t raw_hum);
+sht30_err_t SHT30_readAlertLimit(sht30_t *dev, sht30_alert_limit_t limit, uint16_t *raw_temp, uint16_t *raw_hum);
+sht30_err_t SHT30_setAlertBand(sht30_t *dev, uint16_t raw_temp, uint16_t raw_hum, uint16_t band_temp, uint16_t band_hum);
+sht30_err_t SHT30_readStatus(sht30_t *dev, uint16_t *status);
+sht30_err_t SHT30_clearStatus(sht30_t *dev);
 
 #endif /* SHT30_INC_SHT30_H_ */
@@ -0,0 +1,52 @@
+/*
+ *	@file sht30_sched.h
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Planificador de mediciones de varios SHT30 (.h)
+ *  @brief Definicion de funciones del planificador round-robin de mediciones no bloqueantes
+ */
+
+#ifndef SHT30_INC_SHT30_SCHED_H_
+#define SHT30_INC_SHT30_SCHED_H_
+
+#include "sht30.h"
+
+#ifndef SHT30_SCHED_MAX
+#define SHT30_SCHED_MAX		4	// dos direcciones por bus
+#endif
+
+typedef struct
+{
+	sht30_t *dev;
+	uint16_t raw[2];			// temperatura y humedad crudas de la última ronda
+	sht30_err_t err;			// resultado de la última ronda
+	bool pending;				// falta recoger la medición en la ronda en curso
+	bool triggered;				// el comando de medición ya se envió
+} sht30_slot_t;
+
+/*
+ * Ronda de mediciones sobre varios sensores: se disparan todos y se recogen a medida que terminan,
+ * así los tiempos de conversión se superponen y N sensores tardan casi lo mismo que uno. Cada
+ * llamada a SHT30_schedProcess recorre los sensores empezando por uno distinto, de modo que
+ * ninguno tiene prioridad fija sobre el bus que comparte con otros.
+ */
+typedef struct
+{
+	sht30_slot_t slot[SHT30_SCHED_MAX];
+	uint8_t count;
+	uint8_t next;				// sensor por el que empieza la próxima vuelta
+	uint8_t remaining;			// sensores pendientes en la ronda en curso
+	uint32_t round_start;
+	uint32_t round_ms;			// duración de la última ronda completa
+} sht30_sched_t;
+
+// sht30_sched.c
+void SHT30_schedInit(sht30_sched_t *sched);
+bool SHT30_schedAdd(sht30_sched_t *sched, sht30_t *dev);
+uint8_t SHT30_schedCount(const sht30_sched_t *sched);
+sht30_err_t SHT30_schedStart(sht30_sched_t *sched);
+sht30_err_t SHT30_schedProcess(sht30_sched_t *sched);
+const sht30_slot_t *SHT30_schedResult(const sht30_sched_t *sched, uint8_t index);
+
+#endif /* SHT30_INC_SHT30_SCHED_H_ */
@@ -10,30 +10,158 @@
 #include "sht30.h"
 #include "stm32f4xx_hal.h"
 
-#define SHT30_I2C_ADDR (0x44 << 1)
+#define SHT30_I2C_TIMEOUT_MS	10	// máximo por transferencia (6 bytes a 100 kHz tardan ~0.6 ms)
+#define SHT30_RECOVERY_CLOCKS	9	// pulsos de SCL para que un esclavo trabado suelte SDA
 
 extern I2C_HandleTypeDef hi2c1;
 
+/*
+ * Bus I2C compartido por uno o más sensores. Solo una transferencia por vez: el sensor que la
+ * inicia queda como owner hasta que llega el callback o vence SHT30_I2C_TIMEOUT_MS.
+ */
+typedef struct
+{
+	I2C_HandleTypeDef *hi2c;
+	GPIO_TypeDef *gpio;			// pines para la recuperación del bus
+	uint16_t scl_pin;
+	uint16_t sda_pin;
+	sht30_t *volatile owner;	// sensor con una transferencia en curso (NULL: bus libre)
+	volatile bool error;		// error de bus o arbitraje pendiente de recuperación
+} sht30_bus_t;
+
+// indexado por sht30_t.bus; para otro bus se agrega su handle y sus pines
+static sht30_bus_t buses[] = {
+	[SHT30_BUS_I2C1] = { &hi2c1, GPIOB, GPIO_PIN_8, GPIO_PIN_9, NULL, false },
+};
+
+#define SHT30_NUM_BUSES		(sizeof(buses) / sizeof(buses[0]))
+
+static sht30_err_t sht30_transmit_IT(sht30_t *dev, uint16_t len);
+static sht30_err_t sht30_claim(sht30_t *dev, sht30_bus_t **bus);
+static sht30_err_t sht30_wait(sht30_t *dev, sht30_err_t err);
+static sht30_bus_t *sht30_find_bus(I2C_HandleTypeDef *hi2c);
+static void sht30_bus_recover(sht30_bus_t *bus);
+static void sht30_bit_delay(void);
+
 /**
   * @brief  Envia un comando al sensor SHT30 por I2C.
+  * @note   Bloquea hasta terminar la transferencia o vencer SHT30_I2C_TIMEOUT_MS. Si el bus está
+  * 		transfiriendo para otro sensor, espera a que se libere.
+  * @param  dev: Instancia del driver.
+  * @param  cmd: Comando de 16 bits a enviar al sensor.
+  * @retval Código de error de tipo sht30_err_t
+  */
+sht30_err_t sht30_write_command(sht30_t *dev, uint16_t cmd)
+{
+	sht30_err_t err;
+	while((err = sht30_write_command_IT(dev, cmd)) == SHT30_BUSY) { }
+	return sht30_wait(dev, err);
+}
+
+/**
+  * @brief  Lee datos desde el sensor SHT30 por I2C.
+  * @note   Bloquea hasta terminar la transferencia o vencer SHT30_I2C_TIMEOUT_MS. Si el bus está
+  * 		transfiriendo para otro sensor, espera a que se libere.
+  * @param  dev: Instancia del driver.
   * @param  data Puntero al búfer donde se almacenarán los datos leídos.
   * @param  len Cantidad de bytes a leer.
   * @retval Código de error de tipo sht30_err_t
   */
-sht30_err_t sht30_write_command(uint16_t cmd)
+sht30_err_t sht30_read(sht30_t *dev, uint8_t *data, uint16_t len)
 {
-	uint8_t data[2] = { cmd >> 8, cmd & 0xFF }; // descompone en 2 bytes
-	return (sht30_err_t)HAL_I2C_Master_Transmit(&hi2c1, SHT30_I2C_ADDR, data, 2, HAL_MAX_DELAY);
+	sht30_err_t err;
+	while((err = sht30_read_IT(dev, data, len)) == SHT30_BUSY) { }
+	return sht30_wait(dev, err);
 }
 
 /**
-  * @brief  Lee datos desde el sensor SHT30 por I2C.
-  * @param  cmd: Comando de 16 bits a enviar al sensor.
+  * @brief  Envia un comando seguido de datos (escritura de los límites de alerta).
+  * @note   Bloquea igual que sht30_write_command. El dato ya incluye su CRC.
+  * @param  dev: Instancia del driver.
+  * @param  cmd: Comando de 16 bits.
+  * @param  data: Bytes a enviar después del comando (hasta 3).
+  * @param  len: Cantidad de bytes de data.
   * @retval Código de error de tipo sht30_err_t
   */
-sht30_err_t sht30_read(uint8_t *data, uint16_t len)
+sht30_err_t sht30_write_data(sht30_t *dev, uint16_t cmd, const uint8_t *data, uint16_t len)
 {
-    return (sht30_err_t)HAL_I2C_Master_Receive(&hi2c1, SHT30_I2C_ADDR, data, len, HAL_MAX_DELAY);
+	if(len > sizeof(dev->tx_buf) - 2) return SHT30_ERROR;
+
+	dev->tx_buf[0] = cmd >> 8;
+	dev->tx_buf[1] = cmd & 0xFF;
+	for(uint16_t i = 0; i < len; i++) dev->tx_buf[2 + i] = data[i];
+
+	sht30_err_t err;
+	while((err = sht30_transmit_IT(dev, 2 + len)) == SHT30_BUSY) { }
+	return sht30_wait(dev, err);
+}
+
+/**
+  * @brief  Inicia el envío de un comando por I2C con interrupciones (no bloqueante).
+  * @note   El resultado se consulta con sht30_TransferStatus().
+  * @param  dev: Instancia del driver.
+  * @param  cmd: Comando de 16 bits a enviar al sensor.
+  * @retval SHT30_OK si la transferencia quedó en curso.
+  * 		SHT30_BUSY si el bus está transfiriendo para otro sensor (no se inició nada).
+  * 		SHT30_ERROR si el periférico rechazó la transferencia.
+  */
+sht30_err_t sht30_write_command_IT(sht30_t *dev, uint16_t cmd)
+{
+	dev->tx_buf[0] = cmd >> 8; // descompone en 2 bytes
+	dev->tx_buf[1] = cmd & 0xFF;
+
+	return sht30_transmit_IT(dev, 2);
+}
+
+/**
+  * @brief  Inicia la lectura de datos por I2C con interrupciones (no bloqueante).
+  * @note   El buffer debe permanecer válido hasta que sht30_TransferStatus() deje de devolver SHT30_BUSY.
+  * @param  dev: Instancia del driver.
+  * @param  data Puntero al búfer donde se almacenarán los datos leídos.
+  * @param  len Cantidad de bytes a leer.
+  * @retval Igual que sht30_write_command_IT.
+  */
+sht30_err_t sht30_read_IT(sht30_t *dev, uint8_t *data, uint16_t len)
+{
+	sht30_bus_t *bus;
+	sht30_err_t err = sht30_claim(dev, &bus);
+	if(err != SHT30_OK) return err;
+
+	err = (sht30_err_t)HAL_I2C_Master_Receive_IT(bus->hi2c, dev->addr << 1, data, len);
+	if(err != SHT30_OK)
+	{
+		bus->owner = NULL;
+		if(err == SHT30_BUSY) sht30_bus_recover(bus);
+		dev->xfer_status = err = SHT30_ERROR;
+	}
+	return err;
+}
+
+/**
+  * @brief  Estado de la última transferencia del sensor iniciada con interrupciones.
+  * @note   Si la transferencia no termina en SHT30_I2C_TIMEOUT_MS, o terminó con error de bus o
+  * 		arbitraje, se recupera el bus antes de devolver el error.
+  * @param  dev: Instancia del driver.
+  * @retval SHT30_BUSY: transferencia en curso.
+  * 		SHT30_OK: transferencia completada.
+  * 		SHT30_ERROR: el sensor respondió NACK o hubo error de bus.
+  * 		SHT30_TIMEOUT: la transferencia no terminó (bus recuperado).
+  */
+sht30_err_t sht30_TransferStatus(sht30_t *dev)
+{
+	if(dev->bus >= SHT30_NUM_BUSES) return SHT30_ERROR;
+	sht30_bus_t *bus = &buses[dev->bus];
+
+	if(dev->xfer_status == SHT30_BUSY && (HAL_GetTick() - dev->xfer_start) > SHT30_I2C_TIMEOUT_MS)
+	{
+		if(bus->owner == dev) sht30_bus_recover(bus);
+		dev->xfer_status = SHT30_TIMEOUT;
+	}
+	else if(bus->error && bus->owner == NULL)
+	{
+		sht30_bus_recover(bus);
+	}
+	return dev->xfer_status;
 }
 
 /**
@@ -44,3 +172,178 @@ void sht30_delay(uint32_t ms)
 {
     HAL_Delay(ms);
 }
+
+/**
+  * @brief  Devuelve el tiempo actual en milisegundos (base para los deadlines del driver).
+  */
+uint32_t sht30_GetTick(void)
+{
+    return HAL_GetTick();
+}
+
+/**
+  * @brief  Callback de la HAL: transmisión por I2C completada.
+  */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	sht30_bus_t *bus = sht30_find_bus(hi2c);
+	if(bus == NULL || bus->owner == NULL) return;
+
+	bus->owner->xfer_status = SHT30_OK;
+	bus->owner = NULL;
+}
+
+/**
+  * @brief  Callback de la HAL: recepción por I2C completada.
+  */
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	HAL_I2C_MasterTxCpltCallback(hi2c);
+}
+
+/**
+  * @brief  Callback de la HAL: error en la transferencia (NACK, error de bus o pérdida de arbitraje).
+  * @note   La recuperación del bus se hace fuera de la interrupción, en sht30_TransferStatus() o
+  * 		al iniciar la próxima transferencia.
+  */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	sht30_bus_t *bus = sht30_find_bus(hi2c);
+	if(bus == NULL) return;
+
+	if(HAL_I2C_GetError(hi2c) & (HAL_I2C_ERROR_BERR | HAL_I2C_ERROR_ARLO)) bus->error = true;
+	if(bus->owner != NULL)
+	{
+		bus->owner->xfer_status = SHT30_ERROR;
+		bus->owner = NULL;
+	}
+}
+
+/**
+  * @brief  Inicia la transmisión de los primeros len bytes de dev->tx_buf con interrupciones.
+  * @retval Igual que sht30_write_command_IT.
+  */
+static sht30_err_t sht30_transmit_IT(sht30_t *dev, uint16_t len)
+{
+	sht30_bus_t *bus;
+	sht30_err_t err = sht30_claim(dev, &bus);
+	if(err != SHT30_OK) return err;
+
+	err = (sht30_err_t)HAL_I2C_Master_Transmit_IT(bus->hi2c, dev->addr << 1, dev->tx_buf, len);
+	if(err != SHT30_OK)
+	{
+		bus->owner = NULL;
+		if(err == SHT30_BUSY) sht30_bus_recover(bus); // periférico trabado con BUSY
+		dev->xfer_status = err = SHT30_ERROR;
+	}
+	return err;
+}
+
+/**
+  * @brief  Toma el bus del sensor para una transferencia.
+  * @note   Si el sensor que lo tenía superó SHT30_I2C_TIMEOUT_MS (o el bus quedó con error) se
+  * 		recupera el bus antes de tomarlo, así un sensor colgado no bloquea a los demás.
+  * @param  dev: Instancia del driver.
+  * @param  bus: Destino del bus tomado.
+  * @retval SHT30_OK, SHT30_BUSY (otro sensor transfiriendo) o SHT30_ERROR (bus inexistente).
+  */
+static sht30_err_t sht30_claim(sht30_t *dev, sht30_bus_t **bus)
+{
+	if(dev->bus >= SHT30_NUM_BUSES) return SHT30_ERROR;
+	*bus = &buses[dev->bus];
+
+	sht30_t *owner = (*bus)->owner;
+	if(owner != NULL)
+	{
+		if((HAL_GetTick() - owner->xfer_start) <= SHT30_I2C_TIMEOUT_MS) return SHT30_BUSY;
+		sht30_bus_recover(*bus);
+		owner->xfer_status = SHT30_TIMEOUT;
+	}
+	else if((*bus)->error)
+	{
+		sht30_bus_recover(*bus);
+	}
+
+	dev->xfer_status = SHT30_BUSY;
+	dev->xfer_start = HAL_GetTick();
+	(*bus)->owner = dev;
+	return SHT30_OK;
+}
+
+/**
+  * @brief  Espera el fin de una transferencia iniciada con interrupciones.
+  * @param  dev: Instancia del driver.
+  * @param  err: Resultado del inicio de la transferencia.
+  */
+static sht30_err_t sht30_wait(sht30_t *dev, sht30_err_t err)
+{
+	if(err != SHT30_OK) return err;
+	while((err = sht30_TransferStatus(dev)) == SHT30_BUSY) { }
+	return err;
+}
+
+/**
+  * @brief  Bus que corresponde a un handle de la HAL (NULL si no es de un SHT30).
+  */
+static sht30_bus_t *sht30_find_bus(I2C_HandleTypeDef *hi2c)
+{
+	for(uint8_t i = 0; i < SHT30_NUM_BUSES; i++)
+	{
+		if(buses[i].hi2c == hi2c) return &buses[i];
+	}
+	return NULL;
+}
+
+/**
+  * @brief  Recupera el bus I2C cuando un esclavo quedó reteniendo SDA o el periférico quedó con BUSY.
+  * @note   Toma SCL/SDA como GPIO open drain, genera hasta SHT30_RECOVERY_CLOCKS pulsos de SCL hasta
+  * 		que SDA quede libre y una condición de STOP. Luego resetea el periférico (RCC) y lo vuelve
+  * 		a inicializar; HAL_I2C_MspInit devuelve los pines a su función alternativa. La transferencia
+  * 		en curso, si había, se pierde.
+  */
+static void sht30_bus_recover(sht30_bus_t *bus)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	HAL_I2C_DeInit(bus->hi2c);
+
+	HAL_GPIO_WritePin(bus->gpio, bus->scl_pin | bus->sda_pin, GPIO_PIN_SET);
+	GPIO_InitStruct.Pin = bus->scl_pin | bus->sda_pin;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	HAL_GPIO_Init(bus->gpio, &GPIO_InitStruct);
+
+	for(uint8_t i = 0; i < SHT30_RECOVERY_CLOCKS; i++)
+	{
+		if(HAL_GPIO_ReadPin(bus->gpio, bus->sda_pin) == GPIO_PIN_SET) break;
+		HAL_GPIO_WritePin(bus->gpio, bus->scl_pin, GPIO_PIN_RESET);
+		sht30_bit_delay();
+		HAL_GPIO_WritePin(bus->gpio, bus->scl_pin, GPIO_PIN_SET);
+		sht30_bit_delay();
+	}
+
+	// STOP: SDA sube con SCL en alto
+	HAL_GPIO_WritePin(bus->gpio, bus->sda_pin, GPIO_PIN_RESET);
+	sht30_bit_delay();
+	HAL_GPIO_WritePin(bus->gpio, bus->sda_pin, GPIO_PIN_SET);
+	sht30_bit_delay();
+
+	if(bus->hi2c->Instance == I2C1)
+	{
+		__HAL_RCC_I2C1_FORCE_RESET();
+		__HAL_RCC_I2C1_RELEASE_RESET();
+	}
+	HAL_I2C_Init(bus->hi2c);
+
+	bus->owner = NULL;
+	bus->error = false;
+}
+
+/**
+  * @brief  Medio período de SCL a 100 kHz (~5 us).
+  */
+static void sht30_bit_delay(void)
+{
+	for(volatile uint32_t i = 0; i < SystemCoreClock / 1000000U; i++) { }
+}
@@ -10,173 +10,560 @@
 
 #include "sht30.h"
 
-static uint16_t SINGLE_SHOT_CMD = 0x2C06;
-static uint32_t SINGLE_SHOT_MEASUREMENT_DELAY_MS = 15;
-
-static void build_SingleShotCommand(bool clock_stretching, sht30_repeatability_t repeatability);
+#define SHT30_POLL_MARGIN_MS	10 // margen sobre el tiempo máximo de medición antes de informar timeout
+#define SHT30_BREAK_DELAY_MS	1  // el sensor no acepta comandos hasta 1 ms después del break
+#define SHT30_RESET_DELAY_MS	2  // soft reset: hasta 1.5 ms sin responder
+#define SHT30_FETCH_CMD			0xE000
+#define SHT30_BREAK_CMD			0x3093
+#define SHT30_ART_CMD			0x2B32
+#define SHT30_STATUS_CMD		0xF32D
+#define SHT30_CLEAR_STATUS_CMD	0x3041
+#define SHT30_LIMIT_TEMP_SHIFT	7  // un límite guarda los 9 bits altos de T
+#define SHT30_LIMIT_HUM_MASK	0xFE00 // y los 7 bits altos de HR
+
+// medición no bloqueante (SHT30_trigger / SHT30_poll), indexado por repetibilidad
+static const uint16_t NO_STRETCH_CMD[] = { 0x2400, 0x240B, 0x2416 };
+static const uint32_t MEASUREMENT_TYP_MS[] = { 13, 5, 3 }; // 12.5 / 4.5 / 2.5 ms según la hoja de datos
+
+// límites de alerta, indexado por sht30_alert_limit_t
+static const uint16_t ALERT_READ_CMD[] = { 0xE11F, 0xE114, 0xE109, 0xE102 };
+static const uint16_t ALERT_WRITE_CMD[] = { 0x611D, 0x6116, 0x610B, 0x6100 };
+
+// CRC-8 de Sensirion (polinomio 0x31) byte a byte: CRC8_TABLE[x] es el CRC de x con valor inicial 0
+static const uint8_t CRC8_TABLE[256] = {
+	0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+	0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4, 0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+	0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11, 0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+	0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+	0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA, 0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+	0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9, 0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+	0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C, 0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+	0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F, 0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+	0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED, 0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+	0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE, 0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+	0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B, 0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+	0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+	0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0, 0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+	0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93, 0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+	0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+	0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15, 0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC
+};
+
+static void build_SingleShotCommand(sht30_t *dev, bool clock_stretching, sht30_repeatability_t repeatability);
 static uint16_t get_PeriodicDataAcquisitionCommand(sht30_repeatability_t repeatability, sht30_mps_t mps);
+static sht30_err_t sht30_fetch_raw(sht30_t *dev, uint16_t *raw_temp, uint16_t *raw_hum);
+static sht30_err_t sht30_fetch_converted(sht30_t *dev, float *temperature, float *humidity);
+static sht30_err_t sht30_decode_raw(const uint8_t *data, uint16_t *raw_temp, uint16_t *raw_hum);
+static sht30_err_t sht30_read_word(sht30_t *dev, uint16_t cmd, uint16_t *word);
+static uint16_t sht30_clamp(int32_t raw);
+static bool sht30_frame_valid(const uint8_t *data);
 static uint8_t SHT30_CRC8(const uint8_t *data, uint8_t len);
 
 /**
   * @brief  Inicializa el sensor SHT30.
   * @note 	Configura el sensor en modo de medición por disparo único (single shot) y realiza un soft reset.
+  * @param  dev: Instancia del driver para este sensor.
+  * @param  bus: Bus I2C del sensor (SHT30_BUS_I2C1).
+  * @param  addr: Dirección de 7 bits (SHT30_ADDR_DEFAULT o SHT30_ADDR_ALT).
   * @param  clock_stretching: Indica si se habilita o no el clock stretching.
   * @param  repeatability: Nivel de repetibilidad de la medición (baja, media o alta).
   * @retval sht30_err_t (SHT30_OK si la operación fue exitosa)
   */
-sht30_err_t SHT30_init(bool clock_stretching, sht30_repeatability_t repeatability)
+sht30_err_t SHT30_init(sht30_t *dev, uint8_t bus, uint8_t addr, bool clock_stretching, sht30_repeatability_t repeatability)
 {
-	SHT30_config(clock_stretching, repeatability);
-	return SHT30_softReset();
+	dev->bus = bus;
+	dev->addr = addr;
+	dev->async_state = SHT30_ASYNC_IDLE;
+	dev->periodic_mode = false;
+	dev->xfer_status = SHT30_OK;
+
+	SHT30_config(dev, clock_stretching, repeatability);
+	return SHT30_softReset(dev);
 }
 
 /**
   * @brief  Configura el comando de medición en modo single shot para el SHT30.
+  * @param  dev: Instancia del driver.
   * @param  clock_stretching: Si es true, se habilita el clock stretching durante la conversión.
   * @param  repeatability: Nivel de repetibilidad de la medición (baja, media o alta).
   */
-void SHT30_config(bool clock_stretching, sht30_repeatability_t repeatability)
+void SHT30_config(sht30_t *dev, bool clock_stretching, sht30_repeatability_t repeatability)
 {
-	build_SingleShotCommand(clock_stretching, repeatability);
+	build_SingleShotCommand(dev, clock_stretching, repeatability);
 }
 
 /**
   * @brief  Reinicio por software del sensor SHT30.
+  * @note	Bloquea SHT30_RESET_DELAY_MS para que el sensor acepte el próximo comando.
+  * @param  dev: Instancia del driver.
   * @retval sht30_err_t (SHT30_OK si la operación fue exitosa)
   */
-sht30_err_t SHT30_softReset(void)
+sht30_err_t SHT30_softReset(sht30_t *dev)
 {
-    return sht30_write_command(0x30A2); // comando para soft reset
+    sht30_err_t err = sht30_write_command(dev, 0x30A2); // comando para soft reset
+    if (err == SHT30_OK) sht30_delay(SHT30_RESET_DELAY_MS);
+    return err;
 }
 
 /**
   * @brief  Medición de temperatura y humedad con el sensor SHT30.
+  * @param  dev: Instancia del driver.
   * @param  temperature: Puntero donde se almacenará la temperatura medida (en °C).
   * @param  humidity: Puntero donde se almacenará la humedad relativa medida (en %HR).
   * @retval SHT30_OK si la medición fue exitosa y los CRCs son válidos.
   * 		SHT30_CRC_FAIL si alguna validación CRC falla.
   * 		Otro código de error de tipo sht30_err_t si hubo fallo de comunicación.
   */
-sht30_err_t SHT30_readTemperatureAndHumidity(float *temperature, float *humidity)
+sht30_err_t SHT30_readTemperatureAndHumidity(sht30_t *dev, float *temperature, float *humidity)
 {
 	sht30_err_t err;
-	err = sht30_write_command(SINGLE_SHOT_CMD);
+	err = sht30_write_command(dev, dev->single_shot_cmd);
 	if(err != SHT30_OK) return err;
 
-	sht30_delay(SINGLE_SHOT_MEASUREMENT_DELAY_MS);
+	sht30_delay(dev->single_shot_delay_ms);
 
-	uint8_t data[6];
-	err = sht30_read(data, 6);
+	return sht30_fetch_converted(dev, temperature, humidity);
+}
+
+/**
+  * @brief  Medición single shot devolviendo los valores crudos (ticks de 16 bits) del SHT30.
+  * @note	Los valores se convierten a unidades físicas con SHT30_rawToTemperature y SHT30_rawToHumidity.
+  * @param  dev: Instancia del driver.
+  * @param  raw_temp: Puntero donde se almacenará la temperatura cruda.
+  * @param  raw_hum: Puntero donde se almacenará la humedad cruda.
+  * @retval SHT30_OK si la medición fue exitosa y los CRCs son válidos.
+  * 		SHT30_CRC_FAIL si alguna validación CRC falla.
+  * 		Otro código de error de tipo sht30_err_t si hubo fallo de comunicación.
+  */
+sht30_err_t SHT30_readRaw(sht30_t *dev, uint16_t *raw_temp, uint16_t *raw_hum)
+{
+	sht30_err_t err;
+	err = sht30_write_command(dev, dev->single_shot_cmd);
+	if(err != SHT30_OK) return err;
+
+	sht30_delay(dev->single_shot_delay_ms);
+
+	return sht30_fetch_raw(dev, raw_temp, raw_hum);
+}
+
+/**
+  * @brief  Inicia una medición single shot sin clock stretching (no bloqueante).
+  * @note	Usa la repetibilidad configurada con SHT30_init/SHT30_config. El comando se envía por
+  * 		interrupciones y el resultado se obtiene con SHT30_poll; mientras el sensor mide no se
+  * 		retiene el bus ni el CPU.
+  * 		En modo periódico (SHT30_startPeriodicRead/SHT30_startART) envía el fetch de la última
+  * 		medición y SHT30_poll la lee sin esperar.
+  * 		Con varios sensores en el mismo bus se puede disparar uno mientras otro mide.
+  * @param  dev: Instancia del driver.
+  * @retval SHT30_OK si el comando quedó en curso.
+  * 		SHT30_BUSY si hay una medición en curso o el bus está transfiriendo para otro sensor.
+  * 		Otro código de error de tipo sht30_err_t si hubo fallo de comunicación.
+  */
+sht30_err_t SHT30_trigger(sht30_t *dev)
+{
+	if (dev->async_state != SHT30_ASYNC_IDLE && (sht30_GetTick() - dev->trigger_tick) <= dev->single_shot_delay_ms + SHT30_POLL_MARGIN_MS)
+	{
+		return SHT30_BUSY;
+	}
+
+	dev->trigger_tick = sht30_GetTick();
+	uint16_t cmd = dev->periodic_mode ? SHT30_FETCH_CMD : NO_STRETCH_CMD[dev->repeatability];
+	sht30_err_t err = sht30_write_command_IT(dev, cmd);
+	dev->async_state = (err == SHT30_OK) ? SHT30_ASYNC_COMMAND : SHT30_ASYNC_IDLE;
+
+	return err;
+}
+
+/**
+  * @brief  Avanza la medición iniciada con SHT30_trigger.
+  * @note	Espera que termine el envío del comando y, antes del tiempo típico de medición, no accede
+  * 		al bus. Después inicia la lectura: mientras mide, el sensor responde NACK y se reintenta
+  * 		hasta vencer el tiempo máximo más SHT30_POLL_MARGIN_MS. Las transferencias son por
+  * 		interrupciones, así que cada llamada dura microsegundos. Si el bus está ocupado por otro
+  * 		sensor la lectura se reintenta en la próxima llamada.
+  * @param  dev: Instancia del driver.
+  * @param  raw_temp: Puntero donde se almacenará la temperatura cruda.
+  * @param  raw_hum: Puntero donde se almacenará la humedad cruda.
+  * @retval SHT30_OK si la medición terminó y los CRCs son válidos.
+  * 		SHT30_BUSY si la medición sigue en curso.
+  * 		SHT30_TIMEOUT si el sensor no respondió antes del deadline.
+  * 		SHT30_CRC_FAIL si alguna validación CRC falla.
+  * 		SHT30_ERROR si no hay una medición iniciada o el comando fue rechazado. En modo
+  * 		periódico, también si el sensor no tenía una medición nueva (no se reintenta).
+  */
+sht30_err_t SHT30_poll(sht30_t *dev, uint16_t *raw_temp, uint16_t *raw_hum)
+{
+	sht30_err_t err;
+	uint32_t elapsed = sht30_GetTick() - dev->trigger_tick;
+
+	switch (dev->async_state)
+	{
+		case SHT30_ASYNC_IDLE:
+			return SHT30_ERROR;
+
+		case SHT30_ASYNC_COMMAND:
+			err = sht30_TransferStatus(dev);
+			if (err == SHT30_BUSY) return SHT30_BUSY;
+			if (err != SHT30_OK)
+			{
+				dev->async_state = SHT30_ASYNC_IDLE;
+				return err;
+			}
+			dev->async_state = SHT30_ASYNC_MEASURING;
+			/* fall through */
+
+		case SHT30_ASYNC_MEASURING:
+			if (!dev->periodic_mode && elapsed < MEASUREMENT_TYP_MS[dev->repeatability]) return SHT30_BUSY;
+			err = sht30_read_IT(dev, dev->frame, 6);
+			if (err == SHT30_BUSY) return SHT30_BUSY; // bus ocupado por otro sensor
+			if (err == SHT30_OK)
+			{
+				dev->async_state = SHT30_ASYNC_READING;
+				return SHT30_BUSY;
+			}
+			break;
+
+		case SHT30_ASYNC_READING:
+			err = sht30_TransferStatus(dev);
+			if (err == SHT30_BUSY) return SHT30_BUSY;
+			break;
+
+		default:
+			err = SHT30_ERROR;
+			break;
+	}
+
+	if (err == SHT30_ERROR && !dev->periodic_mode && elapsed <= dev->single_shot_delay_ms + SHT30_POLL_MARGIN_MS)
+	{
+		dev->async_state = SHT30_ASYNC_MEASURING; // NACK: el sensor todavía está midiendo
+		return SHT30_BUSY;
+	}
+
+	dev->async_state = SHT30_ASYNC_IDLE;
+	if (err == SHT30_ERROR && !dev->periodic_mode) return SHT30_TIMEOUT;
 	if (err != SHT30_OK) return err;
 
-	if (SHT30_CRC8(data, 2) != data[2] || SHT30_CRC8(&data[3], 2) != data[5]) return SHT30_CRC_FAIL;
+	return sht30_decode_raw(dev->frame, raw_temp, raw_hum);
+}
 
-	uint16_t raw_temp = (data[0] << 8) | data[1];
-	uint16_t raw_hum  = (data[3] << 8) | data[4];
+/**
+  * @brief  Convierte una temperatura cruda del SHT30 a °C.
+  * @note	Multiplica por la constante 175/65535 en lugar de dividir por 65535 en cada llamada.
+  */
+float SHT30_rawToTemperature(uint16_t raw_temp)
+{
+	return -45.0f + (float)raw_temp * (175.0f / 65535.0f);
+}
 
-	*temperature = -45 + 175 * ((float)raw_temp / 65535.0f);
-	*humidity = 100 * ((float)raw_hum / 65535.0f);
+/**
+  * @brief  Convierte una humedad cruda del SHT30 a %HR.
+  */
+float SHT30_rawToHumidity(uint16_t raw_hum)
+{
+	return (float)raw_hum * (100.0f / 65535.0f);
+}
+
+/**
+  * @brief  Convierte una temperatura en °C a ticks crudos del SHT30 (inversa de SHT30_rawToTemperature).
+  * @note	Redondea al tick más cercano y satura al rango del sensor; NaN da 0.
+  */
+uint16_t SHT30_temperatureToRaw(float temperature)
+{
+	float raw = (temperature + 45.0f) * (65535.0f / 175.0f) + 0.5f;
+
+	if (!(raw > 0.0f)) return 0;
+	if (raw >= 65535.0f) return 65535;
+	return (uint16_t)raw;
+}
+
+/**
+  * @brief  Convierte una humedad en %HR a ticks crudos del SHT30 (inversa de SHT30_rawToHumidity).
+  * @note	Redondea al tick más cercano y satura al rango del sensor; NaN da 0.
+  */
+uint16_t SHT30_humidityToRaw(float humidity)
+{
+	float raw = humidity * (65535.0f / 100.0f) + 0.5f;
+
+	if (!(raw > 0.0f)) return 0;
+	if (raw >= 65535.0f) return 65535;
+	return (uint16_t)raw;
+}
+
+/**
+  * @brief  Convierte una temperatura cruda del SHT30 a centésimas de °C, solo con enteros.
+  * @note	-4500 + 17500 * raw / 65535 redondeado al más cercano; 17500 * 65535 entra en 32 bits.
+  */
+int16_t SHT30_rawToCentiCelsius(uint16_t raw_temp)
+{
+	return (int16_t)((17500U * raw_temp + 32767U) / 65535U) - 4500;
+}
+
+/**
+  * @brief  Convierte una humedad cruda del SHT30 a centésimas de %HR, solo con enteros.
+  */
+uint16_t SHT30_rawToCentiPercent(uint16_t raw_hum)
+{
+	return (uint16_t)((10000U * raw_hum + 32767U) / 65535U);
+}
+
+/**
+  * @brief  Convierte la suma de count temperaturas crudas a su promedio en centésimas de °C, solo con enteros.
+  * @note	Redondea una sola vez sobre la suma, sin perder la fracción de tick del promedio. Con count de
+  * 		32 bits la suma es menor que 65535 * 2^32 y 17500 * sum entra en 64 bits.
+  */
+int16_t SHT30_sumToCentiCelsius(uint64_t sum_raw, uint32_t count)
+{
+	if (count == 0) return 0;
+
+	uint64_t den = (uint64_t)count * 65535U;
+	return (int16_t)((17500U * sum_raw + den / 2) / den) - 4500;
+}
+
+/**
+  * @brief  Convierte la suma de count humedades crudas a su promedio en centésimas de %HR, solo con enteros.
+  */
+uint16_t SHT30_sumToCentiPercent(uint64_t sum_raw, uint32_t count)
+{
+	if (count == 0) return 0;
+
+	uint64_t den = (uint64_t)count * 65535U;
+	return (uint16_t)((10000U * sum_raw + den / 2) / den);
+}
+
+/**
+  * @brief  Valida y convierte una trama de medición en una sola pasada.
+  * @note	Dos búsquedas en la tabla de CRC por valor y la conversión en punto fijo: no usa float,
+  * 		así que sirve en el camino de muchos sensores a alta frecuencia.
+  * @param  frame: Trama de 6 bytes (T MSB, T LSB, CRC, HR MSB, HR LSB, CRC).
+  * @param  m: Destino de los valores crudos y convertidos (no se modifica si el CRC falla).
+  * @retval SHT30_OK o SHT30_CRC_FAIL
+  */
+sht30_err_t SHT30_decodeFrame(const uint8_t *frame, sht30_measurement_t *m)
+{
+	if (!sht30_frame_valid(frame)) return SHT30_CRC_FAIL;
+
+	m->raw_temp = (frame[0] << 8) | frame[1];
+	m->raw_hum  = (frame[3] << 8) | frame[4];
+	m->temp_centi = SHT30_rawToCentiCelsius(m->raw_temp);
+	m->hum_centi = SHT30_rawToCentiPercent(m->raw_hum);
 
 	return SHT30_OK;
 }
 
 /**
   * @brief  Inicia el modo de medición periódica del sensor SHT30.
-  * @note	Una vez iniciado se lee con SHT30_periodicRead y se sale del modo con SHT30_stopPeriodicRead
+  * @note	Una vez iniciado se lee con SHT30_periodicRead (o sin bloquear con SHT30_trigger y
+  * 		SHT30_poll) y se sale del modo con SHT30_stopPeriodicRead
+  * @param  dev: Instancia del driver.
   * @retval sht30_err_t (SHT30_OK si la operación fue exitosa)
   */
-sht30_err_t SHT30_startPeriodicRead(sht30_repeatability_t repeatability, sht30_mps_t mps)
+sht30_err_t SHT30_startPeriodicRead(sht30_t *dev, sht30_repeatability_t repeatability, sht30_mps_t mps)
 {
-	SHT30_stopPeriodicRead();
+	SHT30_stopPeriodicRead(dev);
 
 	uint16_t cmd = get_PeriodicDataAcquisitionCommand(repeatability, mps);
-	return sht30_write_command(cmd);
+	sht30_err_t err = sht30_write_command(dev, cmd);
+	dev->periodic_mode = (err == SHT30_OK);
+	return err;
+}
+
+/**
+  * @brief  Inicia el modo ART (accelerated response time): mediciones periódicas a 4 mps.
+  * @note	Se lee y se detiene igual que el modo periódico.
+  * @param  dev: Instancia del driver.
+  * @retval sht30_err_t (SHT30_OK si la operación fue exitosa)
+  */
+sht30_err_t SHT30_startART(sht30_t *dev)
+{
+	SHT30_stopPeriodicRead(dev);
+
+	sht30_err_t err = sht30_write_command(dev, SHT30_ART_CMD);
+	dev->periodic_mode = (err == SHT30_OK);
+	return err;
 }
 
 /**
   * @brief  Detiene las mediciones periódicas del sensor SHT30.
+  * @note	Bloquea SHT30_BREAK_DELAY_MS para que el sensor acepte el próximo comando.
+  * @param  dev: Instancia del driver.
   * @retval sht30_err_t (SHT30_OK si la operación fue exitosa)
   */
-sht30_err_t SHT30_stopPeriodicRead(void)
+sht30_err_t SHT30_stopPeriodicRead(sht30_t *dev)
 {
-    return sht30_write_command(0x3093);
+	dev->periodic_mode = false;
+	dev->async_state = SHT30_ASYNC_IDLE;
+
+	sht30_err_t err = sht30_write_command(dev, SHT30_BREAK_CMD);
+	if (err == SHT30_OK) sht30_delay(SHT30_BREAK_DELAY_MS);
+	return err;
 }
 
 /**
   * @brief  Función para obtener la última medición del sensor SHT30 en el modo de medición periódica.
+  * @param  dev: Instancia del driver.
   * @param  temperature: Puntero donde se almacenará la temperatura medida (en °C).
   * @param  humidity: Puntero donde se almacenará la humedad relativa medida (en %HR).
   * @retval SHT30_OK si la medición fue exitosa y los CRCs son válidos.
   * 		SHT30_CRC_FAIL si alguna validación CRC falla.
   * 		Otro código de error de tipo sht30_err_t si hubo fallo de comunicación.
   */
-sht30_err_t SHT30_periodicRead(float *temperature, float *humidity)
+sht30_err_t SHT30_periodicRead(sht30_t *dev, float *temperature, float *humidity)
 {
 	sht30_err_t err;
 
-    err = sht30_write_command(0xE000);
+    err = sht30_write_command(dev, SHT30_FETCH_CMD);
 	if(err != SHT30_OK) return err;
 
-    uint8_t data[6];
-    err = sht30_read(data, 6);
-    if (err != SHT30_OK) return err;
+    return sht30_fetch_converted(dev, temperature, humidity);
+}
+
+/**
+  * @brief  Escribe un límite de alerta del SHT30.
+  * @note	El límite guarda los 7 bits altos de HR y los 9 bits altos de T (resolución de 0.78 %HR
+  * 		y 0.34 °C): los bits bajos de raw_temp y raw_hum se descartan. El sensor compara los
+  * 		límites con cada medición del modo periódico.
+  * @param  dev: Instancia del driver.
+  * @param  limit: Límite a escribir.
+  * @param  raw_temp: Temperatura cruda del límite.
+  * @param  raw_hum: Humedad cruda del límite.
+  * @retval sht30_err_t (SHT30_OK si la operación fue exitosa)
+  */
+sht30_err_t SHT30_writeAlertLimit(sht30_t *dev, sht30_alert_limit_t limit, uint16_t raw_temp, uint16_t raw_hum)
+{
+	uint16_t word = (raw_hum & SHT30_LIMIT_HUM_MASK) | (raw_temp >> SHT30_LIMIT_TEMP_SHIFT);
+	uint8_t data[3] = { word >> 8, word & 0xFF, 0 };
+
+	data[2] = SHT30_CRC8(data, 2);
+	return sht30_write_data(dev, ALERT_WRITE_CMD[limit], data, 3);
+}
+
+/**
+  * @brief  Lee un límite de alerta del SHT30.
+  * @param  dev: Instancia del driver.
+  * @param  limit: Límite a leer.
+  * @param  raw_temp: Puntero donde se almacenará la temperatura cruda del límite (bits bajos en 0).
+  * @param  raw_hum: Puntero donde se almacenará la humedad cruda del límite (bits bajos en 0).
+  * @retval SHT30_OK, SHT30_CRC_FAIL u otro código de error de tipo sht30_err_t
+  */
+sht30_err_t SHT30_readAlertLimit(sht30_t *dev, sht30_alert_limit_t limit, uint16_t *raw_temp, uint16_t *raw_hum)
+{
+	uint16_t word;
+	sht30_err_t err = sht30_read_word(dev, ALERT_READ_CMD[limit], &word);
+	if (err != SHT30_OK) return err;
 
-    if (SHT30_CRC8(data, 2) != data[2] || SHT30_CRC8(&data[3], 2) != data[5]) return SHT30_CRC_FAIL;
+	*raw_temp = (word & ~SHT30_LIMIT_HUM_MASK) << SHT30_LIMIT_TEMP_SHIFT;
+	*raw_hum = word & SHT30_LIMIT_HUM_MASK;
+	return SHT30_OK;
+}
 
-    uint16_t raw_temp = (data[0] << 8) | data[1];
-    uint16_t raw_hum  = (data[3] << 8) | data[4];
+/**
+  * @brief  Centra la banda de alerta en una medición.
+  * @note	El pin ALERT sube cuando T o HR se alejan más de band del centro y baja cuando vuelven
+  * 		a estar a menos de band/2. Los límites SET se redondean hacia afuera para que la banda
+  * 		no quede más angosta que la pedida. Después de cada escritura se verifica en el registro
+  * 		de estado que el sensor la aceptó; al final se limpia el registro.
+  * @param  dev: Instancia del driver.
+  * @param  raw_temp: Temperatura cruda del centro.
+  * @param  raw_hum: Humedad cruda del centro.
+  * @param  band_temp: Semiancho de la banda de temperatura, en ticks.
+  * @param  band_hum: Semiancho de la banda de humedad, en ticks.
+  * @retval SHT30_CRC_FAIL si el sensor rechazó una escritura, u otro código de error de tipo sht30_err_t
+  */
+sht30_err_t SHT30_setAlertBand(sht30_t *dev, uint16_t raw_temp, uint16_t raw_hum, uint16_t band_temp, uint16_t band_hum)
+{
+	const uint16_t round_temp = (1U << SHT30_LIMIT_TEMP_SHIFT) - 1;
+	const uint16_t round_hum = (uint16_t)~SHT30_LIMIT_HUM_MASK;
+	uint16_t temp[4], hum[4]; // indexado por sht30_alert_limit_t
+	uint16_t status;
+
+	temp[SHT30_ALERT_HIGH_SET] = sht30_clamp((int32_t)raw_temp + band_temp + round_temp);
+	temp[SHT30_ALERT_HIGH_CLEAR] = sht30_clamp((int32_t)raw_temp + band_temp / 2);
+	temp[SHT30_ALERT_LOW_CLEAR] = sht30_clamp((int32_t)raw_temp - band_temp / 2);
+	temp[SHT30_ALERT_LOW_SET] = sht30_clamp((int32_t)raw_temp - band_temp);
+	hum[SHT30_ALERT_HIGH_SET] = sht30_clamp((int32_t)raw_hum + band_hum + round_hum);
+	hum[SHT30_ALERT_HIGH_CLEAR] = sht30_clamp((int32_t)raw_hum + band_hum / 2);
+	hum[SHT30_ALERT_LOW_CLEAR] = sht30_clamp((int32_t)raw_hum - band_hum / 2);
+	hum[SHT30_ALERT_LOW_SET] = sht30_clamp((int32_t)raw_hum - band_hum);
+
+	for (int limit = SHT30_ALERT_HIGH_SET; limit <= SHT30_ALERT_LOW_SET; limit++)
+	{
+		sht30_err_t err = SHT30_writeAlertLimit(dev, (sht30_alert_limit_t)limit, temp[limit], hum[limit]);
+		if (err == SHT30_OK) err = SHT30_readStatus(dev, &status);
+		if (err != SHT30_OK) return err;
+		if (status & (SHT30_STATUS_WRITE_CRC_FAIL | SHT30_STATUS_CMD_FAIL)) return SHT30_CRC_FAIL;
+	}
+	return SHT30_clearStatus(dev);
+}
 
-    *temperature = -45 + 175 * ((float)raw_temp / 65535.0f);
-    *humidity = 100 * ((float)raw_hum / 65535.0f);
+/**
+  * @brief  Lee el registro de estado del SHT30 (bits SHT30_STATUS_*).
+  * @param  dev: Instancia del driver.
+  * @param  status: Puntero donde se almacenará el registro.
+  * @retval SHT30_OK, SHT30_CRC_FAIL u otro código de error de tipo sht30_err_t
+  */
+sht30_err_t SHT30_readStatus(sht30_t *dev, uint16_t *status)
+{
+	return sht30_read_word(dev, SHT30_STATUS_CMD, status);
+}
 
-    return SHT30_OK;
+/**
+  * @brief  Limpia los bits de alerta y de reset del registro de estado.
+  * @param  dev: Instancia del driver.
+  * @retval sht30_err_t (SHT30_OK si la operación fue exitosa)
+  */
+sht30_err_t SHT30_clearStatus(sht30_t *dev)
+{
+	return sht30_write_command(dev, SHT30_CLEAR_STATUS_CMD);
 }
 
 /**
   * @brief  Función para construir el comando de medición para modo "single shot".
+  * @param  dev: Instancia del driver.
   * @param  clock_stretching: Si es true, se habilita clock stretching (SCL bloqueado durante conversión).
   * @param  repeatability: Nivel de precisión/repetibilidad deseado (alta, media o baja).
   */
-static void build_SingleShotCommand(bool clock_stretching, sht30_repeatability_t repeatability)
+static void build_SingleShotCommand(sht30_t *dev, bool clock_stretching, sht30_repeatability_t repeatability)
 {
+	dev->repeatability = (repeatability <= SHT30_REPEATABILITY_LOW) ? repeatability : SHT30_REPEATABILITY_HIGH;
+
     if (clock_stretching) {
         switch (repeatability) {
             case SHT30_REPEATABILITY_HIGH:
-            	SINGLE_SHOT_MEASUREMENT_DELAY_MS = 15;
-            	SINGLE_SHOT_CMD = 0x2C06;
+            	dev->single_shot_delay_ms = 15;
+            	dev->single_shot_cmd = 0x2C06;
             	return;
 
             case SHT30_REPEATABILITY_MEDIUM:
-            	SINGLE_SHOT_MEASUREMENT_DELAY_MS = 6;
-            	SINGLE_SHOT_CMD = 0x2C0D;
+            	dev->single_shot_delay_ms = 6;
+            	dev->single_shot_cmd = 0x2C0D;
             	return;
 
             case SHT30_REPEATABILITY_LOW:
-            	SINGLE_SHOT_MEASUREMENT_DELAY_MS = 4;
-            	SINGLE_SHOT_CMD = 0x2C10;
+            	dev->single_shot_delay_ms = 4;
+            	dev->single_shot_cmd = 0x2C10;
             	return;
         }
     } else {
         switch (repeatability) {
             case SHT30_REPEATABILITY_HIGH:
-            	SINGLE_SHOT_MEASUREMENT_DELAY_MS = 15;
-            	SINGLE_SHOT_CMD = 0x2400;
+            	dev->single_shot_delay_ms = 15;
+            	dev->single_shot_cmd = 0x2400;
             	return;
 
             case SHT30_REPEATABILITY_MEDIUM:
-            	SINGLE_SHOT_MEASUREMENT_DELAY_MS = 6;
-            	SINGLE_SHOT_CMD = 0x240B;
+            	dev->single_shot_delay_ms = 6;
+            	dev->single_shot_cmd = 0x240B;
             	return;
 
             case SHT30_REPEATABILITY_LOW:
-            	SINGLE_SHOT_MEASUREMENT_DELAY_MS = 4;
-            	SINGLE_SHOT_CMD = 0x2416;
+            	dev->single_shot_delay_ms = 4;
+            	dev->single_shot_cmd = 0x2416;
             	return;
         }
     }
 
-    SINGLE_SHOT_MEASUREMENT_DELAY_MS = 15;
-	SINGLE_SHOT_CMD = 0x2C06;
+    dev->single_shot_delay_ms = 15;
+	dev->single_shot_cmd = 0x2C06;
     return; // Default fallback
 }
 
@@ -194,45 +581,141 @@ static uint16_t get_PeriodicDataAcquisitionCommand(sht30_repeatability_t repeata
 			if(repeatability == SHT30_REPEATABILITY_HIGH) return 0x2032;
 			else if(repeatability == SHT30_REPEATABILITY_MEDIUM) return 0x2024;
 			else if(repeatability == SHT30_REPEATABILITY_LOW) return 0x202F;
+			break;
 
 		case SHT30_MPS_1:
 			if(repeatability == SHT30_REPEATABILITY_HIGH) return 0x2130;
 			else if(repeatability == SHT30_REPEATABILITY_MEDIUM) return 0x2126;
 			else if(repeatability == SHT30_REPEATABILITY_LOW) return 0x212D;
+			break;
 
 		case SHT30_MPS_2:
 			if(repeatability == SHT30_REPEATABILITY_HIGH) return 0x2236;
 			else if(repeatability == SHT30_REPEATABILITY_MEDIUM) return 0x2220;
 			else if(repeatability == SHT30_REPEATABILITY_LOW) return 0x222B;
+			break;
 
 		case SHT30_MPS_4:
 			if(repeatability == SHT30_REPEATABILITY_HIGH) return 0x2334;
 			else if(repeatability == SHT30_REPEATABILITY_MEDIUM) return 0x2322;
 			else if(repeatability == SHT30_REPEATABILITY_LOW) return 0x2329;
+			break;
 
 		case SHT30_MPS_10:
 			if(repeatability == SHT30_REPEATABILITY_HIGH) return 0x2737;
 			else if(repeatability == SHT30_REPEATABILITY_MEDIUM) return 0x2721;
 			else if(repeatability == SHT30_REPEATABILITY_LOW) return 0x272A;
+			break;
 	}
 
 	return 0x2032;
 }
 
+/**
+  * @brief  Lee la trama de medición (6 bytes) del SHT30 y valida ambos CRC.
+  * @param  dev: Instancia del driver.
+  * @param  raw_temp: Puntero donde se almacenará la temperatura cruda.
+  * @param  raw_hum: Puntero donde se almacenará la humedad cruda.
+  * @retval Código de error de tipo sht30_err_t
+  */
+static sht30_err_t sht30_fetch_raw(sht30_t *dev, uint16_t *raw_temp, uint16_t *raw_hum)
+{
+	uint8_t data[6];
+	sht30_err_t err = sht30_read(dev, data, 6);
+	if (err != SHT30_OK) return err;
+
+	return sht30_decode_raw(data, raw_temp, raw_hum);
+}
+
+/**
+  * @brief  Lee la trama de medición, la valida y la convierte a °C y %HR.
+  * @note	Camino común de SHT30_readTemperatureAndHumidity y SHT30_periodicRead.
+  * @param  dev: Instancia del driver.
+  * @param  temperature: Puntero donde se almacenará la temperatura medida (en °C).
+  * @param  humidity: Puntero donde se almacenará la humedad relativa medida (en %HR).
+  * @retval Código de error de tipo sht30_err_t
+  */
+static sht30_err_t sht30_fetch_converted(sht30_t *dev, float *temperature, float *humidity)
+{
+	uint16_t raw_temp, raw_hum;
+	sht30_err_t err = sht30_fetch_raw(dev, &raw_temp, &raw_hum);
+	if (err != SHT30_OK) return err;
+
+	*temperature = SHT30_rawToTemperature(raw_temp);
+	*humidity = SHT30_rawToHumidity(raw_hum);
+
+	return SHT30_OK;
+}
+
+/**
+  * @brief  Valida ambos CRC de la trama de medición y extrae los valores crudos.
+  * @param  data: Trama de 6 bytes (T MSB, T LSB, CRC, HR MSB, HR LSB, CRC).
+  * @param  raw_temp: Puntero donde se almacenará la temperatura cruda.
+  * @param  raw_hum: Puntero donde se almacenará la humedad cruda.
+  * @retval SHT30_OK o SHT30_CRC_FAIL
+  */
+static sht30_err_t sht30_decode_raw(const uint8_t *data, uint16_t *raw_temp, uint16_t *raw_hum)
+{
+	if (!sht30_frame_valid(data)) return SHT30_CRC_FAIL;
+
+	*raw_temp = (data[0] << 8) | data[1];
+	*raw_hum  = (data[3] << 8) | data[4];
+
+	return SHT30_OK;
+}
+
+/**
+  * @brief  Envía un comando de lectura y lee la palabra de respuesta (2 bytes + CRC).
+  * @note	Lo usan el registro de estado y los límites de alerta.
+  * @param  dev: Instancia del driver.
+  * @param  cmd: Comando de lectura.
+  * @param  word: Puntero donde se almacenará la palabra leída.
+  * @retval SHT30_OK, SHT30_CRC_FAIL u otro código de error de tipo sht30_err_t
+  */
+static sht30_err_t sht30_read_word(sht30_t *dev, uint16_t cmd, uint16_t *word)
+{
+	uint8_t data[3];
+	sht30_err_t err = sht30_write_command(dev, cmd);
+	if (err == SHT30_OK) err = sht30_read(dev, data, 3);
+	if (err != SHT30_OK) return err;
+	if (SHT30_CRC8(data, 2) != data[2]) return SHT30_CRC_FAIL;
+
+	*word = (data[0] << 8) | data[1];
+	return SHT30_OK;
+}
+
+/**
+  * @brief  Limita un valor crudo al rango de 16 bits (bordes de la banda de alerta).
+  */
+static uint16_t sht30_clamp(int32_t raw)
+{
+	if (raw < 0) return 0;
+	if (raw > 0xFFFF) return 0xFFFF;
+	return (uint16_t)raw;
+}
+
+/**
+  * @brief  Verifica los dos CRC de una trama de medición.
+  * @note	Con la tabla, cada palabra de 2 bytes son dos búsquedas.
+  */
+static bool sht30_frame_valid(const uint8_t *data)
+{
+	return SHT30_CRC8(data, 2) == data[2] && SHT30_CRC8(&data[3], 2) == data[5];
+}
+
 /**
   * @brief  Calcula el CRC-8 para verificación de integridad de datos del sensor SHT30.
   * @param  data: Puntero al arreglo de bytes sobre el que se calcula el CRC.
   * @param  len: Cantidad de bytes a evaluar (usualmente 2).
-  * @note	El algoritmo implementado es el definido por Sensirion: 0x31 (x^8 + x^5 + x^4 + 1)
+  * @note	El algoritmo implementado es el definido por Sensirion: 0x31 (x^8 + x^5 + x^4 + 1),
+  * 		un byte por iteración con CRC8_TABLE.
   * @retval uint8_t: Valor de CRC calculado.
   */
 static uint8_t SHT30_CRC8(const uint8_t *data, uint8_t len)
 {
     uint8_t crc = 0xFF;
     for (uint8_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t b = 0; b < 8; b++)
-            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+        crc = CRC8_TABLE[crc ^ data[i]];
     }
     return crc;
 }
@@ -0,0 +1,130 @@
+/*
+ *	@file sht30_sched.c
+ *	@version 1.0
+ *	@date 17/10/2026
+ *  @author Ing. Gustavo Campero
+ *  @title Planificador de mediciones de varios SHT30
+ *  @brief Dispara y recoge mediciones no bloqueantes (SHT30_trigger / SHT30_poll) en varios sensores
+ */
+
+#include "sht30_sched.h"
+
+#include <string.h>
+
+static void sched_finish(sht30_sched_t *sched, sht30_slot_t *slot, sht30_err_t err);
+
+/**
+  * @brief  Inicializa el planificador sin sensores.
+  * @param  sched: Planificador.
+  */
+void SHT30_schedInit(sht30_sched_t *sched)
+{
+	memset(sched, 0, sizeof(*sched));
+}
+
+/**
+  * @brief  Agrega un sensor ya inicializado con SHT30_init.
+  * @param  sched: Planificador.
+  * @param  dev: Instancia del driver; debe permanecer válida mientras se use el planificador.
+  * @retval false si ya hay SHT30_SCHED_MAX sensores o hay una ronda en curso.
+  */
+bool SHT30_schedAdd(sht30_sched_t *sched, sht30_t *dev)
+{
+	if (sched->count >= SHT30_SCHED_MAX || sched->remaining) return false;
+
+	sht30_slot_t *slot = &sched->slot[sched->count++];
+	memset(slot, 0, sizeof(*slot));
+	slot->dev = dev;
+	slot->err = SHT30_ERROR; // sin medición todavía
+	return true;
+}
+
+/**
+  * @brief  Cantidad de sensores agregados.
+  */
+uint8_t SHT30_schedCount(const sht30_sched_t *sched)
+{
+	return sched->count;
+}
+
+/**
+  * @brief  Inicia una ronda de mediciones en todos los sensores.
+  * @note	No accede al bus: los comandos se envían desde SHT30_schedProcess.
+  * @param  sched: Planificador.
+  * @retval SHT30_OK si la ronda quedó en curso.
+  * 		SHT30_BUSY si la ronda anterior no terminó.
+  * 		SHT30_ERROR si no hay sensores.
+  */
+sht30_err_t SHT30_schedStart(sht30_sched_t *sched)
+{
+	if (sched->count == 0) return SHT30_ERROR;
+	if (sched->remaining) return SHT30_BUSY;
+
+	for (uint8_t i = 0; i < sched->count; i++)
+	{
+		sched->slot[i].pending = true;
+		sched->slot[i].triggered = false;
+	}
+	sched->remaining = sched->count;
+	sched->round_start = sht30_GetTick();
+	return SHT30_OK;
+}
+
+/**
+  * @brief  Avanza la ronda en curso. Llamar en cada vuelta del superloop.
+  * @note	Envía el comando a los sensores que todavía no lo recibieron y consulta a los que están
+  * 		midiendo. Si el bus de un sensor está ocupado por otro, lo reintenta en la próxima llamada.
+  * 		Cada llamada solo inicia transferencias por interrupciones, así que dura microsegundos.
+  * @param  sched: Planificador.
+  * @retval SHT30_OK una vez, cuando termina la ronda: los resultados quedan en SHT30_schedResult.
+  * 		SHT30_BUSY si la ronda sigue en curso.
+  * 		SHT30_ERROR si no hay una ronda en curso.
+  */
+sht30_err_t SHT30_schedProcess(sht30_sched_t *sched)
+{
+	if (!sched->remaining) return SHT30_ERROR;
+
+	for (uint8_t k = 0; k < sched->count; k++)
+	{
+		sht30_slot_t *slot = &sched->slot[(sched->next + k) % sched->count];
+		sht30_err_t err;
+
+		if (!slot->pending) continue;
+
+		if (!slot->triggered)
+		{
+			err = SHT30_trigger(slot->dev);
+			if (err == SHT30_OK) slot->triggered = true;
+			else if (err != SHT30_BUSY) sched_finish(sched, slot, err);
+			continue;
+		}
+
+		err = SHT30_poll(slot->dev, &slot->raw[0], &slot->raw[1]);
+		if (err != SHT30_BUSY) sched_finish(sched, slot, err);
+	}
+	sched->next = (sched->next + 1) % sched->count;
+
+	if (sched->remaining) return SHT30_BUSY;
+
+	sched->round_ms = sht30_GetTick() - sched->round_start;
+	return SHT30_OK;
+}
+
+/**
+  * @brief  Resultado de la última ronda para un sensor (en el orden en que se agregaron).
+  * @retval NULL si el índice no corresponde a un sensor.
+  */
+const sht30_slot_t *SHT30_schedResult(const sht30_sched_t *sched, uint8_t index)
+{
+	return (index < sched->count) ? &sched->slot[index] : NULL;
+}
+
+/**
+  * @brief  Cierra la medición de un sensor en la ronda.
+  */
+static void sched_finish(sht30_sched_t *sched, sht30_slot_t *slot, sht30_err_t err)
+{
+	slot->err = err;
+	slot->pending = false;
+	sched->remaining--;
+}